@@ -0,0 +1,721 @@
+/**
+ * @file bench.c
+ * benchmark of sort algorithm.
+ *
+ * every algorithm is run on heap allocated arrays of every size of a sweep,
+ * repeated after warmup runs. wall time of every run is measured and the
+ * result is checked completely, then min, median, p95 and mean of runs are
+ * reported as text, CSV or JSON.
+ *
+ * usage: ./bench [-a ALGOS] [-n SIZES] [-t TYPE] [-d DIST] [-r REPS]
+ *                [-w WARMUP] [-j THREADS] [-s SEED] [-f FORMAT] [-p]
+ *
+ *   -a ALGOS   comma separated algorithms, "all", or "list" to show them
+ *   -n SIZES   comma separated sizes, or range FROM:TO[:FACTOR], a size may
+ *              end with K (10^3), M (10^6) or G (10^9), default 1K:1M
+ *   -t TYPE    type of element: dbl, flt, i32 or i64, default dbl
+ *   -d DIST    distribution: uniform, sorted, reverse, dup, zipf, nearly
+ *              (sorted, 1% random) or runs (16 sorted batches)
+ *   -r REPS    number of measured runs, default 5
+ *   -w WARMUP  number of runs before measuring, default 1
+ *   -j THREADS number of threads of parallel algorithms, default all
+ *   -s SEED    seed of random data, default 996
+ *   -f FORMAT  text, csv or json, default text
+ *   -p         profile one more run of every algorithm by perf_stat.h and
+ *              report comparisons, swaps, moves, allocations, peak scratch
+ *              bytes and hardware counters, "-" if a counter is not
+ *              available (swaps, moves and allocations need make STAT=1,
+ *              and are not counted for simd and qsort)
+ *
+ * @author  duruyao
+ * @version 1.0  19-12-19
+ * @update  [id] [yy-mm-dd] [author] [description]
+ */
+
+#include <time.h>
+#include <math.h>
+#include <stdio.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include "sort_algo.h"
+#include "perf_stat.h"
+#include "thread_pool.h"
+
+
+/******************************************************************************/
+/*                                                                            */
+/* struct defination                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+
+#define DEF_ALGOS   "heap,quick,bfprt,quick3,sample,radix,merge,tim,shell,"   \
+                    "quick_val,merge_val,radix_val,simd,qsort"
+#define DEF_SIZES   "1K:1M"
+#define DEF_SEED    996U
+#define MAX_SIZES   64
+#define SLOW_MAX    (1 << 17)   /* max size of O(n ^ 2) algorithms         */
+
+#define T_DBL       0x1
+#define T_FLT       0x2
+#define T_I32       0x4
+#define T_I64       0x8
+#define T_ALL       0xF
+
+#define FMT_TEXT    0
+#define FMT_CSV     1
+#define FMT_JSON    2
+
+/*
+ * data sorted by one run.
+ */
+
+typedef struct ctx {
+    void   *val;                /* array of values                         */
+    void  **ptr;                /* array of pointers to values             */
+    int     n;
+    int     type;
+    size_t  size;               /* bytes of element                        */
+    int     nb_thrd;
+    int(*cmp)(const void *, const void *);
+} Ctx;
+
+/*
+ * an algorithm, 'run()' sorts ptr if by_ptr, otherwise val.
+ */
+
+typedef struct algo {
+    const char *name;
+    int         by_ptr;
+    int         types;          /* mask of supported types                 */
+    int         max_n;          /* max size, 0 if unlimited                */
+    void      (*run)(Ctx *);
+    int         hook;           /* 1 if code has swap, move, alloc hooks   */
+} Algo;
+
+/*
+ * statistics of measured runs.
+ */
+
+typedef struct stat {
+    double min;
+    double med;
+    double p95;
+    double mean;
+    int    pass;
+} Stat;
+
+
+/******************************************************************************/
+/*                                                                            */
+/* function defination                                                        */
+/*                                                                            */
+/******************************************************************************/
+
+
+/******************************************************************************/
+/* compare func                                                               */
+/******************************************************************************/
+
+static int cmp_flt(const void *ptr1, const void *ptr2) {
+    float *p1 = (float *)ptr1, *p2 = (float *)ptr2;
+    return *p1 == *p2 ? 0 : (*p1 > *p2 ? 1 : -1);
+}
+
+static int cmp_i32(const void *ptr1, const void *ptr2) {
+    int32_t *p1 = (int32_t *)ptr1, *p2 = (int32_t *)ptr2;
+    return *p1 == *p2 ? 0 : (*p1 > *p2 ? 1 : -1);
+}
+
+static int cmp_i64(const void *ptr1, const void *ptr2) {
+    int64_t *p1 = (int64_t *)ptr1, *p2 = (int64_t *)ptr2;
+    return *p1 == *p2 ? 0 : (*p1 > *p2 ? 1 : -1);
+}
+
+/******************************************************************************/
+/* algorithm                                                                  */
+/******************************************************************************/
+
+static void run_insert(Ctx *c) { insert_sort_p(c->ptr, c->n, c->cmp); }
+static void run_select(Ctx *c) { select_sort_p(c->ptr, c->n, c->cmp); }
+static void run_bubble(Ctx *c) { bubble_sort_p(c->ptr, c->n, c->cmp); }
+static void run_heap  (Ctx *c) { heap_sort_p(c->ptr, c->n, c->cmp); }
+static void run_quick (Ctx *c) { quick_sort_p(c->ptr, 0, c->n, c->cmp); }
+static void run_intro (Ctx *c) { intro_sort_p(c->ptr, 0, c->n, c->cmp); }
+
+static void run_bfprt(Ctx *c) {
+    quick_sort_bfprt_p(c->ptr, 0, c->n, c->cmp);
+}
+
+static void run_quick_blk(Ctx *c) {
+    quick_sort_block_p(c->ptr, 0, c->n, c->cmp);
+}
+
+static void run_heap4(Ctx *c) {
+    heap_sort_d_p(c->ptr, c->n, 4, c->cmp);
+}
+
+static void run_quick3(Ctx *c) {
+    quick_sort_3way_p(c->ptr, 0, c->n, c->cmp);
+}
+
+static void run_sample(Ctx *c) { sample_sort_p(c->ptr, c->n, c->cmp); }
+static void run_merge (Ctx *c) { merge_sort_p(c->ptr, c->n, c->cmp); }
+static void run_tim   (Ctx *c) { tim_sort_p(c->ptr, c->n, c->cmp); }
+static void run_shell (Ctx *c) { shell_sort_p(c->ptr, c->n, c->cmp); }
+
+static void run_bucket(Ctx *c) {
+    bucket_sort_p(c->ptr, c->n, &nb_bkts_p, &hash_idx_p, c->cmp);
+}
+
+static void run_radix(Ctx *c) {
+    radix_sort_p(c->ptr, c->n, c->type == T_DBL ? &key_dbl : &key_i64);
+}
+
+static void run_key(Ctx *c) {
+    key_sort_p(c->ptr, c->n, c->type == T_DBL ? &key_dbl : &key_i64, c->cmp);
+}
+
+static void run_quick_par(Ctx *c) {
+    quick_sort_par_p(c->ptr, 0, c->n, c->cmp, c->nb_thrd);
+}
+
+static void run_merge_par(Ctx *c) {
+    merge_sort_par_p(c->ptr, c->n, c->cmp, c->nb_thrd);
+}
+
+static void run_bucket_par(Ctx *c) {
+    bucket_sort_par_p(c->ptr, c->n, &nb_bkts_p, &hash_idx_p, c->cmp,
+                      c->nb_thrd);
+}
+
+static void run_heap_val (Ctx *c) { heap_sort(c->val, c->n, c->size, c->cmp); }
+static void run_quick_val(Ctx *c) { quick_sort(c->val, c->n, c->size, c->cmp); }
+static void run_merge_val(Ctx *c) { merge_sort(c->val, c->n, c->size, c->cmp); }
+static void run_shell_val(Ctx *c) { shell_sort(c->val, c->n, c->size, c->cmp); }
+static void run_qsort    (Ctx *c) { qsort(c->val, c->n, c->size, c->cmp); }
+
+static void run_radix_val(Ctx *c) {
+    switch (c->type) {
+    case T_DBL: radix_sort_dbl((double *)c->val, c->n);  break;
+    case T_FLT: radix_sort_flt((float *)c->val, c->n);   break;
+    case T_I32: radix_sort_i32((int32_t *)c->val, c->n); break;
+    case T_I64: radix_sort_i64((int64_t *)c->val, c->n); break;
+    }
+}
+
+static void run_simd(Ctx *c) {
+    switch (c->type) {
+    case T_DBL: sort_f64((double *)c->val, c->n);  break;
+    case T_FLT: sort_f32((float *)c->val, c->n);   break;
+    case T_I32: sort_i32((int32_t *)c->val, c->n); break;
+    case T_I64: sort_i64((int64_t *)c->val, c->n); break;
+    }
+}
+
+static void run_heap_tpl (Ctx *c) { heap_sort_dbl((double *)c->val, c->n); }
+static void run_quick_tpl(Ctx *c) { quick_sort_dbl((double *)c->val, 0, c->n); }
+
+static void run_quick_blk_tpl(Ctx *c) {
+    quick_sort_block_dbl((double *)c->val, 0, c->n);
+}
+static void run_merge_tpl(Ctx *c) { merge_sort_dbl((double *)c->val, c->n); }
+static void run_shell_tpl(Ctx *c) { shell_sort_dbl((double *)c->val, c->n); }
+
+static const Algo algos[] = {
+    {"insert",     1, T_ALL,         SLOW_MAX, run_insert,     1},
+    {"select",     1, T_ALL,         SLOW_MAX, run_select,     1},
+    {"bubble",     1, T_ALL,         SLOW_MAX, run_bubble,     1},
+    {"heap",       1, T_ALL,         0,        run_heap,       1},
+    {"heap4",      1, T_ALL,         0,        run_heap4,      1},
+    {"quick",      1, T_ALL,         0,        run_quick,      1},
+    {"bfprt",      1, T_ALL,         0,        run_bfprt,      1},
+    {"quick_blk",  1, T_ALL,         0,        run_quick_blk,  1},
+    {"intro",      1, T_ALL,         0,        run_intro,      1},
+    {"quick3",     1, T_ALL,         0,        run_quick3,     1},
+    {"bucket",     1, T_DBL,         0,        run_bucket,     1},
+    {"sample",     1, T_ALL,         0,        run_sample,     1},
+    {"radix",      1, T_DBL | T_I64, 0,        run_radix,      1},
+    {"key",        1, T_DBL | T_I64, 0,        run_key,        1},
+    {"merge",      1, T_ALL,         0,        run_merge,      1},
+    {"tim",        1, T_ALL,         0,        run_tim,        1},
+    {"shell",      1, T_ALL,         0,        run_shell,      1},
+    {"quick_par",  1, T_ALL,         0,        run_quick_par,  1},
+    {"merge_par",  1, T_ALL,         0,        run_merge_par,  1},
+    {"bucket_par", 1, T_DBL,         0,        run_bucket_par, 1},
+    {"heap_val",   0, T_ALL,         0,        run_heap_val,   1},
+    {"quick_val",  0, T_ALL,         0,        run_quick_val,  1},
+    {"merge_val",  0, T_ALL,         0,        run_merge_val,  1},
+    {"shell_val",  0, T_ALL,         0,        run_shell_val,  1},
+    {"radix_val",  0, T_ALL,         0,        run_radix_val,  1},
+    {"simd",       0, T_ALL,         0,        run_simd,       0},
+    {"heap_tpl",   0, T_DBL,         0,        run_heap_tpl,   1},
+    {"quick_tpl",  0, T_DBL,         0,        run_quick_tpl,  1},
+    {"blk_tpl",    0, T_DBL,         0,        run_quick_blk_tpl, 1},
+    {"merge_tpl",  0, T_DBL,         0,        run_merge_tpl,  1},
+    {"shell_tpl",  0, T_DBL,         0,        run_shell_tpl,  1},
+    {"qsort",      0, T_ALL,         0,        run_qsort,      0},
+};
+
+#define NB_ALGOS ((int)(sizeof(algos) / sizeof(algos[0])))
+
+static const Algo *find_algo(const char *name) {
+    for (int i = 0; i < NB_ALGOS; i++)
+        if (strcmp(algos[i].name, name) == 0)
+            return &algos[i];
+    return NULL;
+}
+
+/******************************************************************************/
+/* data                                                                       */
+/******************************************************************************/
+
+static uint64_t rng_state;
+
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+/*
+ * generate n elements of a type and a distribution.
+ *
+ * doubles are kept in [256, 65536), which 'hash_idx_p()' of bucket sort
+ * assumes, integers of uniform distribution cover all values of type.
+ */
+
+static void gen_data(void *val, int n, int type, const char *dist,
+                     unsigned seed) {
+    rng_state = 0x9E3779B97F4A7C15ULL ^ seed;
+    for (int i = 0; i < n; i++) {
+        uint64_t r = rng_next();
+        double   u = (r >> 11) * (1.0 / 9007199254740992.0);
+        double   x;
+        int64_t  k;
+        if (strcmp(dist, "sorted") == 0)
+            u = (double)i / n;
+        else if (strcmp(dist, "reverse") == 0)
+            u = (double)(n - 1 - i) / n;
+        else if (strcmp(dist, "dup") == 0)
+            u = (double)(r % 16) / 16;
+        else if (strcmp(dist, "zipf") == 0) {
+            u = floor(1.0 / pow(u + 1e-12, 1.2)) / 65280.0;
+            u = u < 1.0 ? u : 0.99999;
+        } else if (strcmp(dist, "nearly") == 0 && r % 100 != 0)
+            u = (double)i / n;
+        else if (strcmp(dist, "runs") == 0)
+            u = (double)(i % (n / 16 + 1)) / (n / 16 + 1);
+        x = 256.0 + u * (65536.0 - 256.0);
+        k = strcmp(dist, "uniform") == 0 ? (int64_t)r :
+            (int64_t)(u * 4294967296.0) - 2147483648LL;
+        switch (type) {
+        case T_DBL: ((double *)val)[i]  = x;            break;
+        case T_FLT: ((float *)val)[i]   = (float)x;     break;
+        case T_I32: ((int32_t *)val)[i] = (int32_t)k;   break;
+        case T_I64: ((int64_t *)val)[i] = k;            break;
+        }
+    }
+}
+
+/*
+ * sum of values as raw words, which is kept by a correct sort.
+ */
+
+static uint64_t checksum(const void *val, int n, size_t size) {
+    uint64_t sum = 0;
+    for (int i = 0; i < n; i++) {
+        uint64_t w = 0;
+        memcpy(&w, (const char *)val + i * size, size);
+        sum += w * 0x9E3779B97F4A7C15ULL ^ (w >> 29);
+    }
+    return sum;
+}
+
+/*
+ * check the whole result of a run, pointers must be a permutation of
+ * pointers to val, which is checked by a bitmap of elements seen.
+ *
+ * @return 1 if elements are sorted and no element is lost, otherwise 0.
+ */
+
+static int check_run(Ctx *c, int by_ptr, uint64_t sum) {
+    if (by_ptr) {
+        uint8_t *seen = (uint8_t *)calloc(c->n / 8 + 1, 1);
+        int      ok   = seen != NULL;
+        for (int i = 0; ok && i < c->n; i++) {
+            uintptr_t off = (uintptr_t)c->ptr[i] - (uintptr_t)c->val;
+            uintptr_t j   = off / c->size;
+            if (off % c->size != 0 || j >= (uintptr_t)c->n ||
+                (seen[j >> 3] >> (j & 7) & 1) ||
+                (i > 0 && c->cmp(c->ptr[i - 1], c->ptr[i]) > 0))
+                ok = 0;
+            else
+                seen[j >> 3] |= 1 << (j & 7);
+        }
+        free(seen);
+        return ok;
+    }
+    for (int i = 1; i < c->n; i++)
+        if (c->cmp((char *)c->val + (i - 1) * c->size,
+                   (char *)c->val + i * c->size) > 0)
+            return 0;
+    return checksum(c->val, c->n, c->size) == sum;
+}
+
+/******************************************************************************/
+/* measure                                                                    */
+/******************************************************************************/
+
+static double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_time(const void *ptr1, const void *ptr2) {
+    return cmp_dbl(ptr1, ptr2);
+}
+
+/*
+ * run an algorithm warmup + reps times on a copy of orig.
+ */
+
+static void measure(const Algo *a, Ctx *c, const void *orig, uint64_t sum,
+                    int reps, int warmup, double *times, Stat *st) {
+    st->pass = 1;
+    for (int r = -warmup; r < reps; r++) {
+        double begin;
+        memcpy(c->val, orig, c->size * c->n);
+        if (a->by_ptr)
+            for (int i = 0; i < c->n; i++)
+                c->ptr[i] = (char *)c->val + i * c->size;
+        begin = wall_time();
+        a->run(c);
+        if (r >= 0)
+            times[r] = wall_time() - begin;
+        st->pass &= check_run(c, a->by_ptr, sum);
+    }
+    qsort(times, reps, sizeof(double), &cmp_time);
+    st->min  = times[0];
+    st->med  = reps % 2 ? times[reps / 2] :
+                          (times[reps / 2 - 1] + times[reps / 2]) / 2;
+    st->p95  = times[(int)ceil(0.95 * reps) - 1];
+    st->mean = 0;
+    for (int r = 0; r < reps; r++)
+        st->mean += times[r] / reps;
+}
+
+/*
+ * run an algorithm once more on a copy of orig, counted by perf_stat.h.
+ *
+ * the run is not measured with others, since counting comparator and hooks
+ * slow it down.
+ */
+
+static void profile(const Algo *a, Ctx *c, const void *orig, SortStat *ps) {
+    int(*cmp)(const void *, const void *) = c->cmp;
+    memcpy(c->val, orig, c->size * c->n);
+    if (a->by_ptr)
+        for (int i = 0; i < c->n; i++)
+            c->ptr[i] = (char *)c->val + i * c->size;
+    if ((c->cmp = stat_cmp(cmp)) == NULL)
+        c->cmp = cmp;
+    STAT_RUN(ps, a->run(c));
+    if (c->cmp != cmp)
+        stat_cmp_release(c->cmp);
+    c->cmp = cmp;
+    ps->hooked &= a->hook;
+}
+
+/******************************************************************************/
+/* report                                                                     */
+/******************************************************************************/
+
+static const char *cnt_name[] = {
+    "cmp", "swap", "move", "alloc", "peak_bytes"
+};
+
+#define NB_CNT      5
+#define NB_PROF     (NB_CNT + STAT_HW_NUM)
+
+/*
+ * i-th counter of profiled run, -1 if it is not available.
+ */
+
+static int64_t prof_val(const SortStat *ps, int i) {
+    switch (i) {
+    case 0: return (int64_t)ps->nb_cmp;
+    case 1: return ps->hooked ? (int64_t)ps->nb_swap  : -1;
+    case 2: return ps->hooked ? (int64_t)ps->nb_move  : -1;
+    case 3: return ps->hooked ? (int64_t)ps->nb_alloc : -1;
+    case 4: return ps->hooked ? ps->peak_bytes        : -1;
+    }
+    return ps->hw[i - NB_CNT];
+}
+
+static const char *prof_name(int i) {
+    return i < NB_CNT ? cnt_name[i] : stat_hw_name(i - NB_CNT);
+}
+
+static void print_head(int fmt, int prof) {
+    if (fmt == FMT_CSV) {
+        printf("algo,type,dist,n,reps,min_s,median_s,p95_s,mean_s,"
+               "ns_per_elem,pass");
+        for (int i = 0; prof && i < NB_PROF; i++)
+            printf(",%s", prof_name(i));
+        printf("\n");
+    } else if (fmt == FMT_JSON) {
+        printf("[");
+    } else {
+        printf("%-11s %-4s %-8s %10s %4s %11s %11s %11s %11s %8s %-*s",
+               "algo", "type", "dist", "n", "reps", "min(s)", "median(s)",
+               "p95(s)", "mean(s)", "ns/elem", prof ? 7 : 0, "pass");
+        for (int i = 0; prof && i < NB_PROF; i++)
+            printf(" %12s", prof_name(i));
+        printf("\n");
+    }
+}
+
+/*
+ * print a row, ps is NULL if runs are not profiled.
+ */
+
+static void print_row(int fmt, int first, const char *algo, const char *type,
+                      const char *dist, int n, int reps, Stat *st,
+                      const SortStat *ps) {
+    double ns = st->med * 1e9 / n;
+    if (fmt == FMT_CSV)
+        printf("%s,%s,%s,%d,%d,%.9f,%.9f,%.9f,%.9f,%.3f,%d", algo, type,
+               dist, n, reps, st->min, st->med, st->p95, st->mean, ns,
+               st->pass);
+    else if (fmt == FMT_JSON)
+        printf("%s\n  {\"algo\": \"%s\", \"type\": \"%s\", \"dist\": \"%s\", "
+               "\"n\": %d, \"reps\": %d, \"min_s\": %.9f, \"median_s\": %.9f, "
+               "\"p95_s\": %.9f, \"mean_s\": %.9f, \"ns_per_elem\": %.3f, "
+               "\"pass\": %s", first ? "" : ",", algo, type, dist, n, reps,
+               st->min, st->med, st->p95, st->mean, ns,
+               st->pass ? "true" : "false");
+    else
+        printf("%-11s %-4s %-8s %10d %4d %11.6f %11.6f %11.6f %11.6f "
+               "%8.2f %-*s", algo, type, dist, n, reps, st->min, st->med,
+               st->p95, st->mean, ns, ps != NULL ? 7 : 0,
+               st->pass ? "pass" : "no pass");
+    for (int i = 0; ps != NULL && i < NB_PROF; i++) {
+        char    buf[24] = "";
+        int64_t v = prof_val(ps, i);
+        if (v >= 0)
+            snprintf(buf, sizeof(buf), "%" PRId64, v);
+        if (fmt == FMT_CSV)
+            printf(",%s", buf);
+        else if (fmt == FMT_JSON)
+            printf(", \"%s\": %s", prof_name(i), v < 0 ? "null" : buf);
+        else
+            printf(" %12s", v < 0 ? "-" : buf);
+    }
+    printf(fmt == FMT_JSON ? "}" : "\n");
+    fflush(stdout);
+}
+
+/******************************************************************************/
+/* command line                                                               */
+/******************************************************************************/
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-a ALGOS] [-n SIZES] [-t TYPE] [-d DIST] [-r REPS]\n"
+            "          [-w WARMUP] [-j THREADS] [-s SEED] [-f FORMAT] [-p]\n"
+            "  -a  comma separated algorithms, \"all\" or \"list\"\n"
+            "      (default %s)\n"
+            "  -n  comma separated sizes or FROM:TO[:FACTOR], K/M/G suffix\n"
+            "      (default %s)\n"
+            "  -t  dbl, flt, i32 or i64 (default dbl)\n"
+            "  -d  uniform, sorted, reverse, dup, zipf, nearly or runs\n"
+            "      (default uniform)\n"
+            "  -r  measured runs (default 5)\n"
+            "  -w  warmup runs (default 1)\n"
+            "  -j  threads of parallel algorithms (default all)\n"
+            "  -s  seed (default %u)\n"
+            "  -f  text, csv or json (default text)\n"
+            "  -p  profile counters of one more run\n",
+            prog, DEF_ALGOS, DEF_SIZES, DEF_SEED);
+}
+
+/*
+ * parse a size with optional K, M or G suffix.
+ *
+ * @return size on success, otherwise -1.
+ */
+
+static long long parse_size(const char *s, char **end) {
+    long long v = strtoll(s, end, 10);
+    switch (**end) {
+    case 'K': case 'k': v *= 1000LL;       (*end)++; break;
+    case 'M': case 'm': v *= 1000000LL;    (*end)++; break;
+    case 'G': case 'g': v *= 1000000000LL; (*end)++; break;
+    }
+    return *end == s || v < 1 || v > INT_MAX ? -1 : v;
+}
+
+/*
+ * parse list or range of sizes.
+ *
+ * @return number of sizes on success, otherwise -1.
+ */
+
+static int parse_sizes(const char *s, int *sizes) {
+    char *end;
+    int   nb = 0;
+    long long from = parse_size(s, &end), to, f = 10;
+    if (from < 0)
+        return -1;
+    if (*end == ':') {
+        if ((to = parse_size(end + 1, &end)) < 0)
+            return -1;
+        if (*end == ':' && (f = strtoll(end + 1, &end, 10)) < 2)
+            return -1;
+        for (long long v = from; v <= to && nb < MAX_SIZES; v *= f)
+            sizes[nb++] = (int)v;
+        return *end == '\0' ? nb : -1;
+    }
+    sizes[nb++] = (int)from;
+    while (*end == ',' && nb < MAX_SIZES) {
+        if ((from = parse_size(end + 1, &end)) < 0)
+            return -1;
+        sizes[nb++] = (int)from;
+    }
+    return *end == '\0' ? nb : -1;
+}
+
+/*
+ * parse comma separated algorithms, "all" selects all algorithms except
+ * O(n ^ 2) ones.
+ *
+ * @return number of algorithms on success, otherwise -1.
+ */
+
+static int parse_algos(const char *list, const Algo **sel) {
+    char *buf = strdup(list), *name;
+    int   nb  = 0;
+    if (buf == NULL)
+        return -1;
+    if (strcmp(list, "all") == 0) {
+        for (int i = 0; i < NB_ALGOS; i++)
+            if (algos[i].max_n == 0)
+                sel[nb++] = &algos[i];
+        free(buf);
+        return nb;
+    }
+    for (char *s = buf; (name = strtok(s, ",")) != NULL; s = NULL) {
+        if (nb == NB_ALGOS || (sel[nb++] = find_algo(name)) == NULL) {
+            fprintf(stderr, "unknown algorithm: %s\n", name);
+            nb = -1;
+            break;
+        }
+    }
+    free(buf);
+    return nb;
+}
+
+int main(int argc, char **argv) {
+    const char *list = DEF_ALGOS, *tname = "dbl", *dist = "uniform";
+    const char *sz = DEF_SIZES, *fname = "text";
+    const Algo *sel[NB_ALGOS];
+    int sizes[MAX_SIZES], nb_sizes, nb_sel, reps = 5, warmup = 1, fmt;
+    int nb_thrd = nb_hw_thrd(), first = 1, prof = 0, opt;
+    unsigned seed = DEF_SEED;
+    Ctx c;
+
+    while ((opt = getopt(argc, argv, "a:n:t:d:r:w:j:s:f:ph")) != -1) {
+        switch (opt) {
+        case 'a': list    = optarg;                               break;
+        case 'n': sz      = optarg;                               break;
+        case 't': tname   = optarg;                               break;
+        case 'd': dist    = optarg;                               break;
+        case 'r': reps    = atoi(optarg);                         break;
+        case 'w': warmup  = atoi(optarg);                         break;
+        case 'j': nb_thrd = atoi(optarg);                         break;
+        case 's': seed    = (unsigned)strtoul(optarg, NULL, 10);  break;
+        case 'f': fname   = optarg;                               break;
+        case 'p': prof    = 1;                                    break;
+        default : usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (strcmp(list, "list") == 0) {
+        for (int i = 0; i < NB_ALGOS; i++)
+            printf("%s\n", algos[i].name);
+        return 0;
+    }
+
+    /* check options */
+    memset(&c, 0, sizeof(c));
+    c.nb_thrd = nb_thrd;
+    if (strcmp(tname, "dbl") == 0)
+        c.type = T_DBL, c.size = sizeof(double),  c.cmp = &cmp_dbl;
+    else if (strcmp(tname, "flt") == 0)
+        c.type = T_FLT, c.size = sizeof(float),   c.cmp = &cmp_flt;
+    else if (strcmp(tname, "i32") == 0)
+        c.type = T_I32, c.size = sizeof(int32_t), c.cmp = &cmp_i32;
+    else if (strcmp(tname, "i64") == 0)
+        c.type = T_I64, c.size = sizeof(int64_t), c.cmp = &cmp_i64;
+    fmt = strcmp(fname, "csv")  == 0 ? FMT_CSV  :
+          strcmp(fname, "json") == 0 ? FMT_JSON :
+          strcmp(fname, "text") == 0 ? FMT_TEXT : -1;
+    nb_sizes = parse_sizes(sz, sizes);
+    nb_sel   = parse_algos(list, sel);
+    if (c.type == 0 || fmt < 0 || nb_sizes < 1 || nb_sel < 0 || reps < 1 ||
+        warmup < 0 || (strcmp(dist, "uniform") && strcmp(dist, "sorted") &&
+                       strcmp(dist, "reverse") && strcmp(dist, "dup") &&
+                       strcmp(dist, "zipf") && strcmp(dist, "nearly") &&
+                       strcmp(dist, "runs"))) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    print_head(fmt, prof);
+    for (int k = 0; k < nb_sizes; k++) {
+        int      n     = sizes[k];
+        void    *orig  = malloc(c.size * n);
+        double  *times = (double *)malloc(sizeof(double) * reps);
+        uint64_t sum;
+        c.n   = n;
+        c.val = malloc(c.size * n);
+        c.ptr = (void **)malloc(sizeof(void *) * n);
+        if (orig == NULL || times == NULL || c.val == NULL || c.ptr == NULL) {
+            fprintf(stderr, "ERROR allocating memory for %d elements.\n", n);
+            goto next;
+        }
+        gen_data(orig, n, c.type, dist, seed);
+        sum = checksum(orig, n, c.size);
+        for (int i = 0; i < nb_sel; i++) {
+            Stat     st;
+            SortStat ps;
+            if (!(sel[i]->types & c.type) ||
+                (sel[i]->max_n && n > sel[i]->max_n)) {
+                fprintf(stderr, "skipping %s: %s %d is not supported\n",
+                        sel[i]->name, tname, n);
+                continue;
+            }
+            measure(sel[i], &c, orig, sum, reps, warmup, times, &st);
+            if (prof)
+                profile(sel[i], &c, orig, &ps);
+            print_row(fmt, first, sel[i]->name, tname, dist, n, reps, &st,
+                      prof ? &ps : NULL);
+            first = 0;
+        }
+next:
+        free(c.ptr);
+        free(c.val);
+        free(times);
+        free(orig);
+    }
+    if (fmt == FMT_JSON)
+        printf("\n]\n");
+    return 0;
+}
@@ -0,0 +1,437 @@
+/**
+ * @file ext_sort.c
+ * source file contains of difination of external merge sort.
+ *
+ * the input file is read in blocks of half of memory budget, every block is
+ * sorted by 'quick_sort()' and written to a temporary run file by another
+ * thread, while the next block is read and sorted. then runs are merged by
+ * a loser tree, at most fan_in runs at a time, until one run is left, which
+ * is written to the output file.
+ *
+ * only writing of runs is overlapped, reading of input and of runs during
+ * merging is synchronous.
+ *
+ * @author  duruyao
+ * @version 1.0  19-12-19
+ * @update  [id] [yy-mm-dd] [author] [description]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define STAT_HOOK_ALLOC
+#include "perf_stat.h"
+#include "sort_algo.h"
+#include "ext_sort.h"
+
+
+/******************************************************************************/
+/*                                                                            */
+/* struct defination                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+
+#define DEF_MEM     ((size_t)256 << 20)
+#define DEF_FAN_IN  64
+#define MIN_BUF     4096        /* min bytes of buffer of a run            */
+
+/*
+ * a sorted block written to a run by writer thread.
+ */
+
+typedef struct run_out {
+    FILE       *fp;
+    const char *buf;
+    size_t      size;           /* bytes of buf                            */
+    int         err;
+} RunOut;
+
+/*
+ * a run being merged, records are read in blocks into buf.
+ */
+
+typedef struct run_in {
+    FILE   *fp;
+    char   *buf;
+    size_t  cap;                /* capacity of buf in records              */
+    size_t  nb;                 /* number of records in buf                */
+    size_t  pos;                /* index of the current record             */
+    int     eof;
+    int     err;                /* reading failed before end of run        */
+} RunIn;
+
+/*
+ * context of merging, 'lt[1, k)' are losers of a tournament on current
+ * records of k runs, and 'lt[0]' is the winner. an exhausted run loses to
+ * every run, ties are broken by index of run.
+ */
+
+typedef struct merger {
+    RunIn  *in;
+    int    *lt;
+    int     k;
+    size_t  rec;                /* bytes of a record                       */
+    int(*cmp)(const void *, const void *);
+} Merger;
+
+
+/******************************************************************************/
+/*                                                                            */
+/* function defination                                                        */
+/*                                                                            */
+/******************************************************************************/
+
+
+/******************************************************************************/
+/* run file                                                                   */
+/******************************************************************************/
+
+/*
+ * create an anonymous temporary file in dir, it is removed when closed.
+ *
+ * @return a pointer to file opened for update on success, otherwise NULL.
+ */
+
+static FILE *run_create(const char *dir) {
+    size_t len  = strlen(dir) + 32;
+    char  *path = (char *)malloc(len);
+    FILE  *fp   = NULL;
+    int    fd;
+    if (path == NULL)
+        return NULL;
+    snprintf(path, len, "%s/ext_sort_XXXXXX", dir);
+    fd = mkstemp(path);
+    if (fd >= 0) {
+        unlink(path);
+        if ((fp = fdopen(fd, "w+b")) == NULL)
+            close(fd);
+    }
+    if (fp == NULL)
+        fprintf(stderr, "ERROR creating run in %s\n", dir);
+    free(path);
+    return fp;
+}
+
+/*
+ * writer thread writing a sorted block to its run.
+ */
+
+static void *run_write(void *arg) {
+    RunOut *ro = (RunOut *)arg;
+    ro->err = fwrite(ro->buf, 1, ro->size, ro->fp) != ro->size ||
+              fflush(ro->fp) != 0;
+    return NULL;
+}
+
+/*
+ * append a run to the array of runs.
+ *
+ * @return 0 on success, otherwise -1.
+ */
+
+static int run_push(FILE ***runs, int *nb, int *cap, FILE *fp) {
+    if (*nb == *cap) {
+        int    c = *cap ? 2 * *cap : 64;
+        FILE **r = (FILE **)realloc(*runs, sizeof(FILE *) * c);
+        if (r == NULL)
+            return -1;
+        *runs = r;
+        *cap  = c;
+    }
+    (*runs)[(*nb)++] = fp;
+    return 0;
+}
+
+/******************************************************************************/
+/* loser tree                                                                 */
+/******************************************************************************/
+
+/*
+ * get the current record of run i, NULL if run i is exhausted or reading
+ * of it failed, which is kept in err of the run.
+ */
+
+static inline const char *lt_cur(Merger *mg, int i) {
+    RunIn *r = &mg->in[i];
+    if (r->pos == r->nb && !r->eof) {
+        r->nb  = fread(r->buf, mg->rec, r->cap, r->fp);
+        r->pos = 0;
+        r->eof = r->nb == 0;
+        r->err = r->eof && ferror(r->fp);
+    }
+    return r->eof ? NULL : r->buf + r->pos * mg->rec;
+}
+
+/*
+ * check whether run a beats run b.
+ */
+
+static inline int lt_win(Merger *mg, int a, int b) {
+    const char *x = lt_cur(mg, a), *y = lt_cur(mg, b);
+    int c;
+    if (x == NULL || y == NULL)
+        return y == NULL && (x != NULL || a < b);
+    c = mg->cmp(x, y);
+    return c < 0 || (c == 0 && a < b);
+}
+
+/*
+ * play the tournament of all runs.
+ *
+ * @return 0 on success, otherwise -1.
+ */
+
+static int lt_build(Merger *mg) {
+    int  k   = mg->k;
+    int *win = (int *)malloc(sizeof(int) * 2 * k);
+    if (win == NULL)
+        return -1;
+    for (int i = 0; i < k; i++)
+        win[k + i] = i;
+    for (int p = k - 1; p > 0; p--) {
+        int a = win[2 * p], b = win[2 * p + 1], w = lt_win(mg, a, b);
+        win[p]    = w ? a : b;
+        mg->lt[p] = w ? b : a;
+    }
+    mg->lt[0] = win[1];
+    free(win);
+    return 0;
+}
+
+/*
+ * replay the matches of run i from its leaf to the root, after the current
+ * record of run i is taken.
+ */
+
+static inline void lt_replay(Merger *mg, int i) {
+    for (int p = (i + mg->k) / 2; p > 0; p /= 2) {
+        if (lt_win(mg, mg->lt[p], i)) {
+            int t = mg->lt[p];
+            mg->lt[p] = i;
+            i = t;
+        }
+    }
+    mg->lt[0] = i;
+}
+
+/******************************************************************************/
+/* merge                                                                      */
+/******************************************************************************/
+
+/*
+ * merge k runs into out, all runs are closed.
+ *
+ * @param runs is an array of k runs.
+ * @param k    is number of runs.
+ * @param out  is a file to write.
+ * @param rec  is bytes of a record.
+ * @param mem  is memory budget in bytes.
+ * @param cmp  is a pointer to a function comparing records.
+ *
+ * @return 0 on success, otherwise -1.
+ */
+
+static int merge_runs(FILE **runs, int k, FILE *out, size_t rec, size_t mem,
+                      int(*cmp)(const void *, const void *)) {
+    size_t nb_r = mem / (k + 1) / rec, nb_o = 0;
+    char  *obuf = NULL;
+    int    ret  = -1;
+    Merger mg   = {NULL, NULL, k, rec, cmp};
+
+    if (k <= 0)
+        return 0;
+    if (nb_r * rec < MIN_BUF)
+        nb_r = (MIN_BUF + rec - 1) / rec;
+    mg.in = (RunIn *)calloc(k, sizeof(RunIn));
+    mg.lt = (int *)malloc(sizeof(int) * k);
+    obuf  = (char *)malloc(nb_r * rec);
+    if (mg.in == NULL || mg.lt == NULL || obuf == NULL)
+        goto end;
+    for (int i = 0; i < k; i++) {
+        mg.in[i].fp  = runs[i];
+        mg.in[i].cap = nb_r;
+        if ((mg.in[i].buf = (char *)malloc(nb_r * rec)) == NULL)
+            goto end;
+        rewind(runs[i]);
+    }
+    if (lt_build(&mg) < 0)
+        goto end;
+
+    /* take the winner until all runs are exhausted */
+    for (const char *x; (x = lt_cur(&mg, mg.lt[0])) != NULL;) {
+        memcpy(obuf + nb_o * rec, x, rec);
+        if (++nb_o == nb_r) {
+            if (fwrite(obuf, rec, nb_o, out) != nb_o)
+                goto end;
+            nb_o = 0;
+        }
+        mg.in[mg.lt[0]].pos++;
+        lt_replay(&mg, mg.lt[0]);
+    }
+    for (int i = 0; i < k; i++)
+        if (mg.in[i].err)
+            goto end;
+    if (fwrite(obuf, rec, nb_o, out) != nb_o || fflush(out) != 0)
+        goto end;
+    ret = 0;
+end:
+    if (ret < 0)
+        fprintf(stderr, "ERROR merging runs\n");
+    for (int i = 0; i < k; i++) {
+        if (mg.in != NULL)
+            free(mg.in[i].buf);
+        fclose(runs[i]);
+    }
+    free(obuf);
+    free(mg.lt);
+    free(mg.in);
+    return ret;
+}
+
+/******************************************************************************/
+/* external sort                                                              */
+/******************************************************************************/
+
+/*
+ * generate sorted runs from input file.
+ *
+ * the memory budget is split into 2 blocks, one is read and sorted while
+ * the other is being written by a writer thread.
+ *
+ * @return 0 on success, otherwise -1.
+ */
+
+static int gen_runs(FILE *in, size_t rec, size_t mem, const char *dir,
+                    int(*cmp)(const void *, const void *),
+                    FILE ***runs, int *nb, int *cap) {
+    size_t    nb_blk = mem / 2 / rec, nb_rd;
+    char     *blk[2] = {NULL, NULL};
+    RunOut    ro[2];
+    pthread_t tid;
+    int       busy = -1, ret = -1;    /* block being written by thread */
+
+    if (nb_blk * rec < MIN_BUF)
+        nb_blk = (MIN_BUF + rec - 1) / rec;
+    if (nb_blk > INT32_MAX)
+        nb_blk = INT32_MAX;
+    blk[0] = (char *)malloc(nb_blk * rec);
+    blk[1] = (char *)malloc(nb_blk * rec);
+    if (blk[0] == NULL || blk[1] == NULL) {
+        fprintf(stderr, "ERROE allocating memory\n");
+        goto end;
+    }
+    for (int cur = 0; (nb_rd = fread(blk[cur], rec, nb_blk, in)) > 0;
+         cur ^= 1) {
+        quick_sort(blk[cur], (int)nb_rd, rec, cmp);
+        if (busy >= 0) {
+            pthread_join(tid, NULL);
+            busy = -1;
+            if (ro[cur ^ 1].err)
+                goto end;
+        }
+        ro[cur].buf  = blk[cur];
+        ro[cur].size = nb_rd * rec;
+        ro[cur].err  = 0;
+        if ((ro[cur].fp = run_create(dir)) == NULL)
+            goto end;
+        if (run_push(runs, nb, cap, ro[cur].fp) < 0) {
+            fclose(ro[cur].fp);
+            goto end;
+        }
+        if (pthread_create(&tid, NULL, run_write, &ro[cur]) == 0)
+            busy = cur;
+        else if (run_write(&ro[cur]), ro[cur].err)
+            goto end;
+    }
+    ret = ferror(in) ? -1 : 0;
+end:
+    if (busy >= 0) {
+        pthread_join(tid, NULL);
+        if (ro[busy].err)
+            ret = -1;
+    }
+    if (ret < 0)
+        fprintf(stderr, "ERROR generating runs\n");
+    free(blk[1]);
+    free(blk[0]);
+    return ret;
+}
+
+/*
+ * external merge sort function, it sorts a file of fixed-width records,
+ * which may be larger than memory.
+ *
+ * runs of half of memory budget are generated first, then fan_in runs are
+ * merged into one run at a time, until no more than fan_in runs are left,
+ * which are merged into output file.
+ *
+ * time  complexity: O(n * log n), I/O: O(n * log(n / M) / log(fan_in))
+ * space complexity: O(M) of memory, O(n) of disk
+ *
+ * @param in_path  is path of input file.
+ * @param out_path is path of output file, it may be in_path.
+ * @param rec      is bytes of a record.
+ * @param cmp      is a pointer to a function comparing records.
+ * @param cfg      is a pointer to configuration, NULL for default.
+ *
+ * @return 0 on success, otherwise -1.
+ */
+
+int ext_sort(const char *in_path, const char *out_path, size_t rec,
+             int(*cmp)(const void *, const void *), const ExtCfg *cfg) {
+    size_t      mem    = cfg != NULL && cfg->mem ? cfg->mem : DEF_MEM;
+    const char *dir    = cfg != NULL ? cfg->tmp_dir : NULL;
+    int         fan_in = cfg != NULL && cfg->fan_in ? cfg->fan_in : DEF_FAN_IN;
+    FILE      **runs   = NULL;
+    FILE       *in     = NULL, *out = NULL, *fp = NULL;
+    int         nb = 0, cap = 0, first = 0, err, ret = -1;
+
+    if (rec == 0 || fan_in < 2)
+        return -1;
+    if (dir == NULL && (dir = getenv("TMPDIR")) == NULL)
+        dir = "/tmp";
+    if ((in = fopen(in_path, "rb")) == NULL) {
+        fprintf(stderr, "ERROR opening %s\n", in_path);
+        return -1;
+    }
+    ret = gen_runs(in, rec, mem, dir, cmp, &runs, &nb, &cap);
+    fclose(in);
+    if (ret < 0)
+        goto end;
+
+    /* merge the first fan_in runs into a new one, until few are left */
+    ret = -1;
+    for (; nb - first > fan_in; first += fan_in) {
+        if ((fp = run_create(dir)) == NULL)
+            goto end;
+        if (run_push(&runs, &nb, &cap, fp) < 0) {
+            fclose(fp);
+            goto end;
+        }
+        /* runs are closed by 'merge_runs()' even on failure */
+        err = merge_runs(runs + first, fan_in, fp, rec, mem, cmp);
+        memset(runs + first, 0, sizeof(FILE *) * fan_in);
+        if (err < 0)
+            goto end;
+    }
+
+    if ((out = fopen(out_path, "wb")) == NULL) {
+        fprintf(stderr, "ERROR opening %s\n", out_path);
+        goto end;
+    }
+    ret = merge_runs(runs + first, nb - first, out, rec, mem, cmp);
+    memset(runs + first, 0, sizeof(FILE *) * (nb - first));
+    if (fclose(out) != 0)
+        ret = -1;
+end:
+    for (int i = 0; i < nb; i++)
+        if (runs[i] != NULL)
+            fclose(runs[i]);
+    free(runs);
+    return ret;
+}
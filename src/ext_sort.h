@@ -0,0 +1,61 @@
+/**
+ * @file ext_sort.h
+ * head file contains of declaration of external merge sort, which sorts a
+ * file of fixed-width records larger than memory.
+ *
+ * @author  duruyao
+ * @version 1.0  19-12-19
+ * @update  [id] [yy-mm-dd] [author] [description]
+ */
+
+#ifndef __EXTSORTH__
+#define __EXTSORTH__
+
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif /* __plusplus */
+
+
+/******************************************************************************/
+/*                                                                            */
+/* struct declaration                                                         */
+/*                                                                            */
+/******************************************************************************/
+
+
+/******************************************************************************/
+/* ExtCfg type                                                                */
+/******************************************************************************/
+
+/*
+ * configuration of external merge sort, a field of 0 or NULL takes the
+ * default value.
+ */
+
+struct ext_cfg {
+    size_t      mem;            /* memory budget in bytes, 256 MB          */
+    const char *tmp_dir;        /* directory of runs, $TMPDIR or /tmp      */
+    int         fan_in;         /* max runs merged at a time, 64           */
+};
+
+typedef struct ext_cfg ExtCfg;
+
+
+/******************************************************************************/
+/*                                                                            */
+/* function declaration                                                       */
+/*                                                                            */
+/******************************************************************************/
+
+
+extern int  ext_sort        (const char *, const char *, size_t,
+                             int(*)(const void *, const void *),
+                             const ExtCfg *);
+
+#ifdef __cplusplus
+}
+#endif /* __plusplus */
+
+#endif /* !__EXTSORTH__ */
@@ -0,0 +1,1282 @@
+/**
+ * @file par_sort.c
+ * source file contains of difination of parallel sort algorithm, which are
+ * run by a work-stealing thread pool.
+ *
+ * @author  duruyao
+ * @version 1.0  19-12-19
+ * @update  [id] [yy-mm-dd] [author] [description]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define STAT_HOOK_ALLOC
+#include "perf_stat.h"
+#include "sort_algo.h"
+#include "thread_pool.h"
+
+
+/******************************************************************************/
+/*                                                                            */
+/* struct defination                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+
+#define PAR_MIN     (1 << 15)   /* fewer elements are sorted sequentially  */
+#define TASK_CUTOFF (1 << 14)   /* fewer elements are sorted by one task   */
+#define SAMPLE_NUM  63          /* number of samples to select a pivot     */
+
+/*
+ * context of a parallel quick sort.
+ */
+
+typedef struct qs_ctx {
+    ThreadPool *pool;
+    TaskGrp     grp;            /* group of sorting tasks                  */
+    void      **arr;
+    void      **tmp;            /* scratch array for parallel partitioning */
+    int         begin;          /* the first index of arr and tmp          */
+    int(*cmp)(const void *, const void *);
+} QsCtx;
+
+/*
+ * a range [begin, end) of a parallel quick sort.
+ */
+
+typedef struct qs_task {
+    QsCtx *ctx;
+    int    begin;
+    int    end;
+} QsTask;
+
+/*
+ * a chunk of parallel partitioning.
+ */
+
+typedef struct ptn_chunk {
+    QsCtx *ctx;
+    void  *pivot;
+    int    begin;
+    int    end;
+    int    nb_lt;               /* number of elements less than pivot      */
+    int    nb_eq;               /* number of elements equal to pivot       */
+    int    dst_lt;              /* destination of elements less than pivot */
+    int    dst_eq;              /* destination of elements equal to pivot  */
+    int    dst_gt;              /* destination of the others               */
+} PtnChunk;
+
+
+/******************************************************************************/
+/*                                                                            */
+/* function defination                                                        */
+/*                                                                            */
+/******************************************************************************/
+
+
+/******************************************************************************/
+/* parallel quick sort                                                        */
+/******************************************************************************/
+
+/*
+ * select a pivot index, which is median of SAMPLE_NUM evenly spaced samples.
+ *
+ * @param arr   is an allocated array of pointers to opaque type data.
+ * @param begin is left index of array.
+ * @param end   is right index of array.
+ * @param cmp   is a pointer to a function comparing elements.
+ *
+ * @return index of pivot.
+ */
+
+static int sample_pivot_p(void **arr, int begin, int end,
+                          int(*cmp)(const void *, const void *)) {
+    int idx[SAMPLE_NUM], step = (end - begin) / SAMPLE_NUM;
+    if (step == 0)
+        return begin + (end - begin) / 2;
+    for (int i = 0, j, v; i < SAMPLE_NUM; i++) {
+        v = begin + i * step;
+        for (j = i - 1; j >= 0 && cmp(arr[idx[j]], arr[v]) > 0; j--)
+            idx[j + 1] = idx[j];
+        idx[j + 1] = v;
+    }
+    return idx[SAMPLE_NUM / 2];
+}
+
+/*
+ * task of parallel quick sort.
+ *
+ * a range is partitioned by 'partition_p()', the smaller side is spawned as
+ * a new task and the larger one is continued, until the range is smaller
+ * than TASK_CUTOFF, which is sorted by 'quick_sort_p()'. equal elements all
+ * fall on one side, so after 2 * log2(n) levels the range is left to
+ * 'quick_sort_p()' as well.
+ */
+
+static void qs_task_run(void *arg) {
+    QsTask *t   = (QsTask *)arg;
+    QsCtx  *ctx = t->ctx;
+    int begin = t->begin, end = t->end, depth = 0;
+    free(t);
+    for (int n = end - begin; n > 1; n >>= 1)
+        depth += 2;
+    while (end - begin > TASK_CUTOFF && depth-- > 0) {
+        int pivot = sample_pivot_p(ctx->arr, begin, end, ctx->cmp);
+        pivot = partition_p(ctx->arr, begin, end, pivot, ctx->cmp);
+        QsTask *sub = (QsTask *)malloc(sizeof(QsTask));
+        if (sub == NULL)
+            break;
+        sub->ctx = ctx;
+        if (pivot - begin < end - pivot - 1) {
+            sub->begin = begin, sub->end = pivot;
+            begin = pivot + 1;
+        } else {
+            sub->begin = pivot + 1, sub->end = end;
+            end = pivot;
+        }
+        pool_submit(ctx->pool, &ctx->grp, qs_task_run, sub);
+    }
+    quick_sort_p(ctx->arr, begin, end, ctx->cmp);
+}
+
+/*
+ * spawn a task sorting range [begin, end).
+ */
+
+static void qs_spawn(QsCtx *ctx, int begin, int end) {
+    QsTask *t = NULL;
+    if (end - begin < 2)
+        return;
+    t = (QsTask *)malloc(sizeof(QsTask));
+    if (t == NULL) {
+        quick_sort_p(ctx->arr, begin, end, ctx->cmp);
+        return;
+    }
+    t->ctx   = ctx;
+    t->begin = begin;
+    t->end   = end;
+    pool_submit(ctx->pool, &ctx->grp, qs_task_run, t);
+}
+
+/*
+ * task of parallel partitioning, phase 1.
+ *
+ * elements of the chunk less than pivot are written to the front of the
+ * same range of scratch array, greater ones to the back, and equal ones,
+ * gathered in place in the chunk meanwhile, to the gap between them.
+ */
+
+static void ptn_classify(void *arg) {
+    PtnChunk *c   = (PtnChunk *)arg;
+    QsCtx    *ctx = c->ctx;
+    void **src = ctx->arr, **dst = ctx->tmp - ctx->begin;
+    int lt = c->begin, gt = c->end, eq = c->begin;
+    for (int i = c->begin, r; i < c->end; i++) {
+        r = ctx->cmp(src[i], c->pivot);
+        if (r < 0)
+            dst[lt++] = src[i];
+        else if (r > 0)
+            dst[--gt] = src[i];
+        else
+            src[eq++] = src[i];
+    }
+    memcpy(dst + lt, src + c->begin, sizeof(void *) * (eq - c->begin));
+    c->nb_lt = lt - c->begin;
+    c->nb_eq = eq - c->begin;
+}
+
+/*
+ * task of parallel partitioning, phase 2.
+ *
+ * three parts of the chunk are copied back to their final places.
+ */
+
+static void ptn_scatter(void *arg) {
+    PtnChunk *c   = (PtnChunk *)arg;
+    QsCtx    *ctx = c->ctx;
+    void **src = ctx->tmp - ctx->begin + c->begin;
+    memcpy(ctx->arr + c->dst_lt, src, sizeof(void *) * c->nb_lt);
+    memcpy(ctx->arr + c->dst_eq, src + c->nb_lt, sizeof(void *) * c->nb_eq);
+    memcpy(ctx->arr + c->dst_gt, src + c->nb_lt + c->nb_eq,
+           sizeof(void *) * (c->end - c->begin - c->nb_lt - c->nb_eq));
+}
+
+/*
+ * partition range [begin, end) three ways by all threads of pool, into
+ * [begin, lt) less than pivot, [lt, gt) equal to it and [gt, end) greater.
+ *
+ * @return lt on success, and gt is set, otherwise -1.
+ */
+
+static int par_partition_p(QsCtx *ctx, int begin, int end, int *gt) {
+    int nb_c = pool_size(ctx->pool) + 1;
+    int pivot = sample_pivot_p(ctx->arr, begin, end, ctx->cmp);
+    int lo = begin + 1, step = 0, nb_lt = 0, nb_eq = 0, nb_gt = 0;
+    PtnChunk *chunks = NULL;
+    TaskGrp   grp;
+
+    chunks = (PtnChunk *)malloc(sizeof(PtnChunk) * nb_c);
+    if (chunks == NULL)
+        return -1;
+    SWAP_PTR(ctx->arr[begin], ctx->arr[pivot]);
+    step = (end - lo + nb_c - 1) / nb_c;
+    for (int i = 0; i < nb_c; i++) {
+        chunks[i].ctx   = ctx;
+        chunks[i].pivot = ctx->arr[begin];
+        chunks[i].begin = lo + i * step < end ? lo + i * step : end;
+        chunks[i].end   = lo + (i + 1) * step < end ? lo + (i + 1) * step : end;
+    }
+
+    grp_init(&grp);
+    for (int i = 0; i < nb_c; i++)
+        pool_submit(ctx->pool, &grp, ptn_classify, &chunks[i]);
+    pool_wait(ctx->pool, &grp);
+
+    for (int i = 0; i < nb_c; i++) {
+        nb_lt += chunks[i].nb_lt;
+        nb_eq += chunks[i].nb_eq;
+    }
+    for (int i = 0, lt = 0, eq = 0; i < nb_c; i++) {
+        chunks[i].dst_lt = lo + lt;
+        chunks[i].dst_eq = lo + nb_lt + eq;
+        chunks[i].dst_gt = lo + nb_lt + nb_eq + nb_gt;
+        lt    += chunks[i].nb_lt;
+        eq    += chunks[i].nb_eq;
+        nb_gt += chunks[i].end - chunks[i].begin -
+                 chunks[i].nb_lt - chunks[i].nb_eq;
+    }
+    for (int i = 0; i < nb_c; i++)
+        pool_submit(ctx->pool, &grp, ptn_scatter, &chunks[i]);
+    pool_wait(ctx->pool, &grp);
+    grp_destroy(&grp);
+    free(chunks);
+
+    pivot = begin + nb_lt;
+    SWAP_PTR(ctx->arr[begin], ctx->arr[pivot]);
+    *gt = pivot + 1 + nb_eq;
+    return pivot;
+}
+
+/*
+ * keep range [begin, end) to be sorted by a task later, or spawn the task
+ * at once if leaves are full.
+ */
+
+static void qs_leaf(QsCtx *ctx, int *leaves, int *nb_l, int cap,
+                    int begin, int end) {
+    if (end - begin < 2)
+        return;
+    if (*nb_l + 2 <= 2 * cap) {
+        leaves[(*nb_l)++] = begin;
+        leaves[(*nb_l)++] = end;
+    } else
+        qs_spawn(ctx, begin, end);
+}
+
+/*
+ * parallel quick sort function based on pointer, using a thread pool.
+ *
+ * ranges larger than 1 / (pool_size() + 1) of the array are partitioned
+ * three ways by all threads, keys equal to pivot are never partitioned
+ * again, and a range of which one side is empty is not partitioned by all
+ * threads any more. the others are sorted by tasks, which spawn the smaller
+ * side as a new task above a cutoff and call 'quick_sort_p()' below it.
+ * the result is the same as 'quick_sort_p()' under cmp, both are not
+ * stable.
+ *
+ * @param pool  is a pointer to thread pool.
+ * @param arr   is an allocated array of pointers to opaque type data.
+ * @param begin is left index of array.
+ * @param end   is right index of array.
+ * @param cmp   is a pointer to a function comparing elements.
+ */
+
+void quick_sort_pool_p(ThreadPool *pool, void **arr, int begin, int end,
+                       int(*cmp)(const void *, const void *)) {
+    int n = end - begin, nb_thrd = pool_size(pool) + 1;
+    int *ranges = NULL, *leaves = NULL, nb_r = 0, nb_l = 0, cap = 0;
+    QsCtx ctx;
+
+    if (nb_thrd == 1 || n < PAR_MIN) {
+        quick_sort_p(arr, begin, end, cmp);
+        return;
+    }
+    ctx.pool  = pool;
+    ctx.arr   = arr;
+    ctx.begin = begin;
+    ctx.cmp   = cmp;
+    grp_init(&ctx.grp);
+
+    /* partition large ranges by all threads */
+    cap    = 4 * nb_thrd + 64;
+    ctx.tmp = (void **)malloc(sizeof(void *) * n);
+    ranges = (int *)malloc(sizeof(int) * 2 * cap);
+    leaves = (int *)malloc(sizeof(int) * 2 * cap);
+    if (ctx.tmp != NULL && ranges != NULL && leaves != NULL) {
+        ranges[nb_r++] = begin;
+        ranges[nb_r++] = end;
+    } else
+        qs_spawn(&ctx, begin, end);
+    while (nb_r > 0) {
+        int hi = ranges[--nb_r];
+        int lo = ranges[--nb_r];
+        int lt = -1, gt = -1;
+        if (hi - lo > n / nb_thrd && hi - lo > PAR_MIN && nb_r + 4 <= 2 * cap)
+            lt = par_partition_p(&ctx, lo, hi, &gt);
+        if (lt < 0) {
+            qs_leaf(&ctx, leaves, &nb_l, cap, lo, hi);
+        } else if (lt - lo > 1 && hi - gt > 1) {
+            ranges[nb_r++] = lo;
+            ranges[nb_r++] = lt;
+            ranges[nb_r++] = gt;
+            ranges[nb_r++] = hi;
+        } else {
+            qs_leaf(&ctx, leaves, &nb_l, cap, lo, lt);
+            qs_leaf(&ctx, leaves, &nb_l, cap, gt, hi);
+        }
+    }
+
+    /* sort the others by tasks */
+    for (int i = 0; i < nb_l; i += 2)
+        qs_spawn(&ctx, leaves[i], leaves[i + 1]);
+    pool_wait(pool, &ctx.grp);
+    grp_destroy(&ctx.grp);
+    free(leaves);
+    free(ranges);
+    free(ctx.tmp);
+}
+
+/*
+ * parallel quick sort function based on pointer.
+ *
+ * best    case: < O(n * log n / p)
+ * worst   case:   O(n * log n)
+ * average case:   O(n * log n / p)
+ *
+ * @param arr     is an allocated array of pointers to opaque type data.
+ * @param begin   is left index of array.
+ * @param end     is right index of array.
+ * @param cmp     is a pointer to a function comparing elements.
+ * @param nb_thrd is number of threads, 'nb_hw_thrd()' if it is less than 1.
+ */
+
+void quick_sort_par_p(void **arr, int begin, int end,
+                      int(*cmp)(const void *, const void *), int nb_thrd) {
+    ThreadPool *pool = NULL;
+    if (nb_thrd < 1)
+        nb_thrd = nb_hw_thrd();
+    if (nb_thrd == 1 || end - begin < PAR_MIN ||
+        (pool = pool_create(nb_thrd - 1)) == NULL) {
+        quick_sort_p(arr, begin, end, cmp);
+        return;
+    }
+    quick_sort_pool_p(pool, arr, begin, end, cmp);
+    pool_destroy(pool);
+}
+
+/******************************************************************************/
+/* parallel merge sort                                                        */
+/******************************************************************************/
+
+/*
+ * a leaf or a segment of merging of parallel merge sort.
+ */
+
+typedef struct ms_task {
+    void **a;                   /* the left run, or the leaf to sort       */
+    void **b;                   /* the right run, or scratch of the leaf   */
+    void **out;                 /* output of the merging of two runs       */
+    int    na;
+    int    nb;
+    int    k0;                  /* output range [k0, k1) of the segment    */
+    int    k1;
+    int(*cmp)(const void *, const void *);
+} MsTask;
+
+/*
+ * co-rank of the k-th output element of merging a and b (merge path).
+ *
+ * the first k elements of output consist of a[0, i) and b[0, k - i), if
+ * two elements are equal, the one of a is taken first.
+ *
+ * @return i.
+ */
+
+static int co_rank_p(int k, void **a, int na, void **b, int nb,
+                     int(*cmp)(const void *, const void *)) {
+    int lo = k - nb > 0 ? k - nb : 0;
+    int hi = k < na ? k : na;
+    while (lo < hi) {
+        int i = lo + (hi - lo) / 2;
+        if (cmp(a[i], b[k - i - 1]) <= 0)
+            lo = i + 1;
+        else
+            hi = i;
+    }
+    return lo;
+}
+
+/*
+ * task sorting a leaf by 'm_sort_p()', the leaf is copied to scratch first.
+ */
+
+static void ms_leaf(void *arg) {
+    MsTask *t = (MsTask *)arg;
+    memcpy(t->b, t->a, sizeof(void *) * t->na);
+    m_sort_p(t->b, t->a, 0, t->na, t->cmp);
+}
+
+/*
+ * task merging output range [k0, k1) of two runs.
+ */
+
+static void ms_merge(void *arg) {
+    MsTask *t = (MsTask *)arg;
+    int i0 = co_rank_p(t->k0, t->a, t->na, t->b, t->nb, t->cmp);
+    int i1 = co_rank_p(t->k1, t->a, t->na, t->b, t->nb, t->cmp);
+    merge_p(t->a + i0, i1 - i0, t->b + t->k0 - i0, t->k1 - i1 - t->k0 + i0,
+            t->out + t->k0, t->cmp);
+}
+
+/*
+ * parallel merge sort function based on pointer, using a thread pool.
+ *
+ * the array is divided into one leaf per thread, leaves are sorted by
+ * 'm_sort_p()' in parallel, then runs are merged pairwise. every merging is
+ * split into segments of about n / p outputs by co-ranking, so that the
+ * last merging uses all threads too. it is stable as 'merge_sort_p()'.
+ *
+ * time  complexity: O(n * log n / p + log n * log p)
+ * space complexity: O(n)
+ *
+ * @param pool is a pointer to thread pool.
+ * @param arr  is an allocated array of pointers to opaque type data.
+ * @param n    is number of elements in the array.
+ * @param cmp  is a pointer to a function comparing elements.
+ */
+
+void merge_sort_pool_p(ThreadPool *pool, void **arr, int n,
+                       int(*cmp)(const void *, const void *)) {
+    int nb_thrd = pool_size(pool) + 1, nb_run = nb_thrd, nb_t = 0;
+    void **tmp = NULL, **src = arr, **dst = NULL, **t = NULL;
+    int *bound = NULL;
+    MsTask *tasks = NULL;
+    TaskGrp grp;
+
+    if (nb_thrd == 1 || n < PAR_MIN) {
+        merge_sort_p(arr, n, cmp);
+        return;
+    }
+    tmp   = (void **)malloc(sizeof(void *) * n);
+    bound = (int *)malloc(sizeof(int) * (nb_run + 1));
+    tasks = (MsTask *)malloc(sizeof(MsTask) * 2 * nb_thrd);
+    if (tmp == NULL || bound == NULL || tasks == NULL) {
+        free(tasks);
+        free(bound);
+        free(tmp);
+        merge_sort_p(arr, n, cmp);
+        return;
+    }
+    grp_init(&grp);
+
+    /* sort leaves */
+    for (int i = 0; i <= nb_run; i++)
+        bound[i] = (int)((long long)n * i / nb_run);
+    for (int i = 0; i < nb_run; i++) {
+        tasks[i].a   = arr + bound[i];
+        tasks[i].b   = tmp + bound[i];
+        tasks[i].na  = bound[i + 1] - bound[i];
+        tasks[i].cmp = cmp;
+        pool_submit(pool, &grp, ms_leaf, &tasks[i]);
+    }
+    pool_wait(pool, &grp);
+
+    /* merge runs pairwise, every round splits n outputs into segments */
+    dst = tmp;
+    while (nb_run > 1) {
+        int seg = (n + nb_thrd - 1) / nb_thrd;
+        nb_t = 0;
+        for (int r = 0; r + 1 < nb_run; r += 2) {
+            int lo = bound[r], med = bound[r + 1], hi = bound[r + 2];
+            for (int k = 0; k < hi - lo; k += seg) {
+                MsTask *mt = &tasks[nb_t++];
+                mt->a   = src + lo;
+                mt->na  = med - lo;
+                mt->b   = src + med;
+                mt->nb  = hi - med;
+                mt->out = dst + lo;
+                mt->k0  = k;
+                mt->k1  = k + seg < hi - lo ? k + seg : hi - lo;
+                mt->cmp = cmp;
+                pool_submit(pool, &grp, ms_merge, mt);
+            }
+        }
+        if (nb_run % 2 == 1)
+            memcpy(dst + bound[nb_run - 1], src + bound[nb_run - 1],
+                   sizeof(void *) * (n - bound[nb_run - 1]));
+        pool_wait(pool, &grp);
+        for (int r = 0; r <= (nb_run + 1) / 2; r++)
+            bound[r] = bound[2 * r < nb_run ? 2 * r : nb_run];
+        nb_run = (nb_run + 1) / 2;
+        t = src, src = dst, dst = t;
+    }
+    if (src != arr)
+        memcpy(arr, src, sizeof(void *) * n);
+
+    grp_destroy(&grp);
+    free(tasks);
+    free(bound);
+    free(tmp);
+}
+
+/*
+ * parallel merge sort function based on pointer, it is stable.
+ *
+ * time  complexity: O(n * log n / p + log n * log p)
+ * space complexity: O(n)
+ *
+ * @param arr     is an allocated array of pointers to opaque type data.
+ * @param n       is number of elements in the array.
+ * @param cmp     is a pointer to a function comparing elements.
+ * @param nb_thrd is number of threads, 'nb_hw_thrd()' if it is less than 1.
+ */
+
+void merge_sort_par_p(void **arr, int n,
+                      int(*cmp)(const void *, const void *), int nb_thrd) {
+    ThreadPool *pool = NULL;
+    if (nb_thrd < 1)
+        nb_thrd = nb_hw_thrd();
+    if (nb_thrd == 1 || n < PAR_MIN ||
+        (pool = pool_create(nb_thrd - 1)) == NULL) {
+        merge_sort_p(arr, n, cmp);
+        return;
+    }
+    merge_sort_pool_p(pool, arr, n, cmp);
+    pool_destroy(pool);
+}
+
+/******************************************************************************/
+/* parallel bucket sort                                                       */
+/******************************************************************************/
+
+/*
+ * a chunk of input, or a range of buckets, of parallel bucket sort.
+ */
+
+typedef struct bs_task {
+    void  **arr;
+    void  **tmp;                /* scratch array of n elements             */
+    Bucket *buckets;            /* the first bucket of the range           */
+    int    *hist;               /* histogram, then cursors of the chunk    */
+    int     begin;              /* range [begin, end) of input chunk       */
+    int     end;
+    int     k;                  /* number of buckets                       */
+    int(*hash)(void *, int);
+    int(*cmp)(const void *, const void *);
+} BsTask;
+
+/*
+ * task counting elements of a chunk per bucket.
+ */
+
+static void bs_count(void *arg) {
+    BsTask *t = (BsTask *)arg;
+    for (int i = t->begin; i < t->end; i++)
+        t->hist[t->hash(t->arr[i], t->k)]++;
+}
+
+/*
+ * task scattering elements of a chunk to its cursors of buckets.
+ */
+
+static void bs_scatter(void *arg) {
+    BsTask *t = (BsTask *)arg;
+    for (int i = t->begin; i < t->end; i++)
+        t->tmp[t->hist[t->hash(t->arr[i], t->k)]++] = t->arr[i];
+}
+
+/*
+ * task copying a range of buckets back and sorting them.
+ */
+
+static void bs_sort(void *arg) {
+    BsTask *t = (BsTask *)arg;
+    memcpy(t->arr + t->begin, t->tmp + t->begin,
+           sizeof(void *) * (t->end - t->begin));
+    ext_bucket_p(t->arr, t->buckets, t->end - t->begin, t->k, t->cmp);
+}
+
+/*
+ * parallel bucket sort function based on pointer, using a thread pool.
+ *
+ * every thread counts a chunk of input into its own histogram, so no
+ * counter is shared. the prefix sum over buckets, and over threads inside
+ * a bucket, gives every thread its own cursors, then chunks are scattered
+ * in parallel. buckets are grouped into tasks of about n / (4 * p)
+ * elements and sorted in place.
+ *
+ * time  complexity: O(n / p + k * p)
+ * space complexity: O(n + k * p)
+ *
+ * @param pool    is a pointer to thread pool.
+ * @param arr     is an input allocated array of pointers to opaque type data.
+ * @param n       is the number of elements of input set.
+ * @param nb_bkts is a pointer to a function getting suitable number of buckets.
+ * @param hash    is pointer to a hash func getting index.
+ * @param cmp     is a pointer to a function comparing elements.
+ */
+
+void bucket_sort_pool_p(ThreadPool *pool, void **arr, int n,
+                        int(*nb_bkts)(int),
+                        int(*hash)(void *, int),
+                        int(*cmp)(const void *, const void *)) {
+    int nb_thrd = pool_size(pool) + 1, nb_t = 0, k = nb_bkts(n);
+    int grain = n / (4 * nb_thrd) + 1;
+    void  **tmp     = NULL;
+    int    *hist    = NULL;
+    Bucket *buckets = NULL;
+    BsTask *tasks   = NULL;
+    TaskGrp grp;
+
+    if (nb_thrd == 1 || n < PAR_MIN) {
+        bucket_sort_p(arr, n, nb_bkts, hash, cmp);
+        return;
+    }
+    tmp     = (void **)malloc(sizeof(void *) * n);
+    hist    = (int *)calloc((size_t)k * nb_thrd, sizeof(int));
+    buckets = (Bucket *)malloc(sizeof(Bucket) * k);
+    tasks   = (BsTask *)malloc(sizeof(BsTask) * (5 * nb_thrd + 1));
+    if (tmp == NULL || hist == NULL || buckets == NULL || tasks == NULL) {
+        free(tasks);
+        free(buckets);
+        free(hist);
+        free(tmp);
+        bucket_sort_p(arr, n, nb_bkts, hash, cmp);
+        return;
+    }
+    grp_init(&grp);
+
+    /* count chunks */
+    for (int i = 0; i < nb_thrd; i++) {
+        tasks[i].arr   = arr;
+        tasks[i].tmp   = tmp;
+        tasks[i].hist  = hist + (size_t)k * i;
+        tasks[i].begin = (int)((long long)n * i / nb_thrd);
+        tasks[i].end   = (int)((long long)n * (i + 1) / nb_thrd);
+        tasks[i].k     = k;
+        tasks[i].hash  = hash;
+        pool_submit(pool, &grp, bs_count, &tasks[i]);
+    }
+    pool_wait(pool, &grp);
+
+    /* turn counts into cursors, bucket-major then thread-major */
+    for (int b = 0, pos = 0; b < k; b++) {
+        buckets[b].begin = pos;
+        for (int i = 0; i < nb_thrd; i++) {
+            int c = hist[(size_t)k * i + b];
+            hist[(size_t)k * i + b] = pos;
+            pos += c;
+        }
+        buckets[b].size = pos - buckets[b].begin;
+    }
+
+    /* scatter chunks */
+    for (int i = 0; i < nb_thrd; i++)
+        pool_submit(pool, &grp, bs_scatter, &tasks[i]);
+    pool_wait(pool, &grp);
+
+    /* sort ranges of buckets */
+    for (int b = 0, b0 = 0; b < k; b++) {
+        if (b + 1 < k && buckets[b + 1].begin - buckets[b0].begin < grain)
+            continue;
+        BsTask *st = &tasks[nb_thrd + nb_t++];
+        st->arr     = arr;
+        st->tmp     = tmp;
+        st->buckets = buckets + b0;
+        st->begin   = buckets[b0].begin;
+        st->end     = buckets[b].begin + buckets[b].size;
+        st->k       = b + 1 - b0;
+        st->cmp     = cmp;
+        pool_submit(pool, &grp, bs_sort, st);
+        b0 = b + 1;
+    }
+    pool_wait(pool, &grp);
+
+    grp_destroy(&grp);
+    free(tasks);
+    free(buckets);
+    free(hist);
+    free(tmp);
+}
+
+/*
+ * parallel bucket sort function based on pointer.
+ *
+ * time  complexity: O(n / p + k * p)
+ * space complexity: O(n + k * p)
+ *
+ * @param arr     is an input allocated array of pointers to opaque type data.
+ * @param n       is the number of elements of input set.
+ * @param nb_bkts is a pointer to a function getting suitable number of buckets.
+ * @param hash    is pointer to a hash func getting index.
+ * @param cmp     is a pointer to a function comparing elements.
+ * @param nb_thrd is number of threads, 'nb_hw_thrd()' if it is less than 1.
+ */
+
+void bucket_sort_par_p(void **arr, int n,
+                       int(*nb_bkts)(int),
+                       int(*hash)(void *, int),
+                       int(*cmp)(const void *, const void *), int nb_thrd) {
+    ThreadPool *pool = NULL;
+    if (nb_thrd < 1)
+        nb_thrd = nb_hw_thrd();
+    if (nb_thrd == 1 || n < PAR_MIN ||
+        (pool = pool_create(nb_thrd - 1)) == NULL) {
+        bucket_sort_p(arr, n, nb_bkts, hash, cmp);
+        return;
+    }
+    bucket_sort_pool_p(pool, arr, n, nb_bkts, hash, cmp);
+    pool_destroy(pool);
+}
+
+/******************************************************************************/
+/* parallel top k and selection                                               */
+/******************************************************************************/
+
+#define TK_BLOCK    1024        /* elements between threshold exchanges    */
+#define SEL_SAMPLE  4096        /* samples to find a pivot band            */
+#define SEL_BAND    128         /* half width of pivot band in samples     */
+#define SEL_MIN     (2 * SEL_SAMPLE)    /* fewer are selected by BFPRT     */
+
+/*
+ * a chunk of parallel top k, shared is the best threshold of all chunks.
+ */
+
+typedef struct tk_task {
+    TopK   *tk;
+    void  **set;
+    void  **shared;
+    int     begin;
+    int     end;
+    int(*cmp)(const void *, const void *);
+} TkTask;
+
+/*
+ * a chunk of parallel selection, elements are classified as less than lo,
+ * in band [lo, hi] or greater than hi.
+ */
+
+typedef struct sel_task {
+    void  **arr;
+    void  **tmp;
+    void   *lo;
+    void   *hi;
+    int     begin;
+    int     end;
+    int     cnt[3];             /* counts, then cursors of classes         */
+    int(*cmp)(const void *, const void *);
+} SelTask;
+
+/*
+ * @return the better of two thresholds, NULL is no threshold.
+ */
+
+static void *tk_better(void *thr1, void *thr2,
+                       int(*cmp)(const void *, const void *)) {
+    if (thr1 == NULL || thr2 == NULL)
+        return thr1 == NULL ? thr2 : thr1;
+    return cmp(thr1, thr2) <= 0 ? thr1 : thr2;
+}
+
+/*
+ * replace shared threshold if thr is better.
+ */
+
+static void tk_publish(void **shared, void *thr,
+                       int(*cmp)(const void *, const void *)) {
+    void *old = __atomic_load_n(shared, __ATOMIC_ACQUIRE);
+    while ((old == NULL || cmp(thr, old) < 0) &&
+           !__atomic_compare_exchange_n(shared, &old, thr, 1,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        ;
+}
+
+/*
+ * task pushing a chunk into its own accumulator.
+ *
+ * the threshold of every full accumulator bounds the k-th best element of
+ * whole set, so an element not better than the best of them is discarded.
+ * an element equal to the threshold is discarded too, which may keep a
+ * different one of equal elements than the sequential push would, but not
+ * a different value. thresholds are exchanged once per TK_BLOCK elements.
+ */
+
+static void tk_run(void *arg) {
+    TkTask *t = (TkTask *)arg;
+    for (int b = t->begin; b < t->end; b += TK_BLOCK) {
+        int   e   = t->end - b > TK_BLOCK ? b + TK_BLOCK : t->end;
+        void *thr = tk_better(top_k_thr(t->tk),
+                              __atomic_load_n(t->shared, __ATOMIC_ACQUIRE),
+                              t->cmp);
+        for (int i = b; i < e; i++) {
+            if (thr != NULL && t->cmp(t->set[i], thr) >= 0)
+                continue;
+            top_k_push(t->tk, t->set[i]);
+            thr = tk_better(thr, top_k_thr(t->tk), t->cmp);
+        }
+        if (top_k_thr(t->tk) != NULL)
+            tk_publish(t->shared, top_k_thr(t->tk), t->cmp);
+    }
+}
+
+/*
+ * sequential top k.
+ *
+ * @return number of elements in out on success, otherwise -1.
+ */
+
+static int top_k_seq(void **set, int n, int k, void **out,
+                     int(*cmp)(const void *, const void *)) {
+    int   nb = -1;
+    TopK *tk = top_k_create(k, cmp);
+    if (tk != NULL) {
+        top_k_push_n(tk, set, n);
+        nb = top_k_final(tk, out);
+        top_k_destroy(tk);
+    }
+    return nb;
+}
+
+/*
+ * parallel top k function based on pointer, using a thread pool.
+ *
+ * every thread keeps a bounded heap of a chunk, the heaps are merged at
+ * last. values of result are the same as of 'top_k_push_n()' and
+ * 'top_k_final()', but which of equal elements are returned, and their
+ * order, depends on chunks and timing of threads.
+ *
+ * time  complexity: O(n / p + k * log k * p)
+ * space complexity: O(k * p)
+ *
+ * @param pool is a pointer to thread pool.
+ * @param set  is an allocated array of pointers to opaque type data.
+ * @param n    is number of elements in set.
+ * @param k    is the number of best elements to select.
+ * @param out  is an allocated array of at least k pointers, which stores the
+ *             best elements in order.
+ * @param cmp  is a pointer to a function comparing elements.
+ *
+ * @return number of elements in out on success, otherwise -1.
+ */
+
+int top_k_pool_p(ThreadPool *pool, void **set, int n, int k, void **out,
+                 int(*cmp)(const void *, const void *)) {
+    int     nb_thrd = pool_size(pool) + 1, nb = 0, i;
+    void   *shared  = NULL;
+    TkTask *tasks   = NULL;
+    TaskGrp grp;
+
+    if (k < 1)
+        return -1;
+    if (nb_thrd == 1 || n < PAR_MIN)
+        return top_k_seq(set, n, k, out, cmp);
+    tasks = (TkTask *)malloc(sizeof(TkTask) * nb_thrd);
+    if (tasks == NULL)
+        return top_k_seq(set, n, k, out, cmp);
+    for (i = 0; i < nb_thrd; i++)
+        if ((tasks[i].tk = top_k_create(k, cmp)) == NULL)
+            break;
+    if (i < nb_thrd) {
+        while (i > 0)
+            top_k_destroy(tasks[--i].tk);
+        free(tasks);
+        return top_k_seq(set, n, k, out, cmp);
+    }
+    grp_init(&grp);
+    for (i = 0; i < nb_thrd; i++) {
+        tasks[i].set    = set;
+        tasks[i].shared = &shared;
+        tasks[i].begin  = (int)((long long)n * i / nb_thrd);
+        tasks[i].end    = (int)((long long)n * (i + 1) / nb_thrd);
+        tasks[i].cmp    = cmp;
+        pool_submit(pool, &grp, tk_run, &tasks[i]);
+    }
+    pool_wait(pool, &grp);
+    grp_destroy(&grp);
+
+    for (i = 1; i < nb_thrd; i++)
+        top_k_merge(tasks[0].tk, tasks[i].tk);
+    nb = top_k_final(tasks[0].tk, out);
+    for (i = 0; i < nb_thrd; i++)
+        top_k_destroy(tasks[i].tk);
+    free(tasks);
+    return nb;
+}
+
+/*
+ * parallel top k function based on pointer, equal elements are
+ * interchangeable as of 'top_k_pool_p()'.
+ *
+ * @param set     is an allocated array of pointers to opaque type data.
+ * @param n       is number of elements in set.
+ * @param k       is the number of best elements to select.
+ * @param out     is an allocated array of at least k pointers.
+ * @param cmp     is a pointer to a function comparing elements.
+ * @param nb_thrd is number of threads, 'nb_hw_thrd()' if it is less than 1.
+ *
+ * @return number of elements in out on success, otherwise -1.
+ */
+
+int top_k_par_p(void **set, int n, int k, void **out,
+                int(*cmp)(const void *, const void *), int nb_thrd) {
+    ThreadPool *pool = NULL;
+    int nb;
+    if (nb_thrd < 1)
+        nb_thrd = nb_hw_thrd();
+    if (nb_thrd == 1 || n < PAR_MIN ||
+        (pool = pool_create(nb_thrd - 1)) == NULL)
+        return k < 1 ? -1 : top_k_seq(set, n, k, out, cmp);
+    nb = top_k_pool_p(pool, set, n, k, out, cmp);
+    pool_destroy(pool);
+    return nb;
+}
+
+static inline int sel_class(SelTask *t, void *e) {
+    return t->cmp(e, t->lo) < 0 ? 0 : (t->cmp(e, t->hi) > 0 ? 2 : 1);
+}
+
+/*
+ * task counting elements of a chunk per class.
+ */
+
+static void sel_count(void *arg) {
+    SelTask *t = (SelTask *)arg;
+    memset(t->cnt, 0, sizeof(t->cnt));
+    for (int i = t->begin; i < t->end; i++)
+        t->cnt[sel_class(t, t->arr[i])]++;
+}
+
+/*
+ * task scattering elements of a chunk to its cursors of classes.
+ */
+
+static void sel_scatter(void *arg) {
+    SelTask *t = (SelTask *)arg;
+    for (int i = t->begin; i < t->end; i++)
+        t->tmp[t->cnt[sel_class(t, t->arr[i])]++] = t->arr[i];
+}
+
+/*
+ * task copying a chunk back.
+ */
+
+static void sel_copy(void *arg) {
+    SelTask *t = (SelTask *)arg;
+    memcpy(t->arr + t->begin, t->tmp + t->begin,
+           sizeof(void *) * (t->end - t->begin));
+}
+
+/*
+ * parallel selection function based on pointer, using a thread pool.
+ *
+ * 1. sort SEL_SAMPLE samples, take samples of rank about k * SEL_SAMPLE / n
+ *    plus and minus SEL_BAND as a band [lo, hi] that likely holds k-th.
+ * 2. count elements less than lo, in band and greater than hi in parallel,
+ *    and if k-th is in band, scatter elements by class in parallel.
+ * 3. repeat on band until it is small, or k-th is missed, then finish by
+ *    'BFPRT_k_idx_p()' sequentially.
+ *
+ * elements are partitioned around k-th as 'BFPRT_k_idx_p()' does.
+ *
+ * time  complexity: O(n / p) expected
+ * space complexity: O(n)
+ *
+ * @param pool  is a pointer to thread pool.
+ * @param arr   is an allocated array of pointers to opaque type data.
+ * @param begin is left index of array.
+ * @param end   is right index of array.
+ * @param k     is target top number, which is in [1, end - begin].
+ * @param cmp   is a pointer to a function comparing elements.
+ *
+ * @return index of k-th element on success, otherwise -1.
+ */
+
+int select_k_pool_p(ThreadPool *pool, void **arr, int begin, int end, int k,
+                    int(*cmp)(const void *, const void *)) {
+    int      nb_thrd = pool_size(pool) + 1, n = end - begin, off = begin;
+    int      single  = 0, eq = 0;
+    void   **tmp     = NULL;
+    SelTask *tasks   = NULL;
+    void    *smp[SEL_SAMPLE];
+    TaskGrp  grp;
+
+    if (k < 1 || k > n)
+        return -1;
+    if (nb_thrd == 1 || n < PAR_MIN)
+        return BFPRT_k_idx_p(arr, begin, end, k, cmp);
+    tmp   = (void **)malloc(sizeof(void *) * n);
+    tasks = (SelTask *)malloc(sizeof(SelTask) * nb_thrd);
+    if (tmp == NULL || tasks == NULL) {
+        free(tasks);
+        free(tmp);
+        return BFPRT_k_idx_p(arr, begin, end, k, cmp);
+    }
+    grp_init(&grp);
+
+    while (n > SEL_MIN) {
+        int   r = (int)((long long)(k - 1) * SEL_SAMPLE / n);
+        int   nb_lt = 0, nb_band = 0;
+        void *lo, *hi;
+
+        /* find a band, or a single pivot if last band did not shrink */
+        for (int i = 0; i < SEL_SAMPLE; i++)
+            smp[i] = arr[off + (int)((long long)n * i / SEL_SAMPLE)];
+        heap_sort_p(smp, SEL_SAMPLE, cmp);
+        lo = smp[single || r - SEL_BAND < 0 ? r : r - SEL_BAND];
+        hi = smp[single || r + SEL_BAND >= SEL_SAMPLE ? r : r + SEL_BAND];
+
+        /* count chunks */
+        for (int i = 0; i < nb_thrd; i++) {
+            tasks[i].arr   = arr + off;
+            tasks[i].tmp   = tmp;
+            tasks[i].lo    = lo;
+            tasks[i].hi    = hi;
+            tasks[i].begin = (int)((long long)n * i / nb_thrd);
+            tasks[i].end   = (int)((long long)n * (i + 1) / nb_thrd);
+            tasks[i].cmp   = cmp;
+            pool_submit(pool, &grp, sel_count, &tasks[i]);
+        }
+        pool_wait(pool, &grp);
+        for (int i = 0; i < nb_thrd; i++) {
+            nb_lt   += tasks[i].cnt[0];
+            nb_band += tasks[i].cnt[1];
+        }
+        if (nb_band == n) {
+            if ((eq = cmp(lo, hi) == 0))
+                break;
+            single = 1;
+            continue;
+        }
+
+        /* turn counts into cursors, class-major then chunk-major */
+        for (int c = 0, pos = 0; c < 3; c++) {
+            for (int i = 0; i < nb_thrd; i++) {
+                int cnt = tasks[i].cnt[c];
+                tasks[i].cnt[c] = pos;
+                pos += cnt;
+            }
+        }
+        for (int i = 0; i < nb_thrd; i++)
+            pool_submit(pool, &grp, sel_scatter, &tasks[i]);
+        pool_wait(pool, &grp);
+        for (int i = 0; i < nb_thrd; i++)
+            pool_submit(pool, &grp, sel_copy, &tasks[i]);
+        pool_wait(pool, &grp);
+
+        /* continue on the class holding k-th */
+        single = 0;
+        if (k <= nb_lt) {
+            n = nb_lt;
+        } else if (k <= nb_lt + nb_band) {
+            off += nb_lt;
+            k   -= nb_lt;
+            n    = nb_band;
+            if ((eq = cmp(lo, hi) == 0))
+                break;
+        } else {
+            off += nb_lt + nb_band;
+            k   -= nb_lt + nb_band;
+            n   -= nb_lt + nb_band;
+        }
+    }
+
+    grp_destroy(&grp);
+    free(tasks);
+    free(tmp);
+    /* a range of equal elements needs no selection */
+    return eq ? off + k - 1 : BFPRT_k_idx_p(arr, off, off + n, k, cmp);
+}
+
+/*
+ * parallel selection function based on pointer.
+ *
+ * @param arr     is an allocated array of pointers to opaque type data.
+ * @param begin   is left index of array.
+ * @param end     is right index of array.
+ * @param k       is target top number, which is in [1, end - begin].
+ * @param cmp     is a pointer to a function comparing elements.
+ * @param nb_thrd is number of threads, 'nb_hw_thrd()' if it is less than 1.
+ *
+ * @return index of k-th element on success, otherwise -1.
+ */
+
+int select_k_par_p(void **arr, int begin, int end, int k,
+                   int(*cmp)(const void *, const void *), int nb_thrd) {
+    ThreadPool *pool = NULL;
+    int idx;
+    if (nb_thrd < 1)
+        nb_thrd = nb_hw_thrd();
+    if (k < 1 || k > end - begin)
+        return -1;
+    if (nb_thrd == 1 || end - begin < PAR_MIN ||
+        (pool = pool_create(nb_thrd - 1)) == NULL)
+        return BFPRT_k_idx_p(arr, begin, end, k, cmp);
+    idx = select_k_pool_p(pool, arr, begin, end, k, cmp);
+    pool_destroy(pool);
+    return idx;
+}
+
+/******************************************************************************/
+/* parallel segmented sort                                                    */
+/******************************************************************************/
+
+/*
+ * sequential segmented sort function of one chunk of segments.
+ */
+
+typedef void(*SegFn)(void *, const int *, int,
+                     int(*)(const void *, const void *));
+
+/*
+ * a chunk of consecutive segments of parallel segmented sort.
+ */
+
+typedef struct seg_task {
+    SegFn      fn;
+    void      *arr;
+    const int *off;             /* offsets of the first segment and on     */
+    int        nb_seg;
+    int(*cmp)(const void *, const void *);
+} SegTask;
+
+/*
+ * task sorting a chunk of segments.
+ */
+
+static void seg_run(void *arg) {
+    SegTask *t = (SegTask *)arg;
+    t->fn(t->arr, t->off, t->nb_seg, t->cmp);
+}
+
+/*
+ * split segments into chunks of about n / (4 * p) elements, which are
+ * sorted by fn in parallel, so that many small segments and a few large
+ * ones are balanced alike.
+ */
+
+static void seg_sort_pool(ThreadPool *pool, SegFn fn, void *arr,
+                          const int *off, int nb_seg,
+                          int(*cmp)(const void *, const void *)) {
+    int nb_thrd = pool_size(pool) + 1, nb_t = 0, n = off[nb_seg] - off[0];
+    int grain = n / (4 * nb_thrd) + 1;
+    SegTask *tasks = NULL;
+    TaskGrp  grp;
+
+    if (nb_thrd == 1 || n < PAR_MIN ||
+        (tasks = (SegTask *)malloc(sizeof(SegTask) * (4 * nb_thrd + 1)))
+        == NULL) {
+        fn(arr, off, nb_seg, cmp);
+        return;
+    }
+    grp_init(&grp);
+    for (int i = 0, i0 = 0; i < nb_seg; i++) {
+        if (i + 1 < nb_seg && off[i + 1] - off[i0] < grain)
+            continue;
+        tasks[nb_t].fn     = fn;
+        tasks[nb_t].arr    = arr;
+        tasks[nb_t].off    = off + i0;
+        tasks[nb_t].nb_seg = i + 1 - i0;
+        tasks[nb_t].cmp    = cmp;
+        pool_submit(pool, &grp, seg_run, &tasks[nb_t++]);
+        i0 = i + 1;
+    }
+    pool_wait(pool, &grp);
+    grp_destroy(&grp);
+    free(tasks);
+}
+
+/*
+ * create a pool of nb_thrd threads, and run 'seg_sort_pool()'.
+ */
+
+static void seg_sort_par(SegFn fn, void *arr, const int *off, int nb_seg,
+                         int(*cmp)(const void *, const void *),
+                         int nb_thrd) {
+    ThreadPool *pool = NULL;
+    if (nb_seg < 1)
+        return;
+    if (nb_thrd < 1)
+        nb_thrd = nb_hw_thrd();
+    if (nb_thrd == 1 || off[nb_seg] - off[0] < PAR_MIN ||
+        (pool = pool_create(nb_thrd - 1)) == NULL) {
+        fn(arr, off, nb_seg, cmp);
+        return;
+    }
+    seg_sort_pool(pool, fn, arr, off, nb_seg, cmp);
+    pool_destroy(pool);
+}
+
+static void seg_fn_p(void *arr, const int *off, int nb_seg,
+                     int(*cmp)(const void *, const void *)) {
+    seg_sort_p((void **)arr, off, nb_seg, cmp);
+}
+
+/*
+ * parallel segmented sort function based on pointer, using a thread pool.
+ *
+ * time  complexity: O(sum of n_i * log n_i / p)
+ * space complexity: O(p)
+ *
+ * @param pool   is a pointer to thread pool.
+ * @param arr    is an allocated array of pointers to opaque type data.
+ * @param off    is an array of nb_seg + 1 ascending indices of arr, segment
+ *               i is [off[i], off[i + 1]).
+ * @param nb_seg is number of segments.
+ * @param cmp    is a pointer to a function comparing elements.
+ */
+
+void seg_sort_pool_p(ThreadPool *pool, void **arr, const int *off,
+                     int nb_seg, int(*cmp)(const void *, const void *)) {
+    if (nb_seg > 0)
+        seg_sort_pool(pool, &seg_fn_p, arr, off, nb_seg, cmp);
+}
+
+/*
+ * parallel segmented sort function based on pointer.
+ *
+ * @param arr     is an allocated array of pointers to opaque type data.
+ * @param off     is an array of nb_seg + 1 ascending indices of arr, segment
+ *                i is [off[i], off[i + 1]).
+ * @param nb_seg  is number of segments.
+ * @param cmp     is a pointer to a function comparing elements.
+ * @param nb_thrd is number of threads, 'nb_hw_thrd()' if it is less than 1.
+ */
+
+void seg_sort_par_p(void **arr, const int *off, int nb_seg,
+                    int(*cmp)(const void *, const void *), int nb_thrd) {
+    seg_sort_par(&seg_fn_p, arr, off, nb_seg, cmp, nb_thrd);
+}
+
+/*
+ * define 'seg_sort_par_sfx(arr, off, nb_seg, nb_thrd)' of type T, which
+ * runs 'seg_sort_sfx()' of SIMD sort on chunks of segments in parallel.
+ */
+
+#define DEF_SEG_PAR(sfx, T)                                                    \
+static void seg_fn_##sfx(void *arr, const int *off, int nb_seg,                \
+                         int(*cmp)(const void *, const void *)) {              \
+    (void)cmp;                                                                 \
+    seg_sort_##sfx((T *)arr, off, nb_seg);                                     \
+}                                                                              \
+                                                                               \
+void seg_sort_par_##sfx(T *arr, const int *off, int nb_seg, int nb_thrd) {     \
+    seg_sort_par(&seg_fn_##sfx, arr, off, nb_seg, NULL, nb_thrd);              \
+}
+
+DEF_SEG_PAR(f64, double)
+DEF_SEG_PAR(f32, float)
+DEF_SEG_PAR(i64, int64_t)
+DEF_SEG_PAR(i32, int32_t)
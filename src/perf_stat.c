@@ -0,0 +1,340 @@
+/**
+ * @file perf_stat.c
+ * source file contains of difination of instrumentation of sort run.
+ *
+ * comparisons are counted by a comparator wrapping the compare function of
+ * caller, so any sort taking a compare function is counted without being
+ * built with SORT_STAT. swaps, moves and allocations are counted by hooks in
+ * sort code, which exist only if SORT_STAT is defined.
+ *
+ * hardware counters count user space of calling process and threads created
+ * during the run. a counter that can not be opened, e.g. perf_event_paranoid
+ * forbids it or running in a virtual machine without PMU, is reported as -1.
+ *
+ * @author  duruyao
+ * @version 1.0  19-12-19
+ * @update  [id] [yy-mm-dd] [author] [description]
+ */
+
+#include <time.h>
+#include <stdio.h>
+#include <malloc.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "perf_stat.h"
+
+
+/******************************************************************************/
+/*                                                                            */
+/* struct defination                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+
+struct stat_cnt stat_cnt;
+
+/*
+ * type and config of hardware counters, in order of STAT_HW_*.
+ */
+
+static const struct {
+    const char *name;
+    uint32_t    type;
+    uint64_t    config;
+} hw_evt[STAT_HW_NUM] = {
+    {"cycles",   PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instr",    PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"l1_miss",  PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                                     PERF_COUNT_HW_CACHE_OP_READ << 8 |
+                                     PERF_COUNT_HW_CACHE_RESULT_MISS << 16},
+    {"llc_miss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"br_miss",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+static int    hw_fd[STAT_HW_NUM] = {-1, -1, -1, -1, -1};
+static double time_begin;
+
+#define CMP_SLOTS   8           /* compare functions wrapped at a time     */
+
+/*
+ * compare functions wrapped by 'stat_cmp()', the i-th is called by the i-th
+ * counting comparator. they are shared by threads, since parallel sort calls
+ * a comparator from worker threads. a slot is taken while its reference
+ * count is not 0, slots are looked up and assigned under cmp_lock.
+ */
+
+static int(*real_cmp[CMP_SLOTS])(const void *, const void *);
+static int cmp_ref[CMP_SLOTS];
+static pthread_mutex_t cmp_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/******************************************************************************/
+/*                                                                            */
+/* function defination                                                        */
+/*                                                                            */
+/******************************************************************************/
+
+
+/******************************************************************************/
+/* hardware counter                                                           */
+/******************************************************************************/
+
+/*
+ * open a counter, which is disabled until 'stat_begin()' enables it.
+ *
+ * @return file descriptor on success, otherwise -1.
+ */
+
+static int hw_open(int i) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = hw_evt[i].type;
+    attr.config         = hw_evt[i].config;
+    attr.disabled       = 1;
+    attr.inherit        = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                          PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/*
+ * read a counter, scaled if kernel multiplexed it.
+ *
+ * @return value of counter on success, otherwise -1.
+ */
+
+static int64_t hw_read(int fd) {
+    uint64_t v[3];
+    if (fd < 0 || read(fd, v, sizeof(v)) != sizeof(v) || v[2] == 0)
+        return -1;
+    return v[2] < v[1] ? (int64_t)((double)v[0] * v[1] / v[2]) : (int64_t)v[0];
+}
+
+/******************************************************************************/
+/* allocation hook                                                            */
+/******************************************************************************/
+
+/*
+ * add d bytes to allocated bytes and update peak.
+ */
+
+static void add_bytes(int64_t d) {
+    int64_t cur  = __atomic_add_fetch(&stat_cnt.cur_bytes, d, __ATOMIC_RELAXED);
+    int64_t peak = __atomic_load_n(&stat_cnt.peak_bytes, __ATOMIC_RELAXED);
+    while (cur > peak &&
+           !__atomic_compare_exchange_n(&stat_cnt.peak_bytes, &peak, cur, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+/*
+ * malloc(3), calloc(3), realloc(3) and free(3) counting allocations and
+ * bytes, bytes of a block is taken by malloc_usable_size(3) so that a block
+ * needs no header.
+ */
+
+void *stat_malloc(size_t s) {
+    void *p = malloc(s);
+    if (p != NULL) {
+        __atomic_add_fetch(&stat_cnt.alloc, 1, __ATOMIC_RELAXED);
+        add_bytes((int64_t)malloc_usable_size(p));
+    }
+    return p;
+}
+
+void *stat_calloc(size_t k, size_t s) {
+    void *p = calloc(k, s);
+    if (p != NULL) {
+        __atomic_add_fetch(&stat_cnt.alloc, 1, __ATOMIC_RELAXED);
+        add_bytes((int64_t)malloc_usable_size(p));
+    }
+    return p;
+}
+
+void *stat_realloc(void *p, size_t s) {
+    int64_t old = p == NULL ? 0 : (int64_t)malloc_usable_size(p);
+    void   *q   = realloc(p, s);
+    if (q != NULL) {
+        __atomic_add_fetch(&stat_cnt.alloc, 1, __ATOMIC_RELAXED);
+        add_bytes((int64_t)malloc_usable_size(q) - old);
+    }
+    return q;
+}
+
+void stat_free(void *p) {
+    if (p == NULL)
+        return;
+    add_bytes(-(int64_t)malloc_usable_size(p));
+    free(p);
+}
+
+/******************************************************************************/
+/* instrumented run                                                           */
+/******************************************************************************/
+
+/*
+ * define the i-th counting comparator 'cnt_cmp_i()'.
+ */
+
+#define DEF_CNT_CMP(i)                                                         \
+static int cnt_cmp_##i(const void *ptr1, const void *ptr2) {                   \
+    __atomic_add_fetch(&stat_cnt.cmp, 1, __ATOMIC_RELAXED);                    \
+    return real_cmp[i](ptr1, ptr2);                                            \
+}
+
+DEF_CNT_CMP(0)
+DEF_CNT_CMP(1)
+DEF_CNT_CMP(2)
+DEF_CNT_CMP(3)
+DEF_CNT_CMP(4)
+DEF_CNT_CMP(5)
+DEF_CNT_CMP(6)
+DEF_CNT_CMP(7)
+
+static int(*const cnt_cmp[CMP_SLOTS])(const void *, const void *) = {
+    cnt_cmp_0, cnt_cmp_1, cnt_cmp_2, cnt_cmp_3,
+    cnt_cmp_4, cnt_cmp_5, cnt_cmp_6, cnt_cmp_7
+};
+
+/*
+ * wrap a compare function with a comparator counting comparisons, which is
+ * released by 'stat_cmp_release()' after the run.
+ *
+ * every compare function gets its own comparator, so comparators of up to
+ * CMP_SLOTS different functions are live at once, e.g. in nested runs or
+ * runs of many threads. wrapping the same function again shares its slot,
+ * wrapping more functions fails until a slot is released.
+ *
+ * @param cmp is a pointer to a function comparing elements.
+ *
+ * @return a pointer to the comparator, which is passed to sort instead of
+ *         cmp, NULL if all slots are in use.
+ */
+
+int(*stat_cmp(int(*cmp)(const void *, const void *)))
+             (const void *, const void *) {
+    int i, j = -1;
+    pthread_mutex_lock(&cmp_lock);
+    for (i = 0; i < CMP_SLOTS; i++) {
+        if (cmp_ref[i] > 0 && real_cmp[i] == cmp)
+            break;
+        if (cmp_ref[i] == 0 && j < 0)
+            j = i;
+    }
+    if (i == CMP_SLOTS && (i = j) >= 0)
+        real_cmp[i] = cmp;
+    if (i >= 0)
+        cmp_ref[i]++;
+    pthread_mutex_unlock(&cmp_lock);
+    return i >= 0 ? cnt_cmp[i] : NULL;
+}
+
+/*
+ * release a comparator got by 'stat_cmp()', its slot is free to wrap another
+ * function once every wrapping of it is released.
+ *
+ * @param cmp is a pointer to the comparator.
+ */
+
+void stat_cmp_release(int(*cmp)(const void *, const void *)) {
+    pthread_mutex_lock(&cmp_lock);
+    for (int i = 0; i < CMP_SLOTS; i++) {
+        if (cnt_cmp[i] == cmp && cmp_ref[i] > 0) {
+            cmp_ref[i]--;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&cmp_lock);
+}
+
+/*
+ * reset counters and start hardware counters and clock.
+ */
+
+void stat_begin(void) {
+    struct timespec ts;
+    memset(&stat_cnt, 0, sizeof(stat_cnt));
+    for (int i = 0; i < STAT_HW_NUM; i++) {
+        if (hw_fd[i] >= 0)
+            close(hw_fd[i]);
+        if ((hw_fd[i] = hw_open(i)) >= 0) {
+            ioctl(hw_fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(hw_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    time_begin = ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * stop clock and hardware counters and collect counters.
+ *
+ * @param st is a pointer to result of run.
+ */
+
+void stat_end(SortStat *st) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    st->time = ts.tv_sec + ts.tv_nsec * 1e-9 - time_begin;
+    for (int i = 0; i < STAT_HW_NUM; i++) {
+        if (hw_fd[i] >= 0)
+            ioctl(hw_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        st->hw[i] = hw_read(hw_fd[i]);
+        if (hw_fd[i] >= 0)
+            close(hw_fd[i]);
+        hw_fd[i] = -1;
+    }
+    st->nb_cmp     = stat_cnt.cmp;
+    st->nb_swap    = stat_cnt.swap;
+    st->nb_move    = stat_cnt.move;
+    st->nb_alloc   = stat_cnt.alloc;
+    st->peak_bytes = stat_cnt.peak_bytes;
+#ifdef  SORT_STAT
+    st->hooked     = 1;
+#else
+    st->hooked     = 0;
+#endif  /* SORT_STAT */
+}
+
+/*
+ * @return name of a hardware counter.
+ */
+
+const char *stat_hw_name(int i) {
+    return i >= 0 && i < STAT_HW_NUM ? hw_evt[i].name : "?";
+}
+
+/*
+ * print result of a run to stdout, counters not available are printed as
+ * "n/a".
+ */
+
+void stat_print(const SortStat *st) {
+    printf("time        : %.6f S\n", st->time);
+    printf("comparisons : %" PRIu64 "\n", st->nb_cmp);
+    if (st->hooked) {
+        printf("swaps       : %" PRIu64 "\n", st->nb_swap);
+        printf("moves       : %" PRIu64 "\n", st->nb_move);
+        printf("allocations : %" PRIu64 "\n", st->nb_alloc);
+        printf("peak bytes  : %" PRId64 "\n", st->peak_bytes);
+    } else {
+        printf("swaps, moves and allocations: n/a, built without SORT_STAT\n");
+    }
+    for (int i = 0; i < STAT_HW_NUM; i++) {
+        if (st->hw[i] < 0)
+            printf("%-12s: n/a\n", stat_hw_name(i));
+        else
+            printf("%-12s: %" PRId64 "\n", stat_hw_name(i), st->hw[i]);
+    }
+}
@@ -0,0 +1,159 @@
+/**
+ * @file perf_stat.h
+ * head file contains of declaration of instrumentation of sort run, which
+ * counts comparisons, swaps, moves, allocations and peak scratch bytes, and
+ * reads hardware counters by perf_event_open(2) if kernel allows it.
+ *
+ * hooks in sort code ('STAT_SWAP()', 'STAT_MOVE()' and allocation hooks)
+ * are compiled only if SORT_STAT is defined (make STAT=1), otherwise they
+ * expand to nothing and instrumentation costs nothing.
+ *
+ * @author  duruyao
+ * @version 1.0  19-12-19
+ * @update  [id] [yy-mm-dd] [author] [description]
+ */
+
+#ifndef __PERFSTATH__
+#define __PERFSTATH__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif /* __plusplus */
+
+
+/******************************************************************************/
+/*                                                                            */
+/* macro defination                                                           */
+/*                                                                            */
+/******************************************************************************/
+
+
+#define STAT_HW_CYCLES  0
+#define STAT_HW_INSTR   1
+#define STAT_HW_L1_MISS 2       /* L1 data cache read misses               */
+#define STAT_HW_LLC_MISS 3      /* last level cache misses                 */
+#define STAT_HW_BR_MISS 4
+#define STAT_HW_NUM     5
+
+/*
+ * hooks called by sort code, counters are updated atomically because
+ * parallel sort calls them from many threads.
+ */
+
+#ifdef  SORT_STAT
+#define STAT_ADD(field, k)                              \
+    ((void)__atomic_add_fetch(&stat_cnt.field, (k), __ATOMIC_RELAXED))
+#else
+#define STAT_ADD(field, k) ((void)0)
+#endif  /* SORT_STAT */
+
+#undef  STAT_SWAP
+#define STAT_SWAP()     STAT_ADD(swap, 1)
+#undef  STAT_MOVE
+#define STAT_MOVE(k)    STAT_ADD(move, k)
+
+/*
+ * run call between 'stat_begin()' and 'stat_end()'.
+ *
+ * e.g. cmp = stat_cmp(&cmp_dbl);
+ *      STAT_RUN(&st, merge_sort_p(arr, n, cmp));
+ *      stat_cmp_release(cmp);
+ */
+
+#define STAT_RUN(st, call) ({                           \
+    stat_begin();                                       \
+    call;                                               \
+    stat_end(st);                                       \
+})
+
+
+/******************************************************************************/
+/*                                                                            */
+/* struct declaration                                                         */
+/*                                                                            */
+/******************************************************************************/
+
+
+/*
+ * live counters, updated by hooks.
+ */
+
+struct stat_cnt {
+    uint64_t cmp;
+    uint64_t swap;
+    uint64_t move;
+    uint64_t alloc;
+    int64_t  cur_bytes;
+    int64_t  peak_bytes;
+};
+
+/*
+ * result of an instrumented run, a hardware counter is -1 if it is not
+ * available, swap, move and allocation counters are valid only if hooked.
+ */
+
+struct sort_stat {
+    uint64_t nb_cmp;
+    uint64_t nb_swap;
+    uint64_t nb_move;
+    uint64_t nb_alloc;
+    int64_t  peak_bytes;        /* peak of bytes allocated by the run      */
+    int64_t  hw[STAT_HW_NUM];
+    double   time;              /* seconds of wall time                    */
+    int      hooked;            /* 1 if sort code is built with SORT_STAT  */
+};
+
+typedef struct sort_stat SortStat;
+
+extern struct stat_cnt stat_cnt;
+
+
+/******************************************************************************/
+/*                                                                            */
+/* function declaration                                                       */
+/*                                                                            */
+/******************************************************************************/
+
+
+extern void stat_begin      (void);
+
+extern void stat_end        (SortStat *);
+
+extern int(*stat_cmp(int(*)(const void *, const void *)))
+                            (const void *, const void *);
+
+extern void stat_cmp_release(int(*)(const void *, const void *));
+
+extern const char *stat_hw_name(int);
+
+extern void stat_print      (const SortStat *);
+
+extern void *stat_malloc    (size_t);
+
+extern void *stat_calloc    (size_t, size_t);
+
+extern void *stat_realloc   (void *, size_t);
+
+extern void  stat_free      (void *);
+
+#ifdef __cplusplus
+}
+#endif /* __plusplus */
+
+#endif /* !__PERFSTATH__ */
+
+/*
+ * allocation hooks, a source file of sort code defines STAT_HOOK_ALLOC before
+ * including this file, and after including system head files.
+ */
+
+#if defined(SORT_STAT) && defined(STAT_HOOK_ALLOC) && !defined(__STATHOOKED__)
+#define __STATHOOKED__
+#define malloc(s)       stat_malloc(s)
+#define calloc(k, s)    stat_calloc(k, s)
+#define realloc(p, s)   stat_realloc(p, s)
+#define free(p)         stat_free(p)
+#endif
@@ -0,0 +1,620 @@
+/**
+ * @file simd_sort.c
+ * source file contains of difination of SIMD quick sort for 'double',
+ * 'float', 'int32_t' and 'int64_t' arrays.
+ *
+ * partitioning is vectorized with compress-store on AVX-512 and with a
+ * permutation table on AVX2, the instruction set is selected at runtime,
+ * so that one binary runs on every x86-64 host. partitions of no more than
+ * 16 elements are sorted by a branchless sorting network.
+ *
+ * @author  duruyao
+ * @version 1.0  19-12-19
+ * @update  [id] [yy-mm-dd] [author] [description]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <float.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include "sort_algo.h"
+
+
+/******************************************************************************/
+/*                                                                            */
+/* macro and variable defination                                              */
+/*                                                                            */
+/******************************************************************************/
+
+
+#define NET_SIZE    16          /* partitions sorted by sorting network    */
+
+#define ISA_SCALAR  0
+#define ISA_AVX2    1
+#define ISA_AVX512  2
+
+#define AVX2        __attribute__((target("avx2,popcnt")))
+#define AVX512      __attribute__((target("avx512f,popcnt")))
+
+/* instruction set detected and instruction set in use */
+
+static int isa_host = -1;
+static int isa_used = -1;
+
+/* AVX2 permutation tables, lanes whose mask bit is set are moved to front */
+
+static int32_t perm_4x64[16][8]  __attribute__((aligned(32)));
+static int32_t perm_8x32[256][8] __attribute__((aligned(32)));
+
+
+/******************************************************************************/
+/*                                                                            */
+/* function defination                                                        */
+/*                                                                            */
+/******************************************************************************/
+
+
+/******************************************************************************/
+/* scalar                                                                     */
+/******************************************************************************/
+
+/*
+ * Batcher's odd-even merge network of 16 inputs, 63 comparators.
+ */
+
+#define NET_16(CE)                                                             \
+    CE(0, 1) CE(2, 3) CE(4, 5) CE(6, 7) CE(8, 9) CE(10, 11) CE(12, 13)         \
+    CE(14, 15) CE(0, 2) CE(1, 3) CE(4, 6) CE(5, 7) CE(8, 10) CE(9, 11)         \
+    CE(12, 14) CE(13, 15) CE(1, 2) CE(5, 6) CE(9, 10) CE(13, 14) CE(0, 4)      \
+    CE(1, 5) CE(2, 6) CE(3, 7) CE(8, 12) CE(9, 13) CE(10, 14) CE(11, 15)       \
+    CE(2, 4) CE(3, 5) CE(10, 12) CE(11, 13) CE(1, 2) CE(3, 4) CE(5, 6)         \
+    CE(9, 10) CE(11, 12) CE(13, 14) CE(0, 8) CE(1, 9) CE(2, 10) CE(3, 11)      \
+    CE(4, 12) CE(5, 13) CE(6, 14) CE(7, 15) CE(4, 8) CE(5, 9) CE(6, 10)        \
+    CE(7, 11) CE(2, 4) CE(3, 5) CE(6, 8) CE(7, 9) CE(10, 12) CE(11, 13)        \
+    CE(1, 2) CE(3, 4) CE(5, 6) CE(7, 8) CE(9, 10) CE(11, 12) CE(13, 14)
+
+/*
+ * Batcher's odd-even merge networks of 4 and 8 inputs, 5 and 19 comparators.
+ */
+
+#define NET_4(CE)                                                              \
+    CE(0, 1) CE(2, 3) CE(0, 2) CE(1, 3) CE(1, 2)
+
+#define NET_8(CE)                                                              \
+    CE(0, 1) CE(2, 3) CE(4, 5) CE(6, 7) CE(0, 2) CE(1, 3) CE(4, 6) CE(5, 7)    \
+    CE(1, 2) CE(5, 6) CE(0, 4) CE(1, 5) CE(2, 6) CE(3, 7) CE(2, 4) CE(3, 5)    \
+    CE(1, 2) CE(3, 4) CE(5, 6)
+
+#define CE(a, b) {                                                             \
+    typeof(v[0]) x = v[a], y = v[b];                                           \
+    v[a] = x < y ? x : y;                                                      \
+    v[b] = x < y ? y : x;                                                      \
+}
+
+/*
+ * define scalar functions of type T with suffix 'sfx':
+ *
+ * - 'net_sfx(arr, n)' sorts n <= NET_SIZE elements by Batcher's odd-even
+ *   merge network on a local array padded with MAX.
+ * - 'heap_sfx(arr, n)' is heap sort, the fallback of deep recursion.
+ * - 'pivot_sfx(arr, lo, hi)' is median of 3 or ninther.
+ * - 'ptn_sfx_scalar(arr, lo, hi, pv, le)' moves elements < pv (le == 0) or
+ *   <= pv (le != 0) to front and returns the number of them plus lo.
+ */
+
+#define DEF_SCALAR(sfx, T, MAX)                                                \
+static inline void net_##sfx(T *arr, int n) {                                  \
+    T v[NET_SIZE];                                                             \
+    for (int i = 0; i < NET_SIZE; i++)                                         \
+        v[i] = i < n ? arr[i] : MAX;                                           \
+    NET_16(CE)                                                                 \
+    for (int i = 0; i < n; i++)                                                \
+        arr[i] = v[i];                                                         \
+}                                                                              \
+                                                                               \
+static inline void sift_##sfx(T *arr, int p, int end, T x) {                   \
+    for (int c = 2 * p + 1; c < end; p = c, c = 2 * p + 1) {                   \
+        if (c + 1 < end && arr[c] < arr[c + 1])                                \
+            c++;                                                               \
+        if (!(x < arr[c]))                                                     \
+            break;                                                             \
+        arr[p] = arr[c];                                                       \
+    }                                                                          \
+    arr[p] = x;                                                                \
+}                                                                              \
+                                                                               \
+static void heap_##sfx(T *arr, int n) {                                        \
+    for (int i = n / 2 - 1; i >= 0; i--)                                       \
+        sift_##sfx(arr, i, n, arr[i]);                                         \
+    for (int end = n - 1; end > 0; end--) {                                    \
+        T x = arr[end];                                                        \
+        arr[end] = arr[0];                                                     \
+        sift_##sfx(arr, 0, end, x);                                            \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+static inline T med3_##sfx(T a, T b, T c) {                                    \
+    return a < b ? (b < c ? b : (a < c ? c : a)) :                             \
+                   (a < c ? a : (b < c ? c : b));                              \
+}                                                                              \
+                                                                               \
+static inline T pivot_##sfx(T *arr, int lo, int hi) {                          \
+    int n = hi - lo, mid = lo + n / 2;                                         \
+    if (n < 128)                                                               \
+        return med3_##sfx(arr[lo], arr[mid], arr[hi - 1]);                     \
+    int d = n / 8;                                                             \
+    return med3_##sfx(med3_##sfx(arr[lo], arr[lo + d], arr[lo + 2 * d]),       \
+                      med3_##sfx(arr[mid - d], arr[mid], arr[mid + d]),        \
+                      med3_##sfx(arr[hi - 1 - 2 * d], arr[hi - 1 - d],         \
+                                 arr[hi - 1]));                                \
+}                                                                              \
+                                                                               \
+static int ptn_##sfx##_scalar(T *arr, int lo, int hi, T pv, int le) {          \
+    int i = lo;                                                                \
+    for (int j = lo; j < hi; j++) {                                            \
+        T x = arr[j];                                                          \
+        if (le ? x <= pv : x < pv) {                                           \
+            arr[j] = arr[i];                                                   \
+            arr[i++] = x;                                                      \
+        }                                                                      \
+    }                                                                          \
+    return i;                                                                  \
+}
+
+DEF_SCALAR(f64, double,  INFINITY)
+DEF_SCALAR(f32, float,   INFINITY)
+DEF_SCALAR(i64, int64_t, INT64_MAX)
+DEF_SCALAR(i32, int32_t, INT32_MAX)
+
+/*
+ * move NaNs to the end, the other elements are sorted in front of them.
+ *
+ * @return number of elements which are not NaN.
+ */
+
+#define DEF_NAN_LAST(sfx, T)                                                   \
+static int nan_last_##sfx(T *arr, int n) {                                     \
+    int i = n;                                                                 \
+    for (int j = n - 1; j >= 0; j--) {                                         \
+        T x = arr[j];                                                          \
+        if (x != x) {                                                          \
+            arr[j] = arr[--i];                                                 \
+            arr[i] = x;                                                        \
+        }                                                                      \
+    }                                                                          \
+    return i;                                                                  \
+}
+
+DEF_NAN_LAST(f64, double)
+DEF_NAN_LAST(f32, float)
+
+/******************************************************************************/
+/* vector                                                                     */
+/******************************************************************************/
+
+/*
+ * get the bit mask of lanes of v which go to the left side, that is lanes
+ * < p (le == 0) or <= p (le != 0).
+ */
+
+AVX512 static inline int mask_f64_avx512(__m512d v, __m512d p, int le) {
+    return le ? _mm512_cmp_pd_mask(v, p, _CMP_LE_OQ) :
+                _mm512_cmp_pd_mask(v, p, _CMP_LT_OQ);
+}
+
+AVX512 static inline int mask_f32_avx512(__m512 v, __m512 p, int le) {
+    return le ? _mm512_cmp_ps_mask(v, p, _CMP_LE_OQ) :
+                _mm512_cmp_ps_mask(v, p, _CMP_LT_OQ);
+}
+
+AVX512 static inline int mask_i64_avx512(__m512i v, __m512i p, int le) {
+    return le ? _mm512_cmple_epi64_mask(v, p) : _mm512_cmplt_epi64_mask(v, p);
+}
+
+AVX512 static inline int mask_i32_avx512(__m512i v, __m512i p, int le) {
+    return le ? _mm512_cmple_epi32_mask(v, p) : _mm512_cmplt_epi32_mask(v, p);
+}
+
+AVX2 static inline int mask_f64_avx2(__m256d v, __m256d p, int le) {
+    return le ? _mm256_movemask_pd(_mm256_cmp_pd(v, p, _CMP_LE_OQ)) :
+                _mm256_movemask_pd(_mm256_cmp_pd(v, p, _CMP_LT_OQ));
+}
+
+AVX2 static inline int mask_f32_avx2(__m256 v, __m256 p, int le) {
+    return le ? _mm256_movemask_ps(_mm256_cmp_ps(v, p, _CMP_LE_OQ)) :
+                _mm256_movemask_ps(_mm256_cmp_ps(v, p, _CMP_LT_OQ));
+}
+
+AVX2 static inline int mask_i64_avx2(__m256i v, __m256i p, int le) {
+    if (le)
+        return ~_mm256_movemask_pd(
+                    _mm256_castsi256_pd(_mm256_cmpgt_epi64(v, p))) & 0xF;
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(p, v)));
+}
+
+AVX2 static inline int mask_i32_avx2(__m256i v, __m256i p, int le) {
+    if (le)
+        return ~_mm256_movemask_ps(
+                    _mm256_castsi256_ps(_mm256_cmpgt_epi32(v, p))) & 0xFF;
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(p, v)));
+}
+
+/*
+ * move lanes of v whose bit of m is set to front, c is number of them.
+ */
+
+#define PERM_F64(v, m) _mm256_castsi256_pd(_mm256_permutevar8x32_epi32(        \
+        _mm256_castpd_si256(v), _mm256_load_si256((__m256i *)perm_4x64[m])))
+#define PERM_F32(v, m) _mm256_permutevar8x32_ps(                               \
+        v, _mm256_load_si256((__m256i *)perm_8x32[m]))
+#define PERM_I64(v, m) _mm256_permutevar8x32_epi32(                            \
+        v, _mm256_load_si256((__m256i *)perm_4x64[m]))
+#define PERM_I32(v, m) _mm256_permutevar8x32_epi32(                            \
+        v, _mm256_load_si256((__m256i *)perm_8x32[m]))
+
+#define LOAD_I256(p)     _mm256_loadu_si256((__m256i *)(p))
+#define STORE_I256(p, v) _mm256_storeu_si256((__m256i *)(p), v)
+
+/*
+ * define 'st_sfx_isa(arr, lw, rw, v, m, c, last)', which stores c lanes of
+ * v whose bit of m is set at arr[lw] and the other lanes just below
+ * arr[rw].
+ *
+ * AVX-512 stores exactly these lanes by compress-store. AVX2 permutes the
+ * lanes and stores 2 full vectors, which writes W slots at both sides, so
+ * that the last vectors (last != 0) are stored through a buffer.
+ */
+
+#define DEF_ST_AVX512(sfx, T, W, V, COMPRESS)                                  \
+AVX512 static inline void st_##sfx##_avx512(T *arr, int lw, int rw,            \
+                                            V v, int m, int c, int last) {     \
+    (void)last;                                                                \
+    COMPRESS(arr + lw, m, v);                                                  \
+    COMPRESS(arr + rw - (W - c), ~m, v);                                       \
+}
+
+#define DEF_ST_AVX2(sfx, T, W, V, STORE, PERM)                                 \
+AVX2 static inline void st_##sfx##_avx2(T *arr, int lw, int rw,                \
+                                        V v, int m, int c, int last) {         \
+    T buf[W];                                                                  \
+    v = PERM(v, m);                                                            \
+    if (!last) {                                                               \
+        STORE(arr + lw, v);                                                    \
+        STORE(arr + rw - W, v);                                                \
+        return;                                                                \
+    }                                                                          \
+    STORE(buf, v);                                                             \
+    memcpy(arr + lw, buf, sizeof(T) * c);                                      \
+    memcpy(arr + rw - (W - c), buf + c, sizeof(T) * (W - c));                  \
+}
+
+DEF_ST_AVX512(f64, double,  8,  __m512d, _mm512_mask_compressstoreu_pd)
+DEF_ST_AVX512(f32, float,   16, __m512,  _mm512_mask_compressstoreu_ps)
+DEF_ST_AVX512(i64, int64_t, 8,  __m512i, _mm512_mask_compressstoreu_epi64)
+DEF_ST_AVX512(i32, int32_t, 16, __m512i, _mm512_mask_compressstoreu_epi32)
+
+DEF_ST_AVX2(f64, double,  4, __m256d, _mm256_storeu_pd, PERM_F64)
+DEF_ST_AVX2(f32, float,   8, __m256,  _mm256_storeu_ps, PERM_F32)
+DEF_ST_AVX2(i64, int64_t, 4, __m256i, STORE_I256,       PERM_I64)
+DEF_ST_AVX2(i32, int32_t, 8, __m256i, STORE_I256,       PERM_I32)
+
+/*
+ * define in-place vector partition 'ptn_sfx_isa(arr, lo, hi, pv, le)',
+ * which moves elements < pv (le == 0) or <= pv (le != 0) of arr[lo..hi)
+ * to front and returns the number of them plus lo.
+ *
+ * W elements at both ends are loaded first, so there are always 2 * W
+ * free slots between write and read positions. the next vector is read
+ * from the side with less free slots, then either side has at least W free
+ * slots when it is written, and no element is overwritten before read.
+ */
+
+#define DEF_PTN(sfx, isa, ATTR, T, W, V, LOAD, SET1)                           \
+ATTR static int ptn_##sfx##_##isa(T *arr, int lo, int hi, T pv, int le) {      \
+    if (hi - lo < 2 * W)                                                       \
+        return ptn_##sfx##_scalar(arr, lo, hi, pv, le);                        \
+    V vp = SET1(pv), v;                                                        \
+    V vl = LOAD(arr + lo), vr = LOAD(arr + hi - W);                            \
+    int lr = lo + W, rr = hi - W, lw = lo, rw = hi, m, c;                      \
+    T rest[W];                                                                 \
+    while (rr - lr >= W) {                                                     \
+        if (lr - lw <= rw - rr) {                                              \
+            v = LOAD(arr + lr);                                                \
+            lr += W;                                                           \
+        } else {                                                               \
+            rr -= W;                                                           \
+            v = LOAD(arr + rr);                                                \
+        }                                                                      \
+        m = mask_##sfx##_##isa(v, vp, le);                                     \
+        c = __builtin_popcount(m);                                             \
+        st_##sfx##_##isa(arr, lw, rw, v, m, c, 0);                             \
+        lw += c;                                                               \
+        rw -= W - c;                                                           \
+    }                                                                          \
+    /* less than W elements left in the middle */                              \
+    memcpy(rest, arr + lr, sizeof(T) * (rr - lr));                             \
+    for (int i = 0; i < rr - lr; i++) {                                        \
+        if (le ? rest[i] <= pv : rest[i] < pv)                                 \
+            arr[lw++] = rest[i];                                               \
+        else                                                                   \
+            arr[--rw] = rest[i];                                               \
+    }                                                                          \
+    m = mask_##sfx##_##isa(vl, vp, le);                                        \
+    c = __builtin_popcount(m);                                                 \
+    st_##sfx##_##isa(arr, lw, rw, vl, m, c, 1);                                \
+    lw += c;                                                                   \
+    rw -= W - c;                                                               \
+    m = mask_##sfx##_##isa(vr, vp, le);                                        \
+    c = __builtin_popcount(m);                                                 \
+    st_##sfx##_##isa(arr, lw, rw, vr, m, c, 1);                                \
+    return lw + c;                                                             \
+}
+
+DEF_PTN(f64, avx512, AVX512, double,  8,  __m512d, _mm512_loadu_pd,
+        _mm512_set1_pd)
+DEF_PTN(f32, avx512, AVX512, float,   16, __m512,  _mm512_loadu_ps,
+        _mm512_set1_ps)
+DEF_PTN(i64, avx512, AVX512, int64_t, 8,  __m512i, _mm512_loadu_si512,
+        _mm512_set1_epi64)
+DEF_PTN(i32, avx512, AVX512, int32_t, 16, __m512i, _mm512_loadu_si512,
+        _mm512_set1_epi32)
+
+DEF_PTN(f64, avx2,   AVX2,   double,  4,  __m256d, _mm256_loadu_pd,
+        _mm256_set1_pd)
+DEF_PTN(f32, avx2,   AVX2,   float,   8,  __m256,  _mm256_loadu_ps,
+        _mm256_set1_ps)
+DEF_PTN(i64, avx2,   AVX2,   int64_t, 4,  __m256i, LOAD_I256,
+        _mm256_set1_epi64x)
+DEF_PTN(i32, avx2,   AVX2,   int32_t, 8,  __m256i, LOAD_I256,
+        _mm256_set1_epi32)
+
+/******************************************************************************/
+/* dispatch                                                                   */
+/******************************************************************************/
+
+/*
+ * build permutation tables and detect instruction set before 'main()'.
+ */
+
+static void __attribute__((constructor)) simd_init(void) {
+    for (int m = 0; m < 256; m++) {
+        int k = 0;
+        for (int i = 0; i < 8; i++)
+            if (m >> i & 1)
+                perm_8x32[m][k++] = i;
+        for (int i = 0; i < 8; i++)
+            if (!(m >> i & 1))
+                perm_8x32[m][k++] = i;
+    }
+    for (int m = 0; m < 16; m++) {
+        int k = 0;
+        for (int i = 0; i < 4; i++)
+            if (m >> i & 1) {
+                perm_4x64[m][k++] = 2 * i;
+                perm_4x64[m][k++] = 2 * i + 1;
+            }
+        for (int i = 0; i < 4; i++)
+            if (!(m >> i & 1)) {
+                perm_4x64[m][k++] = 2 * i;
+                perm_4x64[m][k++] = 2 * i + 1;
+            }
+    }
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        isa_host = ISA_AVX512;
+    else if (__builtin_cpu_supports("avx2"))
+        isa_host = ISA_AVX2;
+    else
+        isa_host = ISA_SCALAR;
+    isa_used = isa_host;
+}
+
+/*
+ * get or limit the instruction set used by SIMD sort.
+ *
+ * @param level is the highest instruction set allowed, 0 for scalar, 1 for
+ *              AVX2 and 2 for AVX-512, it is ignored if it is less than 0.
+ *
+ * @return the instruction set in use, which is never higher than the one
+ *         supported by host.
+ */
+
+int simd_level(int level) {
+    if (level >= 0)
+        isa_used = level < isa_host ? level : isa_host;
+    return isa_used;
+}
+
+/******************************************************************************/
+/* SIMD sort                                                                  */
+/******************************************************************************/
+
+/*
+ * define 'sort_sfx(arr, n)' of type T.
+ *
+ * if no element is less than the pivot, all elements equal to the pivot are
+ * moved to front and left there, which keeps arrays with many duplicates
+ * O(n log n). heap sort is used after 2 * log2(n) levels of partition.
+ */
+
+#define DEF_SIMD_SORT(sfx, T, NAN_LAST)                                        \
+static void qs_##sfx(T *arr, int lo, int hi, int depth,                        \
+                     int(*ptn)(T *, int, int, T, int)) {                       \
+    while (hi - lo > NET_SIZE) {                                               \
+        if (depth-- == 0) {                                                    \
+            heap_##sfx(arr + lo, hi - lo);                                     \
+            return;                                                            \
+        }                                                                      \
+        T   pv = pivot_##sfx(arr, lo, hi);                                     \
+        int m  = ptn(arr, lo, hi, pv, 0);                                      \
+        if (m == lo) {                                                         \
+            lo = ptn(arr, lo, hi, pv, 1);                                      \
+            continue;                                                          \
+        }                                                                      \
+        if (m - lo < hi - m) {                                                 \
+            qs_##sfx(arr, lo, m, depth, ptn);                                  \
+            lo = m;                                                            \
+        } else {                                                               \
+            qs_##sfx(arr, m, hi, depth, ptn);                                  \
+            hi = m;                                                            \
+        }                                                                      \
+    }                                                                          \
+    net_##sfx(arr + lo, hi - lo);                                              \
+}                                                                              \
+                                                                               \
+void sort_##sfx(T *arr, int n) {                                               \
+    int(*ptn)(T *, int, int, T, int) =                                         \
+        isa_used == ISA_AVX512 ? ptn_##sfx##_avx512 :                          \
+        isa_used == ISA_AVX2   ? ptn_##sfx##_avx2   : ptn_##sfx##_scalar;      \
+    int depth = 0;                                                             \
+    if (n < 2)                                                                 \
+        return;                                                                \
+    n = NAN_LAST(arr, n);                                                      \
+    for (int i = n; i > 1; i >>= 1)                                            \
+        depth += 2;                                                            \
+    qs_##sfx(arr, 0, n, depth, ptn);                                           \
+}
+
+#define NO_NAN(arr, n) (n)
+
+DEF_SIMD_SORT(f64, double,  nan_last_f64)
+DEF_SIMD_SORT(f32, float,   nan_last_f32)
+DEF_SIMD_SORT(i64, int64_t, NO_NAN)
+DEF_SIMD_SORT(i32, int32_t, NO_NAN)
+
+/******************************************************************************/
+/* segmented sort                                                             */
+/******************************************************************************/
+
+#define SEG_CLASS   3           /* size classes of 4, 8 and 16 elements    */
+#define SEG_BATCH   64          /* segments of a class sorted by one call  */
+
+/* comparators of networks of 4, 8 and 16 inputs, by size class */
+
+#define PAIR(a, b) {a, b},
+
+static const unsigned char net_4[][2]  = { NET_4(PAIR) };
+static const unsigned char net_8[][2]  = { NET_8(PAIR) };
+static const unsigned char net_16[][2] = { NET_16(PAIR) };
+
+static const unsigned char (*const net_pair[SEG_CLASS])[2] = {
+    net_4, net_8, net_16
+};
+
+static const int net_nb[SEG_CLASS] = {
+    sizeof(net_4) / 2, sizeof(net_8) / 2, sizeof(net_16) / 2
+};
+
+/* minimum and maximum of 64 bits integer lanes on AVX2 */
+
+#define MIN_I64_AVX2(a, b) _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b))
+#define MAX_I64_AVX2(a, b) _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(b, a))
+
+/*
+ * define 'segnet_sfx_isa(arr, pos, len, nb, c)', which sorts nb segments
+ * arr[pos[i] .. pos[i] + len[i]) of size class c, W segments at once.
+ *
+ * W segments are transposed into a buffer padded with PAD, so that lane l
+ * of row i is the i-th element of the l-th segment, then one vector
+ * comparator of the network sorts W segments. MIN(x, y) and MAX(y, x)
+ * return different operands if lanes are equal, such as -0.0 and +0.0, so
+ * that a segment is always a permutation of its input.
+ */
+
+#define DEF_SEG_NET(sfx, isa, ATTR, T, W, V, LOAD, STORE, MIN, MAX, PAD)       \
+ATTR static void segnet_##sfx##_##isa(T *arr, const int *pos, const int *len,\
+                                      int nb, int c) {                         \
+    T   buf[NET_SIZE][W] __attribute__((aligned(64)));                         \
+    V   v[NET_SIZE];                                                           \
+    int size = 4 << c, nb_ce = net_nb[c];                                      \
+    const unsigned char (*pair)[2] = net_pair[c];                              \
+    for (int g = 0; g < nb; g += W) {                                          \
+        int w = nb - g < W ? nb - g : W;                                       \
+        for (int l = 0; l < W; l++)                                            \
+            for (int i = 0, n = l < w ? len[g + l] : 0; i < size; i++)         \
+                buf[i][l] = i < n ? arr[pos[g + l] + i] : PAD;                 \
+        for (int i = 0; i < size; i++)                                         \
+            v[i] = LOAD(buf[i]);                                               \
+        for (int j = 0; j < nb_ce; j++) {                                      \
+            V x = v[pair[j][0]], y = v[pair[j][1]];                            \
+            v[pair[j][0]] = MIN(x, y);                                         \
+            v[pair[j][1]] = MAX(y, x);                                         \
+        }                                                                      \
+        for (int i = 0; i < size; i++)                                         \
+            STORE(buf[i], v[i]);                                               \
+        for (int l = 0; l < w; l++)                                            \
+            for (int i = 0; i < len[g + l]; i++)                               \
+                arr[pos[g + l] + i] = buf[i][l];                               \
+    }                                                                          \
+}
+
+DEF_SEG_NET(f64, avx512, AVX512, double,  8,  __m512d, _mm512_load_pd,
+            _mm512_store_pd, _mm512_min_pd, _mm512_max_pd, INFINITY)
+DEF_SEG_NET(f32, avx512, AVX512, float,   16, __m512,  _mm512_load_ps,
+            _mm512_store_ps, _mm512_min_ps, _mm512_max_ps, INFINITY)
+DEF_SEG_NET(i64, avx512, AVX512, int64_t, 8,  __m512i, _mm512_load_si512,
+            _mm512_store_si512, _mm512_min_epi64, _mm512_max_epi64,
+            INT64_MAX)
+DEF_SEG_NET(i32, avx512, AVX512, int32_t, 16, __m512i, _mm512_load_si512,
+            _mm512_store_si512, _mm512_min_epi32, _mm512_max_epi32,
+            INT32_MAX)
+
+DEF_SEG_NET(f64, avx2,   AVX2,   double,  4,  __m256d, _mm256_load_pd,
+            _mm256_store_pd, _mm256_min_pd, _mm256_max_pd, INFINITY)
+DEF_SEG_NET(f32, avx2,   AVX2,   float,   8,  __m256,  _mm256_load_ps,
+            _mm256_store_ps, _mm256_min_ps, _mm256_max_ps, INFINITY)
+DEF_SEG_NET(i64, avx2,   AVX2,   int64_t, 4,  __m256i, LOAD_I256,
+            STORE_I256, MIN_I64_AVX2, MAX_I64_AVX2, INT64_MAX)
+DEF_SEG_NET(i32, avx2,   AVX2,   int32_t, 8,  __m256i, LOAD_I256,
+            STORE_I256, _mm256_min_epi32, _mm256_max_epi32, INT32_MAX)
+
+/*
+ * define 'seg_sort_sfx(arr, off, nb_seg)' of type T.
+ *
+ * segments of more than NET_SIZE elements are sorted by 'sort_sfx()'. the
+ * others are bucketed into size classes of 4, 8 and 16 elements, and a full
+ * batch of a class is sorted by vector networks across segments. NaNs are
+ * moved to the end of their segment. on hosts without SIMD a segment is
+ * sorted by the scalar network at once.
+ */
+
+#define DEF_SEG_SORT(sfx, T, NAN_LAST)                                         \
+void seg_sort_##sfx(T *arr, const int *off, int nb_seg) {                      \
+    void(*net)(T *, const int *, const int *, int, int) =                      \
+        isa_used == ISA_AVX512 ? segnet_##sfx##_avx512 :                       \
+        isa_used == ISA_AVX2   ? segnet_##sfx##_avx2   : NULL;                 \
+    int pos[SEG_CLASS][SEG_BATCH], len[SEG_CLASS][SEG_BATCH];                  \
+    int cnt[SEG_CLASS] = {0};                                                  \
+    for (int i = 0, n, c; i < nb_seg; i++) {                                   \
+        n = off[i + 1] - off[i];                                               \
+        if (n > NET_SIZE) {                                                    \
+            sort_##sfx(arr + off[i], n);                                       \
+            continue;                                                          \
+        }                                                                      \
+        if (n < 2 || (n = NAN_LAST(arr + off[i], n)) < 2)                      \
+            continue;                                                          \
+        if (net == NULL) {                                                     \
+            net_##sfx(arr + off[i], n);                                        \
+            continue;                                                          \
+        }                                                                      \
+        c = n <= 4 ? 0 : (n <= 8 ? 1 : 2);                                     \
+        pos[c][cnt[c]] = off[i];                                               \
+        len[c][cnt[c]] = n;                                                    \
+        if (++cnt[c] == SEG_BATCH) {                                           \
+            net(arr, pos[c], len[c], SEG_BATCH, c);                            \
+            cnt[c] = 0;                                                        \
+        }                                                                      \
+    }                                                                          \
+    for (int c = 0; c < SEG_CLASS; c++)                                        \
+        if (cnt[c] > 0)                                                        \
+            net(arr, pos[c], len[c], cnt[c], c);                               \
+}
+
+DEF_SEG_SORT(f64, double,  nan_last_f64)
+DEF_SEG_SORT(f32, float,   nan_last_f32)
+DEF_SEG_SORT(i64, int64_t, NO_NAN)
+DEF_SEG_SORT(i32, int32_t, NO_NAN)
@@ -16,6 +16,8 @@
 #include <string.h>
 #include <inttypes.h>
 
+#define STAT_HOOK_ALLOC
+#include "perf_stat.h"
 #include "sort_algo.h"
 
 
@@ -27,59 +29,96 @@
 
 
 /******************************************************************************/
-/* Bucket type                                                                */
+/* TopK type                                                                  */
 /******************************************************************************/
 
 /*
+ * accumulator of the k best elements, which is a big top heap of at most k
+ * elements, its top is the worst element kept.
+ */
 
-array of Bucket type
-
-0  ____________
-  | Bucket     |                              size
-  |      ______|   ____________________________/\________________________...
-  |     |      |  /
-  |     | size |   ________________    ________________    ________________
-  |     |______|  | Entry          |  | Entry          |  | Entry          |
-  |     |      |  |    ____________|  |    ____________|  |    ____________|
-  |     |*head===>|   |     |      |  |   |     |      |  |   |     |      |
-  |     |      |  |   |*data|*next--->|   |*data|*next--->|   |*data|*next--->
-  |     |      |  |   |     |      |  |   |     |      |  |   |     |      |
-1 |_____|______|  |___|_____|______|  |___|_____|______|  |___|_____|______|
-  | Bucket     |
-  |      ______|
-  |     |      |
-  |     | size |   ________________    ________________    ________________
-  |     |______|  | Entry          |  | Entry          |  | Entry          |
-  |     |      |  |    ____________|  |    ____________|  |    ____________|
-  |     |*head===>|   |     |      |  |   |     |      |  |   |     |      |
-  |     |      |  |   |*data|*next--->|   |*data|*next--->|   |*data|*next--->
-  |     |      |  |   |     |      |  |   |     |      |  |   |     |      |
-2 |_____|______|  |___|_____|______|  |___|_____|______|  |___|_____|______|
-  | Bucket     |
-  |      ______|
-  |     |      |
-  |     | size |   ________________    ________________    ________________
-  |     |______|  | Entry          |  | Entry          |  | Entry          |
-  |     |      |  |    ____________|  |    ____________|  |    ____________|
-  |     |*head===>|   |     |      |  |   |     |      |  |   |     |      |
-  |     |      |  |   |*data|*next--->|   |*data|*next--->|   |*data|*next--->
-  |     |      |  |   |     |      |  |   |     |      |  |   |     |      |
-3 |_____|______|  |___|_____|______|  |___|_____|______|  |___|_____|______|
-  
-  ... ...
+struct top_k {
+    void **heap;
+    int    n;                   /* number of elements in heap              */
+    int    k;
+    int(*cmp)(const void *, const void *);
+};
 
-*/
+/******************************************************************************/
+/* PrioQ type                                                                 */
+/******************************************************************************/
+
+/*
+ * priority queue of a d-ary heap of handles, a handle is an index of 'elem'
+ * and 'pos', so an element is found in heap by its handle for decrease-key.
+ */
 
-struct entry {
-    void  *data;        /* pointer to an opaque type data      */  
-    struct entry *next; /* pointer to the next Entry type data */
+struct prio_q {
+    int     *heap;              /* handles in heap order                   */
+    int     *pos;               /* index in heap of handle, -1 if free     */
+    void   **elem;              /* element of handle                       */
+    int     *free_h;            /* stack of free handles                   */
+    int      n;                 /* number of elements in heap              */
+    int      nb_h;              /* number of handles ever used             */
+    int      nb_free;
+    int      cap;               /* capacity of arrays                      */
+    int(*cmp)(const void *, const void *);
 };
 
-struct bucket {
-    unsigned size;
-    Entry   *head;
+/******************************************************************************/
+/* SortSet type                                                               */
+/******************************************************************************/
+
+/*
+ * sorted multiset of a log-structured merge layout: a sorted delta buffer of
+ * LSM_DELTA elements, and levels, level i is either empty or full of
+ * LSM_DELTA << i sorted elements, as bit i of 'used' tells.
+ */
+
+struct sort_set {
+    void   **delta;
+    int      nb_delta;          /* number of elements in delta buffer      */
+    void   **level[LSM_LEVEL_MAX];
+    unsigned used;              /* bit mask of full levels                 */
+    void   **tmp;               /* scratch array of merging levels         */
+    int      nb_tmp;            /* capacity of tmp                         */
+    int      n;                 /* number of elements                      */
+    int(*cmp)(const void *, const void *);
 };
 
+/******************************************************************************/
+/* Bucket type                                                                */
+/******************************************************************************/
+
+/*
+
+array of Bucket type, every bucket is a contiguous range of input array
+
+   ____________
+0 | Bucket     |
+  |  begin --------.
+  |  size = 2  |   |
+1 |____________|   |
+  | Bucket     |   |
+  |  begin --------|-------------.
+  |  size = 3  |   |             |
+2 |____________|   |             |
+  | Bucket     |   |             |
+  |  begin --------|-------------|--------------------.
+  |  size = 1  |   |             |                    |
+3 |____________|   V             V                    V
+                 ________________________________________________________
+  ... ...       |*data |*data |*data |*data |*data |*data |*data | ...
+                |______|______|______|______|______|______|______|_____
+                 \____ ______/ \_________ _________/ \__ __/
+                      V                   V                V
+                  bucket 0            bucket 1         bucket 2
+
+struct bucket is defined in sort_algo.h, 'ext_bucket_p()' may be called on
+any subarray of buckets.
+
+*/
+
 
 /******************************************************************************/
 /*                                                                            */
@@ -125,6 +164,16 @@ int cmp_dbl_rev(const void *ptr1, const void *ptr2) {
     return *p1 == *p2 ? 0 : (*p1 > *p2 ? -1 : 1);
 }
 
+/*
+ * compare function for C string, as 'strcmp()'.
+ *
+ * @return > 0 (s1 > s2), < 0 (s1 < s2), 0 (s1 = s2)
+ */
+
+int cmp_str(const void *ptr1, const void *ptr2) {
+    return strcmp((const char *)ptr1, (const char *)ptr2);
+}
+
 /******************************************************************************/
 /* insert sort                                                                */
 /******************************************************************************/
@@ -156,29 +205,6 @@ void insert_sort(void *arr, int n, size_t s,
     free(temp);
 }
 
-/*
- * insert sort function based on pointer.
- *
- * best    case: O(n)
- * worst   case: O(n ^ 2)
- * average case: O(n ^ 2)
- *
- * @param arr is an allocated array of pointers to opaque type data.
- * @param n   is number of elements in the array.
- * @param cmp is a pointer to a function comparing elements.
- */
-
-void insert_sort_p(void **arr, int n, 
-                   int(*cmp)(const void *, const void *)) {
-    void *value = NULL;
-    for (int i = 1, j = 0; i < n; i++, j = i - 1) {
-        value = arr[i];
-        for (; j >= 0 && cmp(arr[j], value) > 0; j--) 
-            arr[j + 1] = arr[j];
-        arr[j + 1] = value;
-   }
-}
-
 /******************************************************************************/
 /* select sort                                                                */
 /******************************************************************************/
@@ -211,255 +237,442 @@ void select_sort(void *arr, int n, size_t s,
     free(temp);
 }
 
+/******************************************************************************/
+/* heap sort                                                                  */
+/******************************************************************************/
+
 /*
- * select sort function based on pointer.
+ * 'heapify_p()', 'heap_build_p()', 'heap_insert_p()', 'heap_repl_p()',
+ * 'heap_del_p()', 'heap_sort_p()', 'heap_sort_d_p()' and sifts of d-ary
+ * heaps used by top k accumulators are wrappers over templates of
+ * 'sort_algo.hpp' (see 'sort_tpl.cpp').
+ */
+
+#define HEAP_D      4           /* arity of top k and priority queue heaps */
+
+/*
+ * get top element of heap.
  *
- * best    case: O(n ^ 2)
- * worst   case: O(n ^ 2)
- * average case: O(n ^ 2)
+ * @param arr is an allocated array of pointers to opaque type data, the arr
+ *            store elements of heap, the array has stored elements of an
+ *            ordered heap.
  *
- * @param arr is an allocated array of pointers to opaque type data.
- * @param n   is number of elements in the array.
- * @param cmp is a pointer to a function comparing elements.
+ * @return a pointer to the top element of heap.
+ */
+
+void *heap_top_p(void **arr) {
+    return arr[0];
+}
+
+/*
+ * select the k-th element of set by using heap.
+ * 
+ * if the compare function is 'cmp()', select the k-th smallest element, if
+ * it is 'cmp_rev()', select the k-th largest element.
+ *
+ * time  complexity: O(n * log k)
+ * space complexity: O(k)
+ *
+ * @param set   is an input allocated set.
+ * @param max_n is the number of elements of input set.
+ * @param k     is the size of the heap.
+ * @param cmp   is a pointer to a function comparing elements.
+ *
+ * @return a pointer to the k-th element on success, otherwise NULL.
  */
 
-void select_sort_p(void **arr, int n,
+void *heap_top_k_p(void **set, int max_n, int k,
                    int(*cmp)(const void *, const void *)) {
-    int max_pos;
-    for (int i = n - 1; i >= 1; i--) {
-        max_pos = 0;    
-        for (int j = 1; j <= i; j++) {
-            if (cmp(arr[j], arr[max_pos]) > 0)
-                max_pos = j;
-        }
-        SWAP_PTR(arr[i], arr[max_pos]);
-    }
+    if (k > max_n || k < 1)
+        return NULL;
+    void *k_ptr = NULL;
+    TopK *tk    = top_k_create(k, cmp);
+    if (tk == NULL)
+        return NULL;
+    top_k_push_n(tk, set, max_n);
+    k_ptr = heap_top_p(tk->heap);
+    top_k_destroy(tk);
+    return k_ptr;
 }
 
 /******************************************************************************/
-/* bubble sort                                                                */
+/* top k                                                                      */
 /******************************************************************************/
 
 /*
- * bubble sort function based on pointer.
- *
- * best    case:   O(n)
- * worst   case:   O(n ^ 2)
- * average case:   O(n ^ 2)
+ * create an accumulator of the k best elements, the best element is the
+ * smallest one if compare function is 'cmp()', and the largest one if it is
+ * 'cmp_rev()'.
  *
- * @param arr is an allocated array of pointers to opaque type data.
- * @param n   is number of elements in the array.
+ * @param k   is the number of elements kept.
  * @param cmp is a pointer to a function comparing elements.
+ *
+ * @return a pointer to accumulator on success, otherwise NULL.
  */
 
-void bubble_sort_p(void **arr, int n,
-                   int(*cmp)(const void *, const void *)) {
-    int flag = 1;
-    for (int i = 0; flag && i < n - 1; i++) {
-        flag = 0;
-        for (int j = 0; j < n - i - 1; j++) {
-            if (cmp(arr[j], arr[j + 1]) > 0) {
-                SWAP_PTR(arr[j], arr[j + 1]);
-                flag = 1;
-            }
-        }
+TopK *top_k_create(int k, int(*cmp)(const void *, const void *)) {
+    TopK *tk = NULL;
+    if (k < 1)
+        return NULL;
+    tk = (TopK *)malloc(sizeof(TopK));
+    if (tk != NULL && (tk->heap = (void **)malloc(sizeof(void *) * k)) == NULL)
+        free(tk), tk = NULL;
+    if (tk == NULL) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        return NULL;
     }
+    tk->n   = 0;
+    tk->k   = k;
+    tk->cmp = cmp;
+    return tk;
 }
 
-/******************************************************************************/
-/* heap sort                                                                  */
-/******************************************************************************/
+/*
+ * drop all elements, the accumulator is reused for another set.
+ */
+
+void top_k_clear(TopK *tk) {
+    tk->n = 0;
+}
+
+void top_k_destroy(TopK *tk) {
+    if (tk == NULL)
+        return;
+    free(tk->heap);
+    free(tk);
+}
 
 /*
- * keep attribute (big top or small top) of heap based on pointer.
+ * get the threshold of accumulator, a pushed element is kept only if it is
+ * better than the threshold.
  *
- * if compare function is 'cmp()', keep a big top, otherwise keep a small heap.
+ * @return a pointer to the worst element kept if k elements are kept,
+ *         otherwise NULL.
+ */
+
+void *top_k_thr(const TopK *tk) {
+    return tk->n < tk->k ? NULL : heap_top_p(tk->heap);
+}
+
+/*
+ * push an element into accumulator.
  *
- * @param arr   is an allocated array of pointers to opaque type data.
- * @param begin is the first index.
- * @param end   is the last index.
- * @param cmp   is a pointer to a function comparing elements.
+ * @param tk  is a pointer to accumulator.
+ * @param new is a pointer to opaque element.
  */
 
-void heapify_p(void **arr, int begin, int end,
-               int(*cmp)(const void *, const void *)) {
-    int left  = 2 * begin + 1;
-    int right = 2 * begin + 2;
-    int max_idx = begin;
-    if (left  < end && cmp(arr[left],  arr[max_idx]) > 0)
-        max_idx = left;
-    if (right < end && cmp(arr[right], arr[max_idx]) > 0)
-        max_idx = right;
-    if (begin != max_idx) {
-        SWAP_PTR(arr[begin], arr[max_idx]);
-        heapify_p(arr, max_idx, end, cmp);
-    }
+void top_k_push(TopK *tk, void *new) {
+    if (tk->n < tk->k)
+        heap_sift_up_d_p(tk->heap, tk->n++, HEAP_D, new, tk->cmp);
+    else if (tk->cmp(new, heap_top_p(tk->heap)) < 0)
+        heap_sift_down_d_p(tk->heap, 0, tk->k, HEAP_D, new, tk->cmp);
 }
 
 /*
- * build a heap (big top heap or small top heap) based on pointer by using
- * one-dimension array. 
+ * push n elements into accumulator.
  *
- * @param arr is an allocated array of pointers to opaque type data.
- * @param k   is the max number of elements in heap.
- * @param cmp is a pointer to a function comparing elements.
+ * once k elements are kept, the top of heap is the threshold that a better
+ * element must beat. it is kept in a local variable and updated only when an
+ * element enters the heap, so most elements of a large set are discarded by
+ * one comparison without touching the heap.
+ *
+ * time  complexity: O(n * log k) worst case, O(n + k * log k * log n) on
+ *                   random set
+ *
+ * @param tk  is a pointer to accumulator.
+ * @param set is an allocated array of pointers to opaque type data.
+ * @param n   is number of elements in set.
  */
 
-void heap_build_p(void **arr, int k,
-                  int(*cmp)(const void *, const void *)) {
-    for (int i = k / 2 - 1; i >= 0; i--)
-        heapify_p(arr, i, k, cmp);
+void top_k_push_n(TopK *tk, void **set, int n) {
+    int   i   = 0;
+    void *thr = NULL;
+    for (; i < n && tk->n < tk->k; i++)
+        heap_sift_up_d_p(tk->heap, tk->n++, HEAP_D, set[i], tk->cmp);
+    if (i == n)
+        return;
+    thr = heap_top_p(tk->heap);
+    for (; i < n; i++) {
+        if (tk->cmp(set[i], thr) < 0) {
+            heap_sift_down_d_p(tk->heap, 0, tk->k, HEAP_D, set[i], tk->cmp);
+            thr = heap_top_p(tk->heap);
+        }
+    }
 }
 
 /*
- * get top element of heap.
+ * merge elements of src into dst, both accumulators must use the same
+ * compare function, src is not changed.
+ */
+
+void top_k_merge(TopK *dst, const TopK *src) {
+    top_k_push_n(dst, src->heap, src->n);
+}
+
+/*
+ * get the best elements in order, the accumulator is not changed and more
+ * elements may be pushed later.
  *
- * @param arr is an allocated array of pointers to opaque type data, the arr
- *            store elements of heap, the array has stored elements of an
- *            ordered heap.
+ * @param tk  is a pointer to accumulator.
+ * @param out is an allocated array of at least k pointers.
  *
- * @return a pointer to the top element of heap.
+ * @return number of elements in out, which is less than k if fewer elements
+ *         have been pushed.
  */
 
-void *heap_top_p(void **arr) {
-    return arr[0];
+int top_k_final(const TopK *tk, void **out) {
+    memcpy(out, tk->heap, sizeof(void *) * tk->n);
+    heap_sort_p(out, tk->n, tk->cmp);
+    return tk->n;
+}
+
+/******************************************************************************/
+/* priority queue                                                             */
+/******************************************************************************/
+
+/*
+ * compare elements of two handles, the smaller handle goes first if they are
+ * equal, so that elements pushed in order leave in order.
+ */
+
+static inline int pq_less(const PrioQ *pq, int h1, int h2) {
+    int c = pq->cmp(pq->elem[h1], pq->elem[h2]);
+    return c < 0 || (c == 0 && h1 < h2);
+}
+
+/*
+ * move a hole at index i of heap up until handle h fits in it.
+ */
+
+static void pq_up(PrioQ *pq, int i, int h) {
+    for (int p; i > 0 && pq_less(pq, h, pq->heap[p = (i - 1) / HEAP_D]);
+         i = p) {
+        pq->heap[i] = pq->heap[p];
+        pq->pos[pq->heap[i]] = i;
+    }
+    pq->heap[i] = h;
+    pq->pos[h]  = i;
+}
+
+/*
+ * move a hole at index i of heap down until handle h fits in it.
+ */
+
+static void pq_down(PrioQ *pq, int i, int h) {
+    for (int c, last; (c = HEAP_D * i + 1) < pq->n; i = c) {
+        last = pq->n - c < HEAP_D ? pq->n : c + HEAP_D;
+        for (int j = c + 1; j < last; j++)
+            if (pq_less(pq, pq->heap[j], pq->heap[c]))
+                c = j;
+        if (!pq_less(pq, pq->heap[c], h))
+            break;
+        pq->heap[i] = pq->heap[c];
+        pq->pos[pq->heap[i]] = i;
+    }
+    pq->heap[i] = h;
+    pq->pos[h]  = i;
 }
 
 /*
- * insert a new element into a heap.
+ * grow arrays of priority queue to cap handles.
  *
- * @param arr is an allocated array of pointers to opaque type data, the arr
- *            store elements of heap, the array has stored elements of an
- *            ordered heap.
- * @param new is a pointer to opaque element who will be inserted in the heap.
- * @param n   is the current number of elements in heap.
- * @param k   is the max number of elements in heap.
+ * @return 0 on success, otherwise -1.
+ */
+
+static int pq_grow(PrioQ *pq, int cap) {
+    int   *heap = (int *)realloc(pq->heap, sizeof(int) * cap);
+    int   *pos  = heap == NULL ? NULL :
+                  (int *)realloc(pq->pos, sizeof(int) * cap);
+    void **elem = pos == NULL ? NULL :
+                  (void **)realloc(pq->elem, sizeof(void *) * cap);
+    int   *fh   = elem == NULL ? NULL :
+                  (int *)realloc(pq->free_h, sizeof(int) * cap);
+    if (heap != NULL) pq->heap   = heap;
+    if (pos  != NULL) pq->pos    = pos;
+    if (elem != NULL) pq->elem   = elem;
+    if (fh   != NULL) pq->free_h = fh;
+    if (fh == NULL)
+        return -1;
+    pq->cap = cap;
+    return 0;
+}
+
+/*
+ * create a priority queue, the smallest element is on top if compare
+ * function is 'cmp()', and the largest one if it is 'cmp_rev()'. the heap
+ * is of arity HEAP_D, whose wider nodes make it shallower, which pays for
+ * pushes and decrease-keys sifting up.
+ *
+ * @param cap is the initial capacity, which grows as elements are pushed.
  * @param cmp is a pointer to a function comparing elements.
+ *
+ * @return a pointer to priority queue on success, otherwise NULL.
  */
 
-void heap_insert_p(void **arr, void *new, int n, int k,
-                   int(*cmp)(const void *, const void *)) {
-    if (n + 1 > k)
+PrioQ *pq_create(int cap, int(*cmp)(const void *, const void *)) {
+    PrioQ *pq = (PrioQ *)calloc(1, sizeof(PrioQ));
+    if (pq != NULL && pq_grow(pq, cap < 1 ? 1 : cap) < 0)
+        pq_destroy(pq), pq = NULL;
+    if (pq == NULL) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        return NULL;
+    }
+    pq->cmp = cmp;
+    return pq;
+}
+
+void pq_destroy(PrioQ *pq) {
+    if (pq == NULL)
         return;
-    arr[n] = new;
-    int p_idx = (n - 1) / 2, c_idx = n;
-    while (p_idx >= 0 && cmp(arr[c_idx], arr[p_idx]) > 0) {
-        SWAP_PTR(arr[p_idx], arr[c_idx]);
-        c_idx = p_idx;
-        p_idx = (c_idx - 1) / 2;
+    free(pq->free_h);
+    free(pq->elem);
+    free(pq->pos);
+    free(pq->heap);
+    free(pq);
+}
+
+int pq_size(const PrioQ *pq) {
+    return pq->n;
+}
+
+/*
+ * push an element into priority queue.
+ *
+ * time  complexity: O(log n)
+ *
+ * @return a handle of element on success, which is valid until the element
+ *         is popped, otherwise -1.
+ */
+
+int pq_push(PrioQ *pq, void *new) {
+    int h;
+    if (pq->nb_free == 0 && pq->nb_h == pq->cap &&
+        pq_grow(pq, pq->cap * 2) < 0) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        return -1;
     }
+    h = pq->nb_free > 0 ? pq->free_h[--pq->nb_free] : pq->nb_h++;
+    pq->elem[h] = new;
+    pq_up(pq, pq->n++, h);
+    return h;
 }
 
 /*
- * replace the top of heap and keep the nature of heap.
+ * get top element of priority queue.
  *
- * @param arr is an allocated array of pointers to opaque type data, the arr
- *            store elements of heap, the array has stored elements of an
- *            ordered heap.
- * @param new is a pointer to opaque element who will be new top of heap.
- * @param n   is the number of elements in old heap.
- * @param cmp is a pointer to a function comparing elements.
+ * @return a pointer to the top element, or NULL if it is empty.
  */
 
-void heap_repl_p(void **arr, void *new, int n,
-                 int(*cmp)(const void *, const void *)) {
-    arr[0] = new;
-    heapify_p(arr, 0, n, cmp);
+void *pq_top(const PrioQ *pq) {
+    return pq->n > 0 ? pq->elem[pq->heap[0]] : NULL;
 }
 
 /*
- * delete top of heap and keep the nature of heap.
+ * pop top element of priority queue, its handle is freed.
  *
- * @param arr is an allocated array of pointers to opaque type data, the arr
- *            store elements of heap, the array has stored elements of an
- *            ordered heap.
- * @param n   is the number of elements in old heap.
- * @param cmp is a pointer to a function comparing elements.
+ * time  complexity: O(d * log n / log d)
  *
- * @return a pointer to the top element of heap.
+ * @return a pointer to the top element, or NULL if it is empty.
  */
 
-void *heap_del_p(void **arr, int n,
-                 int(*cmp)(const void *, const void *)) {
-    void *ret = arr[0];
-    SWAP_PTR(arr[0], arr[n - 1]);
-    heapify_p(arr, 0, n - 1, cmp);
-    memset(arr + (n - 1), 0, sizeof(void *));
-    return ret;
+void *pq_pop(PrioQ *pq) {
+    int h;
+    if (pq->n == 0)
+        return NULL;
+    h = pq->heap[0];
+    pq->pos[h] = -1;
+    pq->free_h[pq->nb_free++] = h;
+    if (--pq->n > 0)
+        pq_down(pq, 0, pq->heap[pq->n]);
+    return pq->elem[h];
 }
 
 /*
- * heap sort function based on pointer.
- * 
- * the final order of input array depends on compare function is 'cmp()' or
- * 'cmp_rev()'.
+ * decrease key: replace the element of a handle by one not after it.
  *
- * best    case: O(n * log n)
- * worst   case: O(n * log n)
- * average case: O(n * log n)
+ * time  complexity: O(log n)
  *
- * @param arr is an allocated array of pointers to opaque type data.
- * @param n   is number of elements in the array.
- * @param cmp is a pointer to a function comparing elements.
+ * @param pq  is a pointer to priority queue.
+ * @param h   is a handle got by 'pq_push()'.
+ * @param new is a pointer to opaque element, which is not after the old one.
+ *
+ * @return 0 on success, otherwise -1 if handle is invalid.
  */
 
-void heap_sort_p(void **arr, int n,
-                 int(*cmp)(const void *, const void *)) {
-    heap_build_p(arr, n, cmp);
-    for (int i = n - 1; i > 0; i--) {
-        SWAP_PTR(arr[i], arr[0]);
-        heapify_p(arr, 0, i, cmp);
-    }
+int pq_decrease(PrioQ *pq, int h, void *new) {
+    if (h < 0 || h >= pq->nb_h || pq->pos[h] < 0)
+        return -1;
+    pq->elem[h] = new;
+    pq_up(pq, pq->pos[h], h);
+    return 0;
 }
 
 /*
- * select the k-th element of set by using heap.
- * 
- * if the compare function is 'cmp()', select the k-th smallest element, if
- * it is 'cmp_rev()', select the k-th largest element.
+ * k-way merge of sorted runs based on pointer, by a priority queue of runs,
+ * the element of a former run is taken first when elements are equal.
  *
  * time  complexity: O(n * log k)
  * space complexity: O(k)
  *
- * @param set   is an input allocated set.
- * @param max_n is the number of elements of input set.
- * @param k     is the size of the heap.
- * @param cmp   is a pointer to a function comparing elements.
+ * @param runs is an array of k sorted arrays of pointers to opaque type data.
+ * @param len  is an array of k numbers of elements of runs.
+ * @param k    is number of runs.
+ * @param out  is an allocated array of the sum of len pointers.
+ * @param cmp  is a pointer to a function comparing elements.
  *
- * @return a pointer to the k-th element on success, otherwise NULL.
+ * @return number of elements in out on success, otherwise -1.
  */
 
-void *heap_top_k_p(void **set, int max_n, int k,
-                   int(*cmp)(const void *, const void *)) {
-    if (k > max_n || k < 1)
-        return NULL;
-    int n = 0;
-    void *k_ptr = NULL;
-    void **arr  = NULL;
-    arr = (void **)malloc(sizeof(void *) * (k + 1));
-    if (arr == NULL) {
+int merge_k_p(void ***runs, const int *len, int k, void **out,
+              int(*cmp)(const void *, const void *)) {
+    int    idx = 0, *run = (int *)malloc(sizeof(int) * 2 * (k > 0 ? k : 1));
+    int   *cur = run + k;
+    PrioQ *pq  = NULL;
+    if (run == NULL) {
         fprintf(stderr, "ERROR allocating memory.\n");
-        return NULL;
+        return -1;
     }
-    for (int i = 0; i < max_n; i++) {
-        if (n >= k && cmp(set[i], heap_top_p(arr)) < 0)
-            heap_repl_p(arr, set[i], n, cmp);
-        else if (n < k)
-            heap_push_p(arr, set[i], n++, k, cmp);
+    if ((pq = pq_create(k, cmp)) == NULL) {
+        free(run);
+        return -1;
     }
-    for (int i = k - 1; i > 0; i--) {
-        SWAP_PTR(arr[i], arr[0]);
-        heapify_p(arr, 0, i, cmp);
+    /* handles are got in order of runs, they break ties */
+    for (int r = 0, h; r < k; r++) {
+        if (len[r] > 0) {
+            h = pq_push(pq, runs[r][0]);
+            run[h] = r;
+            cur[h] = 0;
+        }
     }
-    k_ptr = arr[k - 1];
-    free(arr);
-    return k_ptr;
+    while (pq->n > 0) {
+        int h = pq->heap[0], r = run[h];
+        out[idx++] = pq->elem[h];
+        if (++cur[h] < len[r]) {
+            pq->elem[h] = runs[r][cur[h]];
+            pq_down(pq, 0, h);
+        } else {
+            pq_pop(pq);
+        }
+    }
+    STAT_MOVE(idx);
+    pq_destroy(pq);
+    free(run);
+    return idx;
 }
 
 /******************************************************************************/
 /* quick sort                                                                 */
 /******************************************************************************/
 
+/*
+ * 'quick_sort_p()', 'quick_sort_bfprt_p()', 'quick_sort_block_p()',
+ * 'intro_sort_p()', 'quick_sort_3way_p()', 'partition_p()',
+ * 'BFPRT_p_idx_p()', 'BFPRT_k_idx_p()' and 'BFPRT_k_idx_block_p()' are
+ * wrappers over templates of 'sort_algo.hpp' (see 'sort_tpl.cpp'), so are
+ * insert, select, bubble, merge and shell sort based on pointer, and
+ * 'gen_gap_p()'.
+ */
+
 /*
  * select the best pivot index from array based on pointer using 3-mid method.
  *
@@ -480,7 +693,6 @@ int three_mid_val_p(void **arr, int left, int right,
         return left;
     else {
         int idx[3];
-        srand((unsigned)time(NULL));
         for (int i = 0; i < 3; i++)
             idx[i] = rand() % (right - left + 1) + left;
         if (cmp(arr[idx[0]], arr[idx[1]]) * cmp(arr[idx[0]], arr[idx[2]]) <= 0)
@@ -492,47 +704,14 @@ int three_mid_val_p(void **arr, int left, int right,
     }
 }
 
+/******************************************************************************/
+/* bucket sort                                                                */
+/******************************************************************************/
+
 /*
- * quick sort function based on pointer.
+ * computing the most suitable number of buckets.
  *
- * best    case: < O(n * log n)
- * worst   case:   O(n ^ 2)
- * average case:   O(n * log n)
- *
- * @param arr   is an allocated array of pointers to opaque type data.
- * @param left  is left index of array.
- * @param right is right index of array.
- * @param cmp   is a pointer to a function comparing elements.
- */
-
-void quick_sort_p(void **arr, int begin, int end,
-                  int(*cmp)(const void *, const void *)) {
-    if (end - begin > 1) {
-        // int pivot = three_mid_val_p(arr, begin, end - 1, cmp);
-        int pivot = BFPRT_p_idx_p(arr, begin, end, cmp);
-        int low   = begin;
-        int high  = end - 1;
-        SWAP_PTR(arr[begin], arr[pivot]);
-        pivot = begin;
-        while (low < high) {
-            while(low < high && cmp(arr[high], arr[pivot]) >= 0) high--;
-            while(low < high && cmp(arr[low], arr[pivot]) <= 0) low++;
-            SWAP_PTR(arr[low], arr[high]);
-        }
-        SWAP_PTR(arr[low], arr[pivot]);
-        quick_sort_p(arr, begin, low, cmp);
-        quick_sort_p(arr, low + 1, end, cmp);
-    }
-}
-
-/******************************************************************************/
-/* bucket sort                                                                */
-/******************************************************************************/
-
-/*
- * computing the most suitable number of buckets.
- *
- * the spetific algorithm depends on attribute input data set.
+ * the spetific algorithm depends on attribute input data set.
  *
  * @param n is number of element of input data set.
  *
@@ -563,48 +742,31 @@ int hash_idx_p(void *data, int k) {
     return (int)abs(k * (*(double *)data- min) / (max - min)) % k;
 }
 
+#define BKT_CUTOFF  32          /* larger buckets are sorted by heap sort  */
+
 /*
- * extract buckets function contains of the following steps:
- *
- * 1. insert sort in inside of every bucket.
- * 2. move data from every bucket to input set.
- * 3. release memory allocated from linked list of every inside of bucket.
+ * extract buckets function, sort every bucket in place.
  *
- * @param n is number of item of input set, k is number of buckets.
+ * buckets of no more than BKT_CUTOFF elements are sorted by insertion sort,
+ * larger ones, which come from skewed or repeated keys, by heap sort.
  *
  * @param arr     is an input allocated array of pointers to opaque type data.
  * @param buckets is a pointer to address of array of buckets.
  * @param n       is the number of elements of input set.
- * @param k       is the size of the heap.
+ * @param k       is number of buckets.
  * @param cmp     is a pointer to a function comparing elements.
  */
 
 void ext_bucket_p(void **arr, Bucket *buckets, int n, 
                   int k, int(*cmp)(const void *, const void *)) {
-    int low, pos = 0;               /* index of input data set */
-    Entry *pe = NULL;               /* point to a entry        */
-    Entry *pt = NULL;               /* point to temp entry     */
+    (void)n;
     for (int i = 0; i < k; i++) {
-        pe = buckets[i].head;
-        if (pe == NULL) continue;
-        low = pos;
-        arr[pos++] = pe->data;
-        pt = pe;
-        pe = pe->next;
-        free(pt);
-        for (int j; pe != NULL;) {
-            j = pos - 1;
-            while (j >= low && cmp(arr[j], pe->data) > 0) {
-                arr[j + 1] = arr[j];
-                j--;
-            }
-            arr[j + 1] = pe->data;
-            pos++;
-            pt = pe;
-            pe = pe->next;
-            free(pt);
-        }
-        buckets[i].size = 0;
+        if (buckets[i].size < 2)
+            continue;
+        if (buckets[i].size <= BKT_CUTOFF)
+            insert_sort_p(arr + buckets[i].begin, buckets[i].size, cmp);
+        else
+            heap_sort_p(arr + buckets[i].begin, buckets[i].size, cmp);
     }
 }
 
@@ -615,10 +777,12 @@ void ext_bucket_p(void **arr, Bucket *buckets, int n,
  * which contains of double floating point type data and their scope known,
  * it is [256, 25536].
  *
- * bucket sort need more extra memory but less time.
+ * elements are counted per bucket first, then scattered into a scratch
+ * array at the prefix sum of counts, so that every bucket is contiguous
+ * and no memory is allocated per element.
  *
  * time complexity : O(n)
- * space complexity: O(k)
+ * space complexity: O(n + k)
  *
  * @param arr     is an input allocated array of pointers to opaque type data.
  * @param n       is the number of elements of input set.
@@ -632,74 +796,193 @@ void bucket_sort_p(void **arr, int n,
                    int(*hash)(void *, int), 
                    int(*cmp)(const void *, const void *)) {
     Bucket *buckets = NULL;
-    Entry  *e       = NULL;
+    void  **tmp     = NULL;
     int idx = 0;
     int k   = nb_bkts(n);
 
-    /* allocate memory for k buckets */
-    buckets = (Bucket *)malloc(k * sizeof(Bucket));
-    if (buckets == NULL) {
+    /* allocate memory for k buckets and a scratch array */
+    buckets = (Bucket *)calloc(k, sizeof(Bucket));
+    tmp     = (void **)malloc(n * sizeof(void *));
+    if (buckets == NULL || tmp == NULL) {
         fprintf(stderr, "ERROE allocating memory\n");
+        free(buckets);
+        free(tmp);
         return;
     }
     
-    /* build k buckets with linked list depends on input data set */
+    /* count elements of every bucket */
+    for (int i = 0; i < n; i++)
+        buckets[hash(arr[i], k)].size++;
+    for (int i = 0, pos = 0; i < k; i++) {
+        buckets[i].begin = pos;
+        pos += buckets[i].size;
+    }
+
+    /* scatter elements, 'begin' is used as cursor and restored later */
     for (int i = 0; i < n; i++) {
         idx = hash(arr[i], k);
-        e = (Entry *)malloc(1 * sizeof(Entry));
-        e->data = arr[i];
-        if (buckets[idx].head == NULL) {
-            buckets[idx].head = e;
-            buckets[idx].size = 1;
-        } else {
-            e->next = buckets[idx].head;
-            buckets[idx].head = e;
-            buckets[idx].size++;
-        }
+        tmp[buckets[idx].begin++] = arr[i];
     }
+    for (int i = 0; i < k; i++)
+        buckets[i].begin -= buckets[i].size;
+    memcpy(arr, tmp, n * sizeof(void *));
+    STAT_MOVE(2 * n);
     
-    /* sort, reset input data set and release memory of linked list */
+    /* sort every bucket */
     ext_bucket_p(arr, buckets, n, k, cmp);
 
-    /* release memory for k buckets */
+    free(tmp);
     free(buckets);
 }
 
 /******************************************************************************/
-/* merge sort                                                                 */
+/* sample sort                                                                */
 /******************************************************************************/
 
-/*  
- * merge sort internal recursive function.
- *
- * @param pointer 'copy' point to an allocated memory, which should be released
- * by caller.
+#define SS_BASE     512         /* fewer elements are sorted by merge sort */
+#define SS_MAX_LOG  7           /* at most 2 ^ 7 splitter buckets          */
+#define SS_OVER     16          /* samples per bucket                      */
+#define SS_DEPTH    16          /* max levels of recursion                 */
+
+/*
+ * state of a level of sample sort.
  *
- * @param copy   is an allocated array, who is source array.
- * @param result is an allocated array, who is destination array.
- * @param begin  is the first index of array.
- * @param end    is the last  index of array.
- * @param cmp    is a pointer to a function comparing elements.
+ * splitters s[0] <= ... <= s[k - 2] are kept in an implicit binary search
+ * tree 'tree[1, k)', the children of tree[j] are tree[2 * j] and
+ * tree[2 * j + 1]. bucket i holds elements e, s[i - 1] < e <= s[i]. if
+ * equality buckets are used, bucket i is split into 2 * i for e < s[i]
+ * and 2 * i + 1 for e == s[i], the latter is never sorted again.
  */
 
-void m_sort_p(void **copy, void **result,
-              int begin, int end,
-              int(*cmp)(const void *, const void *)) {
-    if (end - begin <= 1)
+typedef struct ss_level {
+    void   *tree[1 << SS_MAX_LOG];
+    void   *spl[1 << SS_MAX_LOG];
+    int     log;                /* depth of tree, k = 2 ^ log              */
+    int     use_eq;             /* equality buckets are used               */
+    int     cnt[2 << SS_MAX_LOG];
+    int(*cmp)(const void *, const void *);
+} SsLevel;
+
+/*
+ * fill tree[j] and its subtree with sorted splitters spl[lo, hi).
+ */
+
+static void ss_build(SsLevel *lv, int j, int lo, int hi) {
+    int med = (lo + hi) / 2;
+    if (lo >= hi)
         return;
-    int med = (begin + end) / 2;
-    m_sort_p(result, copy, begin, med, cmp);
-    m_sort_p(result, copy, med, end, cmp);
-    for (int idx = begin, i = begin, j = med; idx < end;) {
-        if (j >= end || (i < med && cmp(copy[i], copy[j]) <= 0))
-            result[idx++] = copy[i++];
+    lv->tree[j] = lv->spl[med];
+    ss_build(lv, 2 * j, lo, med);
+    ss_build(lv, 2 * j + 1, med + 1, hi);
+}
+
+/*
+ * find the bucket of an element, the tree is searched without branching
+ * on the result of comparing.
+ */
+
+static inline int ss_find(SsLevel *lv, void *e) {
+    int j = 1, k = 1 << lv->log;
+    for (int l = 0; l < lv->log; l++)
+        j = 2 * j + (lv->cmp(lv->tree[j], e) < 0);
+    j -= k;
+    if (lv->use_eq)
+        j = 2 * j + (j < k - 1 && lv->cmp(e, lv->spl[j]) == 0);
+    return j;
+}
+
+/*
+ * draw an oversampled set of splitters from arr.
+ *
+ * a splitter chosen twice means a frequent key, then equality buckets are
+ * used and duplicated splitters are removed.
+ */
+
+static void ss_sample(SsLevel *lv, void **arr, void **tmp, int n) {
+    int k = 1 << lv->log, nb_s = k * SS_OVER, m = 0;
+    uint64_t x = 0x9E3779B97F4A7C15ULL ^ (uint64_t)n;
+    for (int i = 0; i < nb_s; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        tmp[n - nb_s + i] = arr[x % (uint64_t)n];
+    }
+    memcpy(tmp, tmp + n - nb_s, sizeof(void *) * nb_s);
+    m_sort_p(tmp, tmp + n - nb_s, 0, nb_s, lv->cmp);
+    lv->use_eq = 0;
+    for (int i = 1; i < k; i++) {
+        void *e = tmp[n - nb_s + i * SS_OVER];
+        if (m > 0 && lv->cmp(lv->spl[m - 1], e) == 0)
+            lv->use_eq = 1;
         else
-            result[idx++] = copy[j++];
+            lv->spl[m++] = e;
+    }
+    /* shrink tree and pad splitters to 2 ^ log - 1 */
+    for (lv->log = 1; (1 << lv->log) - 1 < m; lv->log++);
+    for (int i = m; i < (1 << lv->log) - 1; i++)
+        lv->spl[i] = lv->spl[m - 1];
+    ss_build(lv, 1, 0, (1 << lv->log) - 1);
+}
+
+/*
+ * sample sort internal recursive function.
+ *
+ * @param arr   is an allocated array of pointers to opaque type data.
+ * @param tmp   is a scratch array of n pointers.
+ * @param oracle is a scratch array of n bytes.
+ * @param n     is number of elements in the array.
+ * @param depth is number of levels which can be recursed still.
+ * @param cmp   is a pointer to a function comparing elements.
+ */
+
+static void ss_sort_p(void **arr, void **tmp, uint8_t *oracle, int n,
+                      int depth, int(*cmp)(const void *, const void *)) {
+    SsLevel lv;
+    int nb_b, pos = 0;
+    if (n <= SS_BASE || depth == 0) {
+        memcpy(tmp, arr, sizeof(void *) * n);
+        m_sort_p(tmp, arr, 0, n, cmp);
+        return;
+    }
+    lv.cmp = cmp;
+    for (lv.log = 1; lv.log < SS_MAX_LOG && (n >> lv.log) > SS_BASE; lv.log++);
+    ss_sample(&lv, arr, tmp, n);
+    nb_b = (1 << lv.log) << lv.use_eq;
+
+    /* classify, count, then scatter to tmp at the prefix sum of counts */
+    memset(lv.cnt, 0, sizeof(int) * nb_b);
+    for (int i = 0; i < n; i++) {
+        oracle[i] = (uint8_t)ss_find(&lv, arr[i]);
+        lv.cnt[oracle[i]]++;
+    }
+    for (int b = 0, c; b < nb_b; b++) {
+        c = lv.cnt[b];
+        lv.cnt[b] = pos;
+        pos += c;
+    }
+    for (int i = 0; i < n; i++)
+        tmp[lv.cnt[oracle[i]]++] = arr[i];
+    memcpy(arr, tmp, sizeof(void *) * n);
+    STAT_MOVE(2 * n);
+
+    /* 'cnt[b]' is the end of bucket b now, sort buckets except equal ones */
+    for (int b = 0, lo = 0; b < nb_b; lo = lv.cnt[b++]) {
+        if (lv.use_eq && b % 2 == 1)
+            continue;
+        if (lv.cnt[b] - lo > 1)
+            ss_sort_p(arr + lo, tmp + lo, oracle + lo, lv.cnt[b] - lo,
+                      depth - 1, cmp);
     }
 }
 
 /*
- * merge sort function based on pointer.
+ * sample sort function based on pointer.
+ *
+ * unlike 'bucket_sort_p()', splitters are drawn from input, so it works
+ * with any compare function and keeps buckets balanced on skewed input.
+ * an element is classified by searching a tree of up to 127 splitters,
+ * frequent keys get their own buckets, oversized buckets are sorted
+ * recursively, and small ones by merge sort.
  *
  * time  complexity: O(n * log n)
  * space complexity: O(n)
@@ -709,172 +992,2072 @@ void m_sort_p(void **copy, void **result,
  * @param cmp is a pointer to a function comparing elements.
  */
 
-void merge_sort_p(void **arr, int n,
-                  int(*cmp)(const void *, const void *)) {
-    void **copy = NULL;
-    copy = (void **)malloc(sizeof(void *) * n);
-    if (copy == NULL) {
+void sample_sort_p(void **arr, int n,
+                   int(*cmp)(const void *, const void *)) {
+    void   **tmp    = (void **)malloc(sizeof(void *) * n);
+    uint8_t *oracle = (uint8_t *)malloc(n);
+    if (tmp == NULL || oracle == NULL) {
         fprintf(stderr, "ERROE allocating memory\n");
+        free(oracle);
+        free(tmp);
         return;
     }
-    memmove(copy, arr, sizeof(void *) * n);
-    m_sort_p(copy, arr, 0, n, cmp);
-    free(copy);
+    ss_sort_p(arr, tmp, oracle, n, SS_DEPTH, cmp);
+    free(oracle);
+    free(tmp);
+}
+
+/******************************************************************************/
+/* merge sort                                                                 */
+/******************************************************************************/
+
+/*
+ * merge two sorted arrays into an allocated array, the element of 'a' is
+ * taken first when two elements are equal, as 'm_sort_p()' does.
+ *
+ * @param a   is a sorted array of pointers to opaque type data.
+ * @param na  is number of elements in a.
+ * @param b   is a sorted array of pointers to opaque type data.
+ * @param nb  is number of elements in b.
+ * @param out is an allocated array of (na + nb) pointers.
+ * @param cmp is a pointer to a function comparing elements.
+ */
+
+void merge_p(void **a, int na, void **b, int nb, void **out,
+             int(*cmp)(const void *, const void *)) {
+    int i = 0, j = 0, idx = 0;
+    while (i < na && j < nb) {
+        if (cmp(a[i], b[j]) <= 0)
+            out[idx++] = a[i++];
+        else
+            out[idx++] = b[j++];
+    }
+    memmove(out + idx, a + i, sizeof(void *) * (na - i));
+    memmove(out + idx + na - i, b + j, sizeof(void *) * (nb - j));
+    STAT_MOVE(na + nb);
 }
 
 /******************************************************************************/
-/* shell sort                                                                 */
+/* tim sort                                                                   */
 /******************************************************************************/
 
-/*  
- * generate a gap array for shell sort.
+#define TS_MIN_MERGE    64      /* fewer elements are sorted by insertion  */
+#define TS_MIN_GALLOP   7       /* initial threshold of galloping mode     */
+#define TS_MAX_RUN      64      /* max pending runs, powers are increasing */
+
+/*
+ * state of tim sort, 'run' is the stack of pending runs, 'power' of a run is
+ * the power of node between it and the next run.
+ */
+
+typedef struct ts_state {
+    void  **arr;
+    void  **tmp;                /* scratch array of n / 2 elements         */
+    int     n;
+    int     min_gallop;
+    int     nb_run;
+    struct {
+        int begin;
+        int len;
+        int power;
+    } run[TS_MAX_RUN];
+    int(*cmp)(const void *, const void *);
+} TsState;
+
+/*
+ * @return minimal length of run, which is in [32, 64] and makes n / min_run
+ *         close to but no more than a power of 2.
+ */
+
+static int ts_min_run(int n) {
+    int r = 0;
+    while (n >= TS_MIN_MERGE) {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+/*
+ * extend sorted range [begin, start) to [begin, end) by binary insertion,
+ * an element is inserted after equal ones so that sort is stable.
+ */
+
+static void ts_bin_insert(void **arr, int begin, int start, int end,
+                          int(*cmp)(const void *, const void *)) {
+    for (int i = start > begin ? start : begin + 1; i < end; i++) {
+        void *pivot = arr[i];
+        int   left  = begin, right = i;
+        while (left < right) {
+            int mid = left + (right - left) / 2;
+            if (cmp(pivot, arr[mid]) < 0)
+                right = mid;
+            else
+                left = mid + 1;
+        }
+        memmove(arr + left + 1, arr + left, sizeof(void *) * (i - left));
+        arr[left] = pivot;
+        STAT_MOVE(i - left + 1);
+    }
+}
+
+/*
+ * find the run beginning at begin, a strictly descending run is reversed,
+ * so equal elements never change their order.
  *
- * @param gap is a pointer to an address of gap array, which will be allocated
- *            memory in function and should be released by caller.
- * @param n   is number of elements of input set.
+ * @return length of run.
+ */
+
+static int ts_count_run(void **arr, int begin, int end,
+                        int(*cmp)(const void *, const void *)) {
+    int i = begin + 1;
+    if (i == end)
+        return 1;
+    if (cmp(arr[i++], arr[begin]) < 0) {
+        while (i < end && cmp(arr[i], arr[i - 1]) < 0)
+            i++;
+        for (int lo = begin, hi = i - 1; lo < hi; lo++, hi--)
+            SWAP_PTR(arr[lo], arr[hi]);
+    } else {
+        while (i < end && cmp(arr[i], arr[i - 1]) >= 0)
+            i++;
+    }
+    return i - begin;
+}
+
+/*
+ * find position of key in sorted a[0, n) by galloping from a[hint], then
+ * binary search.
  *
- * @return size of gap array on success, otherwise -1.
+ * @return k that a[k - 1] < key <= a[k], key goes before equal elements.
  */
 
-int gen_gap_p(int **gap, int n){
-    int k = 0, gap_val = 1;
-    for (int j = 0, i; gap_val <= n / 2;) {
-        *gap = realloc(*gap, sizeof(int) * (k + 1));
-        if (*gap == NULL) return -1;
-        (*gap)[k++] = gap_val;
-        int i = ++j / 2;
-        if (j % 2 == 0)
-            gap_val = 9 * pow(4, i) - 9 * pow(2, i) + 1;
+static int ts_gallop_left(void *key, void **a, int n, int hint,
+                          int(*cmp)(const void *, const void *)) {
+    int last = 0, ofs = 1, max_ofs;
+    if (cmp(key, a[hint]) > 0) {
+        /* gallop right until a[hint + last] < key <= a[hint + ofs] */
+        max_ofs = n - hint;
+        while (ofs < max_ofs && cmp(key, a[hint + ofs]) > 0) {
+            last = ofs;
+            ofs  = ofs < max_ofs / 2 ? (ofs << 1) + 1 : max_ofs;
+        }
+        ofs   = ofs < max_ofs ? ofs : max_ofs;
+        last += hint;
+        ofs  += hint;
+    } else {
+        /* gallop left until a[hint - ofs] < key <= a[hint - last] */
+        int t;
+        max_ofs = hint + 1;
+        while (ofs < max_ofs && cmp(key, a[hint - ofs]) <= 0) {
+            last = ofs;
+            ofs  = ofs < max_ofs / 2 ? (ofs << 1) + 1 : max_ofs;
+        }
+        ofs  = ofs < max_ofs ? ofs : max_ofs;
+        t    = last;
+        last = hint - ofs;
+        ofs  = hint - t;
+    }
+    for (last++; last < ofs;) {
+        int mid = last + (ofs - last) / 2;
+        if (cmp(key, a[mid]) > 0)
+            last = mid + 1;
         else
-            gap_val = pow(2, i + 2) * (pow(2, i + 2) - 3) + 1;
+            ofs = mid;
     }
-    return k; 
+    return ofs;
 }
 
 /*
- * shell sort function based on pointer.
+ * same as 'ts_gallop_left()', but key goes after equal elements.
  *
- * best    case:   O(n)
- * worst   case:   ?
- * average case:   ?
+ * @return k that a[k - 1] <= key < a[k].
+ */
+
+static int ts_gallop_right(void *key, void **a, int n, int hint,
+                           int(*cmp)(const void *, const void *)) {
+    int last = 0, ofs = 1, max_ofs;
+    if (cmp(key, a[hint]) < 0) {
+        /* gallop left until a[hint - ofs] <= key < a[hint - last] */
+        int t;
+        max_ofs = hint + 1;
+        while (ofs < max_ofs && cmp(key, a[hint - ofs]) < 0) {
+            last = ofs;
+            ofs  = ofs < max_ofs / 2 ? (ofs << 1) + 1 : max_ofs;
+        }
+        ofs  = ofs < max_ofs ? ofs : max_ofs;
+        t    = last;
+        last = hint - ofs;
+        ofs  = hint - t;
+    } else {
+        /* gallop right until a[hint + last] <= key < a[hint + ofs] */
+        max_ofs = n - hint;
+        while (ofs < max_ofs && cmp(key, a[hint + ofs]) >= 0) {
+            last = ofs;
+            ofs  = ofs < max_ofs / 2 ? (ofs << 1) + 1 : max_ofs;
+        }
+        ofs   = ofs < max_ofs ? ofs : max_ofs;
+        last += hint;
+        ofs  += hint;
+    }
+    for (last++; last < ofs;) {
+        int mid = last + (ofs - last) / 2;
+        if (cmp(key, a[mid]) < 0)
+            ofs = mid;
+        else
+            last = mid + 1;
+    }
+    return ofs;
+}
+
+/*
+ * merge adjacent runs a[b1, b1 + n1) and a[b2, b2 + n2) where n1 <= n2, the
+ * first run is copied to scratch array and merged from left.
+ *
+ * a[b2] < a[b1] and a[b1 + n1 - 1] > a[b2 + n2 - 1] hold, which are made by
+ * 'ts_merge_at()'.
+ *
+ * elements are taken one by one until a run wins TS_MIN_GALLOP times in a
+ * row, then galloping finds how many elements of a run go next at once, and
+ * it goes on while galloping pays off.
+ */
+
+static void ts_merge_lo(TsState *ts, int b1, int n1, int b2, int n2) {
+    void **a = ts->arr, **tmp = ts->tmp;
+    int    c1 = 0, c2 = b2, dst = b1, min_gallop = ts->min_gallop;
+    int(*cmp)(const void *, const void *) = ts->cmp;
+
+    memcpy(tmp, a + b1, sizeof(void *) * n1);
+    STAT_MOVE(n1 + n2);
+    a[dst++] = a[c2++];
+    if (--n2 == 0 || n1 == 1)
+        goto end;
+    for (;;) {
+        int cnt1 = 0, cnt2 = 0;
+
+        /* one element at a time */
+        do {
+            if (cmp(a[c2], tmp[c1]) < 0) {
+                a[dst++] = a[c2++];
+                cnt2++;
+                cnt1 = 0;
+                if (--n2 == 0)
+                    goto end;
+            } else {
+                a[dst++] = tmp[c1++];
+                cnt1++;
+                cnt2 = 0;
+                if (--n1 == 1)
+                    goto end;
+            }
+        } while ((cnt1 | cnt2) < min_gallop);
+
+        /* galloping */
+        do {
+            cnt1 = ts_gallop_right(a[c2], tmp + c1, n1, 0, cmp);
+            if (cnt1 != 0) {
+                memcpy(a + dst, tmp + c1, sizeof(void *) * cnt1);
+                dst += cnt1;
+                c1  += cnt1;
+                n1  -= cnt1;
+                if (n1 <= 1)
+                    goto end;
+            }
+            a[dst++] = a[c2++];
+            if (--n2 == 0)
+                goto end;
+            cnt2 = ts_gallop_left(tmp[c1], a + c2, n2, 0, cmp);
+            if (cnt2 != 0) {
+                memmove(a + dst, a + c2, sizeof(void *) * cnt2);
+                dst += cnt2;
+                c2  += cnt2;
+                n2  -= cnt2;
+                if (n2 == 0)
+                    goto end;
+            }
+            a[dst++] = tmp[c1++];
+            if (--n1 == 1)
+                goto end;
+            min_gallop--;
+        } while (cnt1 >= TS_MIN_GALLOP || cnt2 >= TS_MIN_GALLOP);
+        min_gallop = (min_gallop < 0 ? 0 : min_gallop) + 2;
+    }
+end:
+    ts->min_gallop = min_gallop < 1 ? 1 : min_gallop;
+    if (n1 == 1 && n2 > 0) {
+        /* the last element of first run is the largest */
+        memmove(a + dst, a + c2, sizeof(void *) * n2);
+        a[dst + n2] = tmp[c1];
+    } else {
+        memcpy(a + dst, tmp + c1, sizeof(void *) * n1);
+    }
+}
+
+/*
+ * same as 'ts_merge_lo()' where n1 > n2, the second run is copied to scratch
+ * array and merged from right.
+ */
+
+static void ts_merge_hi(TsState *ts, int b1, int n1, int b2, int n2) {
+    void **a = ts->arr, **tmp = ts->tmp;
+    int    c1 = b1 + n1 - 1, c2 = n2 - 1, dst = b2 + n2 - 1;
+    int    min_gallop = ts->min_gallop;
+    int(*cmp)(const void *, const void *) = ts->cmp;
+
+    memcpy(tmp, a + b2, sizeof(void *) * n2);
+    STAT_MOVE(n1 + n2);
+    a[dst--] = a[c1--];
+    if (--n1 == 0 || n2 == 1)
+        goto end;
+    for (;;) {
+        int cnt1 = 0, cnt2 = 0;
+
+        /* one element at a time */
+        do {
+            if (cmp(tmp[c2], a[c1]) < 0) {
+                a[dst--] = a[c1--];
+                cnt1++;
+                cnt2 = 0;
+                if (--n1 == 0)
+                    goto end;
+            } else {
+                a[dst--] = tmp[c2--];
+                cnt2++;
+                cnt1 = 0;
+                if (--n2 == 1)
+                    goto end;
+            }
+        } while ((cnt1 | cnt2) < min_gallop);
+
+        /* galloping */
+        do {
+            cnt1 = n1 - ts_gallop_right(tmp[c2], a + b1, n1, n1 - 1, cmp);
+            if (cnt1 != 0) {
+                dst -= cnt1;
+                c1  -= cnt1;
+                n1  -= cnt1;
+                memmove(a + dst + 1, a + c1 + 1, sizeof(void *) * cnt1);
+                if (n1 == 0)
+                    goto end;
+            }
+            a[dst--] = tmp[c2--];
+            if (--n2 == 1)
+                goto end;
+            cnt2 = n2 - ts_gallop_left(a[c1], tmp, n2, n2 - 1, cmp);
+            if (cnt2 != 0) {
+                dst -= cnt2;
+                c2  -= cnt2;
+                n2  -= cnt2;
+                memcpy(a + dst + 1, tmp + c2 + 1, sizeof(void *) * cnt2);
+                if (n2 <= 1)
+                    goto end;
+            }
+            a[dst--] = a[c1--];
+            if (--n1 == 0)
+                goto end;
+            min_gallop--;
+        } while (cnt1 >= TS_MIN_GALLOP || cnt2 >= TS_MIN_GALLOP);
+        min_gallop = (min_gallop < 0 ? 0 : min_gallop) + 2;
+    }
+end:
+    ts->min_gallop = min_gallop < 1 ? 1 : min_gallop;
+    if (n2 == 1 && n1 > 0) {
+        /* the first element of second run is the smallest */
+        dst -= n1;
+        c1  -= n1;
+        memmove(a + dst + 1, a + c1 + 1, sizeof(void *) * n1);
+        a[dst] = tmp[c2];
+    } else {
+        memcpy(a + dst - (n2 - 1), tmp, sizeof(void *) * n2);
+    }
+}
+
+/*
+ * merge pending runs i and i + 1.
+ *
+ * elements of first run not greater than the first of second run, and
+ * elements of second run not less than the last of first run, are in place
+ * already, so they are skipped by galloping before merging.
+ */
+
+static void ts_merge_at(TsState *ts, int i) {
+    void **a  = ts->arr;
+    int    b1 = ts->run[i].begin,     n1 = ts->run[i].len;
+    int    b2 = ts->run[i + 1].begin, n2 = ts->run[i + 1].len, k;
+
+    ts->run[i].len   = n1 + n2;
+    ts->run[i].power = ts->run[i + 1].power;
+    ts->nb_run--;
+
+    k   = ts_gallop_right(a[b2], a + b1, n1, 0, ts->cmp);
+    b1 += k;
+    n1 -= k;
+    if (n1 == 0)
+        return;
+    n2 = ts_gallop_left(a[b1 + n1 - 1], a + b2, n2, n2 - 1, ts->cmp);
+    if (n2 == 0)
+        return;
+    if (n1 <= n2)
+        ts_merge_lo(ts, b1, n1, b2, n2);
+    else
+        ts_merge_hi(ts, b1, n1, b2, n2);
+}
+
+/*
+ * power of node between run [b1, b1 + n1) and the next run of n2 elements,
+ * which is depth of the node in a perfectly balanced merge tree of n
+ * elements (powersort).
+ */
+
+static int ts_power(int b1, int n1, int n2, int n) {
+    long long a = 2LL * b1 + n1;        /* 2 * midpoint of first run       */
+    long long b = a + n1 + n2;          /* 2 * midpoint of second run      */
+    int power = 0;
+    for (;;) {
+        power++;
+        if (a >= n) {
+            a -= n;
+            b -= n;
+        } else if (b >= n) {
+            break;
+        }
+        a <<= 1;
+        b <<= 1;
+    }
+    return power;
+}
+
+/*
+ * tim sort function based on pointer, which is adaptive and stable.
+ *
+ * input is split into natural runs, ascending ones are kept and strictly
+ * descending ones are reversed, a run shorter than min run is extended by
+ * binary insertion. runs are merged in order of powersort, which keeps the
+ * merge tree balanced, and merging gallops over long stretches taken from
+ * one run.
+ *
+ * best    case: O(n), e.g. sorted, reversed, or few sorted batches
+ * worst   case: O(n * log n)
+ * average case: O(n * log n)
+ * space complexity: O(n / 2)
  *
  * @param arr is an allocated array of pointers to opaque type data.
  * @param n   is number of elements in the array.
  * @param cmp is a pointer to a function comparing elements.
  */
 
-void shell_sort_p(void **arr, int n,
-                  int(*cmp)(const void *, const void *)) {
+void tim_sort_p(void **arr, int n,
+                int(*cmp)(const void *, const void *)) {
+    TsState ts;
+    int     min_run;
 
-    int k = 0, *gap = NULL;
-    k = gen_gap_p(&gap, n);
-    if (k < 0) {
+    if (n < TS_MIN_MERGE) {
+        ts_bin_insert(arr, 0, n < 2 ? n : ts_count_run(arr, 0, n, cmp), n,
+                      cmp);
+        return;
+    }
+    ts.tmp = (void **)malloc(sizeof(void *) * (n / 2 + 1));
+    if (ts.tmp == NULL) {
         fprintf(stderr, "ERROE allocating memory\n");
         return;
     }
-    for (int t = k - 1; t >= 0; t--) {
-        int inc = gap[t];
-        for (int i = inc, j; i < n; i++) {
-            void *temp = arr[i];
-            for (j = i - inc; j >= 0 && cmp(arr[j], temp) > 0; j -= inc)
-                arr[j + inc] = arr[j];
-            arr[j + inc] = temp;
+    ts.arr        = arr;
+    ts.n          = n;
+    ts.min_gallop = TS_MIN_GALLOP;
+    ts.nb_run     = 0;
+    ts.cmp        = cmp;
+    min_run       = ts_min_run(n);
+
+    for (int begin = 0, len; begin < n; begin += len) {
+        len = ts_count_run(arr, begin, n, cmp);
+        if (len < min_run) {
+            int force = n - begin < min_run ? n - begin : min_run;
+            ts_bin_insert(arr, begin, begin + len, begin + force, cmp);
+            len = force;
+        }
+        /* merge runs whose node is deeper than the new node */
+        if (ts.nb_run > 0) {
+            int top   = ts.nb_run - 1;
+            int power = ts_power(ts.run[top].begin, ts.run[top].len, len, n);
+            while (ts.nb_run > 1 && ts.run[ts.nb_run - 2].power > power)
+                ts_merge_at(&ts, ts.nb_run - 2);
+            ts.run[ts.nb_run - 1].power = power;
         }
+        ts.run[ts.nb_run].begin = begin;
+        ts.run[ts.nb_run].len   = len;
+        ts.nb_run++;
     }
-    free(gap);
+    while (ts.nb_run > 1)
+        ts_merge_at(&ts, ts.nb_run - 2);
+    free(ts.tmp);
 }
 
 /******************************************************************************/
-/* BFPRT                                                                      */
+/* Floyd-Rivest selection                                                     */
 /******************************************************************************/
 
+#define FR_SAMPLE_MIN 600       /* fewer elements are not sampled          */
+#define FR_WORK       4         /* elements partitioned per element of set */
+#define PSC_HEAP_DIV  16        /* k <= n / 16 is copied by a heap         */
+
 /*
- * select pivot that is middle of middle.
+ * place k-th element of range [left, right] at index k by Floyd-Rivest
+ * algorithm.
+ *
+ * a range of more than FR_SAMPLE_MIN elements first selects in a sample of
+ * about n ^ (2 / 3) elements around k, so the pivot is very close to k-th
+ * and one partition removes most of the range. partitioning stops on keys
+ * equal to pivot, so duplicates do not degrade it.
  *
- * 1. partition set into multiple groups, every group has 5 elements.
- * 2. select middles of every group, make them form a new set.
- * 3. 1. ~ 2. ~ 1. ~ 2. ~
+ * every partition, of the range or of a sample, charges its size to work,
+ * which starts at FR_WORK * n. so at most O(n) elements are partitioned
+ * before the rest is selected by 'BFPRT_k_idx_p()', whatever the input.
  *
  * @param arr   is an allocated array of pointers to opaque type data.
- * @param begin is left index of array.
- * @param end   is right index of array.
+ * @param left  is left index of range.
+ * @param right is right index (included) of range.
+ * @param k     is target index.
+ * @param work  is the number of elements which can be partitioned still,
+ *              shared by recursion into samples.
  * @param cmp   is a pointer to a function comparing elements.
- *
- * @return index of pivot.
  */
 
-int BFPRT_p_idx_p(void **arr, int begin, int end,
-                  int(*cmp)(const void *, const void *)) {
-    if (end - begin < 5) {
-        insert_sort_p(arr, end - begin, cmp);
-        return begin + ((end - begin + 1) >> 1) - 1;
-    }
-    int left_idx = begin;
-    for (int i = begin, med_idx; i + 4 < end; i += 5) {
-        insert_sort_p(arr + i, 5, cmp);
-        med_idx = i + ((5 + 1) >> 1) - 1;
-        SWAP_PTR(arr[left_idx], arr[med_idx]);
-        left_idx++;
+static void fr_select_p(void **arr, int left, int right, int k,
+                        int64_t *work,
+                        int(*cmp)(const void *, const void *)) {
+    while (right > left) {
+        void *pivot;
+        int   i, j;
+        if (*work < right - left + 1) {
+            BFPRT_k_idx_p(arr, left, right + 1, k - left + 1, cmp);
+            return;
+        }
+        *work -= right - left + 1;
+        if (right - left > FR_SAMPLE_MIN) {
+            double n  = right - left + 1;
+            double m  = k - left + 1;
+            double z  = log(n);
+            double s  = 0.5 * exp(2 * z / 3);
+            double sd = 0.5 * sqrt(z * s * (n - s) / n) * (m < n / 2 ? -1 : 1);
+            int    l  = (int)(k - m * s / n + sd);
+            int    r  = (int)(k + (n - m) * s / n + sd);
+            fr_select_p(arr, l > left ? l : left, r < right ? r : right, k,
+                        work, cmp);
+        }
+        pivot = arr[k];
+        i = left;
+        j = right;
+        SWAP_PTR(arr[left], arr[k]);
+        if (cmp(arr[right], pivot) > 0)
+            SWAP_PTR(arr[right], arr[left]);
+        while (i < j) {
+            SWAP_PTR(arr[i], arr[j]);
+            i++;
+            j--;
+            while (cmp(arr[i], pivot) < 0)
+                i++;
+            while (cmp(arr[j], pivot) > 0)
+                j--;
+        }
+        if (cmp(arr[left], pivot) == 0) {
+            SWAP_PTR(arr[left], arr[j]);
+        } else {
+            j++;
+            SWAP_PTR(arr[j], arr[right]);
+        }
+        if (j <= k)
+            left = j + 1;
+        if (k <= j)
+            right = j - 1;
     }
-    return BFPRT_k_idx_p(arr, begin, left_idx, 
-                         (left_idx - begin + 1) >> 1, cmp);
 }
 
 /*
- * partition elements depending on pivot value;
+ * select the k-th element as std::nth_element does, using Floyd-Rivest
+ * algorithm, which falls back to BFPRT algorithm once FR_WORK * n elements
+ * have been partitioned.
+ *
+ * after selecting, elements before k-th are not more than it, and elements
+ * after it are not less than it.
  *
- * some values less than pivot value and their indexes less than pivot index.
- * other values more than pivot value and their indexes more than pivot index.
+ * worst   case: O(n)
+ * average case: n + min(k, n - k) + o(n) comparisons
  *
- * @param arr       is an allocated array of pointers to opaque type data.
- * @param begin     is left index of array.
- * @param end       is right index of array.
- * @param pivot_idx is index of pivot value.
- * @param cmp       is a pointer to a function comparing elements.
+ * @param arr   is an allocated array of pointers to opaque type data.
+ * @param begin is the first index of array.
+ * @param end   is the last index (excluded) of array.
+ * @param k     is target top number, from 1 to end - begin.
+ * @param cmp   is a pointer to a function comparing elements.
  *
- * @return index of pivot value after partitioning.
+ * @return index of k-th element (begin + k - 1), or -1 if k is out of range.
  */
 
-int partition_p(void **arr, int begin,
-                int end, int pivot_idx,
-                int(*cmp)(const void *, const void *)) {
-    int left_idx = begin;
-    SWAP_PTR(arr[pivot_idx], arr[end - 1]);
-    for (int i = begin; i < end - 1; i++) {
-        if (cmp(arr[i], arr[end - 1]) < 0) {
-            SWAP_PTR(arr[i], arr[left_idx]);
-            left_idx++;
-        }
-    }
-    SWAP_PTR(arr[left_idx], arr[end - 1]);
-    return left_idx;
+int nth_element_p(void **arr, int begin, int end, int k,
+                  int(*cmp)(const void *, const void *)) {
+    int64_t work = (int64_t)FR_WORK * (end - begin);
+    if (k < 1 || k > end - begin)
+        return -1;
+    fr_select_p(arr, begin, end - 1, begin + k - 1, &work, cmp);
+    return begin + k - 1;
 }
 
 /*
- * select index of the k-th element using BFPRT algorithm.
+ * sort the k smallest elements into range [begin, begin + k) as
+ * std::partial_sort does, the order of the rest is unspecified.
  *
- * worst case: O(n)
+ * time complexity: O(n + k * log k)
  *
  * @param arr   is an allocated array of pointers to opaque type data.
- * @param begin is left index of array.
- * @param end   is right index of array.
- * @param k     is target top number.
+ * @param begin is the first index of array.
+ * @param end   is the last index (excluded) of array.
+ * @param k     is the number of elements to sort, it is cut to end - begin.
  * @param cmp   is a pointer to a function comparing elements.
+ */
+
+void partial_sort_p(void **arr, int begin, int end, int k,
+                    int(*cmp)(const void *, const void *)) {
+    if (k > end - begin)
+        k = end - begin;
+    if (k < 1)
+        return;
+    if (k < end - begin) {
+        /* k-th is in place, elements before it are not more than it */
+        nth_element_p(arr, begin, end, k, cmp);
+        intro_sort_p(arr, begin, begin + k - 1, cmp);
+    } else {
+        intro_sort_p(arr, begin, end, cmp);
+    }
+}
+
+/*
+ * copy the k smallest elements of set into out in sorted order as
+ * std::partial_sort_copy does, set is not changed.
+ *
+ * a small k is selected by a heap in out without extra memory, otherwise
+ * set is copied to a scratch array and selected by 'nth_element_p()'.
+ *
+ * time  complexity: O(n * log k) for k <= n / PSC_HEAP_DIV, otherwise
+ *                   O(n + k * log k)
+ * space complexity: O(1) or O(n)
  *
- * @return index of k-th element.
+ * @param set is an input allocated set.
+ * @param n   is the number of elements of input set.
+ * @param out is an allocated array of at least k pointers.
+ * @param k   is the max number of elements to copy.
+ * @param cmp is a pointer to a function comparing elements.
+ *
+ * @return number of elements in out (min(n, k), 0 if n or k is 0) on
+ *         success, otherwise -1 (n or k is negative, or out of memory).
+ */
+
+int partial_sort_copy_p(void **set, int n, void **out, int k,
+                        int(*cmp)(const void *, const void *)) {
+    if (n < 0 || k < 0)
+        return -1;
+    if (k > n)
+        k = n;
+    if (k == 0)
+        return 0;
+    if (k <= n / PSC_HEAP_DIV) {
+        memcpy(out, set, sizeof(void *) * k);
+        heap_build_p(out, k, cmp);
+        for (int i = k; i < n; i++)
+            if (cmp(set[i], out[0]) < 0)
+                heap_repl_p(out, set[i], k, cmp);
+        heap_sort_p(out, k, cmp);
+    } else {
+        void **tmp = (void **)malloc(sizeof(void *) * n);
+        if (tmp == NULL) {
+            fprintf(stderr, "ERROE allocating memory\n");
+            return -1;
+        }
+        memcpy(tmp, set, sizeof(void *) * n);
+        partial_sort_p(tmp, 0, n, k, cmp);
+        memcpy(out, tmp, sizeof(void *) * k);
+        free(tmp);
+    }
+    return k;
+}
+
+
+/******************************************************************************/
+/* sort based on value                                                        */
+/******************************************************************************/
+
+/*
+ * the following static functions are cores of value based sort, they are
+ * always inlined into callers, so that if 's' is a constant (4, 8 or 16
+ * bytes, see 'call_by_size()'), every memcpy() of one element is compiled
+ * to register load and store.
+ */
+
+#define V_INLINE static inline __attribute__((always_inline))
+
+#define V_CUTOFF 16
+
+/*
+ * swap s byte memory pointed by pointer p1 and p2.
+ */
+
+V_INLINE void swap_elem(void *p1, void *p2, size_t s) {
+    unsigned char t[16];
+    STAT_SWAP();
+    if (s <= sizeof(t)) {
+        memcpy(t, p1, s);
+        memcpy(p1, p2, s);
+        memcpy(p2, t, s);
+        return;
+    }
+    for (size_t o = 0, m; o < s; o += m) {
+        m = s - o < sizeof(t) ? s - o : sizeof(t);
+        memcpy(t, p1 + o, m);
+        memcpy(p1 + o, p2 + o, m);
+        memcpy(p2 + o, t, m);
+    }
+}
+
+/*
+ * insert sort core based on value, 'tmp' is s byte memory.
+ */
+
+V_INLINE void i_sort(void *arr, int n, size_t s, void *tmp,
+                     int(*cmp)(const void *, const void *)) {
+    for (int i = 1, j; i < n; i++) {
+        if (cmp(arr + (i - 1) * s, arr + i * s) <= 0)
+            continue;
+        memcpy(tmp, arr + i * s, s);
+        for (j = i - 1; j >= 0 && cmp(arr + j * s, tmp) > 0; j--)
+            memcpy(arr + (j + 1) * s, arr + j * s, s);
+        memcpy(arr + (j + 1) * s, tmp, s);
+        STAT_MOVE(i - j);
+    }
+}
+
+/*
+ * sift down the i-th element of a big top heap with n elements, the element
+ * is moved as a hole instead of swapping on every level.
+ */
+
+V_INLINE void sift_down(void *arr, int i, int n, size_t s, void *tmp,
+                        int(*cmp)(const void *, const void *)) {
+    int nb = 1;
+    memcpy(tmp, arr + i * s, s);
+    for (int c = 2 * i + 1; c < n; i = c, c = 2 * i + 1, nb++) {
+        if (c + 1 < n && cmp(arr + c * s, arr + (c + 1) * s) < 0)
+            c++;
+        if (cmp(arr + c * s, tmp) <= 0)
+            break;
+        memcpy(arr + i * s, arr + c * s, s);
+    }
+    memcpy(arr + i * s, tmp, s);
+    STAT_MOVE(nb);
+}
+
+/*
+ * heap sort core based on value.
+ */
+
+V_INLINE void h_sort(void *arr, int n, size_t s, void *tmp,
+                     int(*cmp)(const void *, const void *)) {
+    for (int i = n / 2 - 1; i >= 0; i--)
+        sift_down(arr, i, n, s, tmp, cmp);
+    for (int i = n - 1; i > 0; i--) {
+        swap_elem(arr, arr + i * s, s);
+        sift_down(arr, 0, i, s, tmp, cmp);
+    }
+}
+
+/*
+ * return index of the middle value of arr[i], arr[j] and arr[k].
  */
 
-int BFPRT_k_idx_p(void **arr, int begin, int end, int k,
+V_INLINE int med3(void *arr, int i, int j, int k, size_t s,
                   int(*cmp)(const void *, const void *)) {
-    if (end - begin < 2) return begin;
-    int pivot_idx = BFPRT_p_idx_p(arr, begin, end, cmp);
-    int ptn_idx = partition_p(arr, begin, end, pivot_idx, cmp);
-    int num = ptn_idx - begin + 1;
-    if (k == num) 
-        return ptn_idx;
-    else if (k < num)
-        return BFPRT_k_idx_p(arr, begin, ptn_idx, k, cmp);
-    else
-        return BFPRT_k_idx_p(arr, ptn_idx + 1, end, k - num, cmp);
+    return cmp(arr + i * s, arr + j * s) < 0 ?
+           (cmp(arr + j * s, arr + k * s) < 0 ? j :
+            (cmp(arr + i * s, arr + k * s) < 0 ? k : i)) :
+           (cmp(arr + j * s, arr + k * s) > 0 ? j :
+            (cmp(arr + i * s, arr + k * s) > 0 ? k : i));
 }
 
+/*
+ * quick sort core based on value.
+ *
+ * pivot is median of 3 (ninther for more than 128 elements), the smaller
+ * side is sorted first and the larger one is pushed on an explicit stack,
+ * small ranges are insert sorted and a range falls back to heap sort when
+ * it has been partitioned more than 2 * log2(n) times.
+ */
+
+V_INLINE void q_sort(void *arr, int n, size_t s, void *tmp,
+                     int(*cmp)(const void *, const void *)) {
+    int stack[3 * 64], top = 0;
+    int depth = 0;
+    for (int m = n; m > 1; m >>= 1)
+        depth += 2;
+    stack[top++] = 0;
+    stack[top++] = n;
+    stack[top++] = depth;
+    while (top > 0) {
+        depth   = stack[--top];
+        int end = stack[--top];
+        int lo  = stack[--top];
+        while (end - lo > V_CUTOFF) {
+            if (depth-- == 0) {
+                h_sort(arr + lo * s, end - lo, s, tmp, cmp);
+                lo = end;
+                break;
+            }
+            int hi  = end - 1;
+            int mid = lo + ((end - lo) >> 1);
+            if (end - lo > 128) {
+                int d = (end - lo) >> 3;
+                mid = med3(arr, med3(arr, lo, lo + d, lo + 2 * d, s, cmp),
+                                med3(arr, mid - d, mid, mid + d, s, cmp),
+                                med3(arr, hi - 2 * d, hi - d, hi, s, cmp),
+                                s, cmp);
+            } else
+                mid = med3(arr, lo, mid, hi, s, cmp);
+            swap_elem(arr + lo * s, arr + mid * s, s);
+            int i = lo, j = end;
+            for (;;) {
+                while (++i < hi && cmp(arr + i * s, arr + lo * s) < 0);
+                while (cmp(arr + lo * s, arr + (--j) * s) < 0);
+                if (i >= j)
+                    break;
+                swap_elem(arr + i * s, arr + j * s, s);
+            }
+            swap_elem(arr + lo * s, arr + j * s, s);
+            if (j - lo < end - j - 1) {
+                stack[top++] = j + 1;
+                stack[top++] = end;
+                stack[top++] = depth;
+                end = j;
+            } else {
+                stack[top++] = lo;
+                stack[top++] = j;
+                stack[top++] = depth;
+                lo = j + 1;
+            }
+        }
+        i_sort(arr + lo * s, end - lo, s, tmp, cmp);
+    }
+}
+
+/*
+ * merge sort core based on value.
+ *
+ * runs of V_CUTOFF elements are insert sorted, then runs are merged bottom
+ * up between arr and buf, buf is an allocated n * s bytes memory. the
+ * left element is taken when two elements are equal, so it is stable.
+ */
+
+V_INLINE void m_sort(void *arr, void *buf, int n, size_t s, void *tmp,
+                     int(*cmp)(const void *, const void *)) {
+    void *src = arr, *dst = buf, *t = NULL;
+    for (int i = 0; i < n; i += V_CUTOFF)
+        i_sort(arr + i * s, n - i < V_CUTOFF ? n - i : V_CUTOFF, s, tmp, cmp);
+    for (int w = V_CUTOFF; w < n; w *= 2) {
+        for (int begin = 0; begin < n; begin += 2 * w) {
+            int med = begin + w < n ? begin + w : n;
+            int end = begin + 2 * w < n ? begin + 2 * w : n;
+            int idx = begin, i = begin, j = med;
+            while (i < med && j < end) {
+                if (cmp(src + i * s, src + j * s) <= 0)
+                    memcpy(dst + (idx++) * s, src + (i++) * s, s);
+                else
+                    memcpy(dst + (idx++) * s, src + (j++) * s, s);
+            }
+            memcpy(dst + idx * s, src + i * s, (med - i) * s);
+            idx += med - i;
+            memcpy(dst + idx * s, src + j * s, (end - j) * s);
+            STAT_MOVE(end - begin);
+        }
+        t = src, src = dst, dst = t;
+    }
+    if (src != arr) {
+        memcpy(arr, src, n * s);
+        STAT_MOVE(n);
+    }
+}
+
+/*
+ * shell sort core based on value, gaps are got by 'gen_gap_buf()'.
+ */
+
+V_INLINE void s_sort(void *arr, int n, size_t s, void *tmp,
+                     int(*cmp)(const void *, const void *)) {
+    int gap[GAP_MAX], k = gen_gap_buf(gap, n);
+    for (int t = k - 1; t >= 0; t--) {
+        int inc = gap[t];
+        for (int i = inc, j; i < n; i++) {
+            memcpy(tmp, arr + i * s, s);
+            for (j = i - inc; j >= 0 && cmp(arr + j * s, tmp) > 0; j -= inc)
+                memcpy(arr + (j + inc) * s, arr + j * s, s);
+            memcpy(arr + (j + inc) * s, tmp, s);
+            STAT_MOVE((i - j) / inc);
+        }
+    }
+}
+
+/*
+ * the following functions are specialized for 4, 8 and 16 bytes elements
+ * and a generic size.
+ */
+
+static void q_sort_4(void *arr, int n, size_t s, void *tmp,
+                     int(*cmp)(const void *, const void *)) {
+    (void)s;
+    q_sort(arr, n, 4, tmp, cmp);
+}
+
+static void q_sort_8(void *arr, int n, size_t s, void *tmp,
+                     int(*cmp)(const void *, const void *)) {
+    (void)s;
+    q_sort(arr, n, 8, tmp, cmp);
+}
+
+static void q_sort_16(void *arr, int n, size_t s, void *tmp,
+                      int(*cmp)(const void *, const void *)) {
+    (void)s;
+    q_sort(arr, n, 16, tmp, cmp);
+}
+
+static void q_sort_s(void *arr, int n, size_t s, void *tmp,
+                     int(*cmp)(const void *, const void *)) {
+    q_sort(arr, n, s, tmp, cmp);
+}
+
+static void h_sort_4(void *arr, int n, size_t s, void *tmp,
+                     int(*cmp)(const void *, const void *)) {
+    (void)s;
+    h_sort(arr, n, 4, tmp, cmp);
+}
+
+static void h_sort_8(void *arr, int n, size_t s, void *tmp,
+                     int(*cmp)(const void *, const void *)) {
+    (void)s;
+    h_sort(arr, n, 8, tmp, cmp);
+}
+
+static void h_sort_16(void *arr, int n, size_t s, void *tmp,
+                      int(*cmp)(const void *, const void *)) {
+    (void)s;
+    h_sort(arr, n, 16, tmp, cmp);
+}
+
+static void h_sort_s(void *arr, int n, size_t s, void *tmp,
+                     int(*cmp)(const void *, const void *)) {
+    h_sort(arr, n, s, tmp, cmp);
+}
+
+static void s_sort_4(void *arr, int n, size_t s, void *tmp,
+                     int(*cmp)(const void *, const void *)) {
+    (void)s;
+    s_sort(arr, n, 4, tmp, cmp);
+}
+
+static void s_sort_8(void *arr, int n, size_t s, void *tmp,
+                     int(*cmp)(const void *, const void *)) {
+    (void)s;
+    s_sort(arr, n, 8, tmp, cmp);
+}
+
+static void s_sort_16(void *arr, int n, size_t s, void *tmp,
+                      int(*cmp)(const void *, const void *)) {
+    (void)s;
+    s_sort(arr, n, 16, tmp, cmp);
+}
+
+static void s_sort_s(void *arr, int n, size_t s, void *tmp,
+                     int(*cmp)(const void *, const void *)) {
+    s_sort(arr, n, s, tmp, cmp);
+}
+
+/*
+ * call one of the specialized functions depending on element size, 'tmp'
+ * is a s byte memory allocated on stack or heap.
+ *
+ * @return 0 on success, otherwise -1.
+ */
+
+static int call_by_size(void(*f4)(void *, int, size_t, void *,
+                                  int(*)(const void *, const void *)),
+                        void(*f8)(void *, int, size_t, void *,
+                                  int(*)(const void *, const void *)),
+                        void(*f16)(void *, int, size_t, void *,
+                                   int(*)(const void *, const void *)),
+                        void(*fs)(void *, int, size_t, void *,
+                                  int(*)(const void *, const void *)),
+                        void *arr, int n, size_t s,
+                        int(*cmp)(const void *, const void *)) {
+    unsigned char buf[16];
+    void *tmp = buf;
+    if (s == 4)  { f4(arr, n, s, tmp, cmp);  return 0; }
+    if (s == 8)  { f8(arr, n, s, tmp, cmp);  return 0; }
+    if (s == 16) { f16(arr, n, s, tmp, cmp); return 0; }
+    if (s > sizeof(buf) && (tmp = malloc(s)) == NULL)
+        return -1;
+    fs(arr, n, s, tmp, cmp);
+    if (tmp != buf)
+        free(tmp);
+    return 0;
+}
+
+/*
+ * quick sort function based on value.
+ *
+ * best    case: O(n * log n)
+ * worst   case: O(n * log n)
+ * average case: O(n * log n)
+ *
+ * @param arr is a an allocated array of opaque type data.
+ * @param n   is number of elements in the array.
+ * @param s   is size of target element bytes.
+ * @param cmp is a pointer to a function comparing elements.
+ */
+
+void quick_sort(void *arr, int n, size_t s,
+                int(*cmp)(const void *, const void *)) {
+    if (call_by_size(q_sort_4, q_sort_8, q_sort_16, q_sort_s,
+                     arr, n, s, cmp) < 0)
+        fprintf(stderr, "ERROE allocating memory\n");
+}
+
+/*
+ * heap sort function based on value.
+ *
+ * best    case: O(n * log n)
+ * worst   case: O(n * log n)
+ * average case: O(n * log n)
+ *
+ * @param arr is a an allocated array of opaque type data.
+ * @param n   is number of elements in the array.
+ * @param s   is size of target element bytes.
+ * @param cmp is a pointer to a function comparing elements.
+ */
+
+void heap_sort(void *arr, int n, size_t s,
+               int(*cmp)(const void *, const void *)) {
+    if (call_by_size(h_sort_4, h_sort_8, h_sort_16, h_sort_s,
+                     arr, n, s, cmp) < 0)
+        fprintf(stderr, "ERROE allocating memory\n");
+}
+
+/*
+ * merge sort function based on value, it is stable.
+ *
+ * time  complexity: O(n * log n)
+ * space complexity: O(n)
+ *
+ * @param arr is a an allocated array of opaque type data.
+ * @param n   is number of elements in the array.
+ * @param s   is size of target element bytes.
+ * @param cmp is a pointer to a function comparing elements.
+ */
+
+void merge_sort(void *arr, int n, size_t s,
+                int(*cmp)(const void *, const void *)) {
+    unsigned char buf[16];
+    void *tmp = buf, *copy = NULL;
+    if (n <= 1)
+        return;
+    copy = malloc(n * s);
+    if (copy == NULL || (s > sizeof(buf) && (tmp = malloc(s)) == NULL)) {
+        fprintf(stderr, "ERROE allocating memory\n");
+        free(copy);
+        return;
+    }
+    if (s == 4)
+        m_sort(arr, copy, n, 4, tmp, cmp);
+    else if (s == 8)
+        m_sort(arr, copy, n, 8, tmp, cmp);
+    else if (s == 16)
+        m_sort(arr, copy, n, 16, tmp, cmp);
+    else
+        m_sort(arr, copy, n, s, tmp, cmp);
+    if (tmp != buf)
+        free(tmp);
+    free(copy);
+}
+
+/*
+ * shell sort function based on value.
+ *
+ * best    case:   O(n)
+ * worst   case:   ?
+ * average case:   ?
+ *
+ * @param arr is a an allocated array of opaque type data.
+ * @param n   is number of elements in the array.
+ * @param s   is size of target element bytes.
+ * @param cmp is a pointer to a function comparing elements.
+ */
+
+void shell_sort(void *arr, int n, size_t s,
+                int(*cmp)(const void *, const void *)) {
+    if (call_by_size(s_sort_4, s_sort_8, s_sort_16, s_sort_s,
+                     arr, n, s, cmp) < 0)
+        fprintf(stderr, "ERROE allocating memory\n");
+}
+
+/******************************************************************************/
+/* radix sort                                                                 */
+/******************************************************************************/
+
+/*
+ * LSD radix sort with 11 bits digit, every element is moved from a source
+ * array to a destination array on one pass and two arrays are swapped for
+ * the next pass (ping-pong buffer).
+ *
+ * the key of an element is an unsigned integer whose order is the order of
+ * elements, so 'double' keys are flipped: negative numbers flip all bits and
+ * positive numbers flip the sign bit only. -0.0 is ordered before +0.0.
+ */
+
+#define RDX_BITS    11
+#define RDX_SIZE    (1 << RDX_BITS)
+#define RDX_MASK    (RDX_SIZE - 1)
+
+#define SIGN_32     0x80000000U
+#define SIGN_64     0x8000000000000000ULL
+
+#define FLIP_U32(x) (x)
+#define FLIP_I32(x) ((x) ^ SIGN_32)
+#define FLIP_FLT(x) ((x) ^ (-((x) >> 31) | SIGN_32))
+#define FLIP_U64(x) (x)
+#define FLIP_I64(x) ((x) ^ SIGN_64)
+#define FLIP_DBL(x) ((x) ^ (-((x) >> 63) | SIGN_64))
+#define KEY_OF_KP(x) ((x).key)
+
+/* integer types that may alias 'float', 'double' and signed integers */
+
+typedef uint32_t rdx_u32_t __attribute__((__may_alias__));
+typedef uint64_t rdx_u64_t __attribute__((__may_alias__));
+
+/* a pair of key and pointer */
+
+typedef struct key_ptr {
+    uint64_t key;
+    void    *ptr;
+} KeyPtr;
+
+/*
+ * define a function 'name(type *arr, type *buf, int n)', which sorts arr by
+ * nb_pass digits of key KEY(x), buf is an allocated array of n elements.
+ * it returns arr or buf, in which the sorted elements are. a pass is skipped
+ * if every key has the same digit.
+ */
+
+#define DEF_RDX_SORT(name, type, KEY, nb_pass)                                 \
+static type *name(type *arr, type *buf, int n) {                               \
+    uint32_t cnt[nb_pass][RDX_SIZE];                                           \
+    type *src = arr, *dst = buf, *t = NULL;                                    \
+    memset(cnt, 0, sizeof(cnt));                                               \
+    for (int i = 0; i < n; i++) {                                              \
+        uint64_t k = KEY(arr[i]);                                              \
+        for (int p = 0; p < nb_pass; p++)                                      \
+            cnt[p][(k >> (p * RDX_BITS)) & RDX_MASK]++;                        \
+    }                                                                          \
+    for (int p = 0; p < nb_pass; p++) {                                        \
+        int shift = p * RDX_BITS;                                              \
+        if (cnt[p][(KEY(src[0]) >> shift) & RDX_MASK] == (uint32_t)n)          \
+            continue;                                                          \
+        for (uint32_t d = 0, sum = 0, c; d < RDX_SIZE; d++) {                  \
+            c = cnt[p][d];                                                     \
+            cnt[p][d] = sum;                                                   \
+            sum += c;                                                          \
+        }                                                                      \
+        for (int i = 0; i < n; i++)                                            \
+            dst[cnt[p][(KEY(src[i]) >> shift) & RDX_MASK]++] = src[i];         \
+        STAT_MOVE(n);                                                          \
+        t = src, src = dst, dst = t;                                           \
+    }                                                                          \
+    return src;                                                                \
+}
+
+DEF_RDX_SORT(rdx_sort_u32, rdx_u32_t, FLIP_U32, 3)
+DEF_RDX_SORT(rdx_sort_i32, rdx_u32_t, FLIP_I32, 3)
+DEF_RDX_SORT(rdx_sort_flt, rdx_u32_t, FLIP_FLT, 3)
+DEF_RDX_SORT(rdx_sort_u64, rdx_u64_t, FLIP_U64, 6)
+DEF_RDX_SORT(rdx_sort_i64, rdx_u64_t, FLIP_I64, 6)
+DEF_RDX_SORT(rdx_sort_dbl, rdx_u64_t, FLIP_DBL, 6)
+DEF_RDX_SORT(rdx_sort_kp,  KeyPtr,    KEY_OF_KP, 6)
+
+/*
+ * define a value based radix sort function 'name(type *arr, int n)', it
+ * calls 'rdx_name()' with an allocated buffer.
+ */
+
+#define DEF_RADIX_SORT(name, type, rdx_name, rdx_type)                         \
+void name(type *arr, int n) {                                                  \
+    rdx_type *buf = NULL, *res = NULL;                                         \
+    if (n <= 1)                                                                \
+        return;                                                                \
+    buf = (rdx_type *)malloc(sizeof(rdx_type) * n);                            \
+    if (buf == NULL) {                                                         \
+        fprintf(stderr, "ERROE allocating memory\n");                          \
+        return;                                                                \
+    }                                                                          \
+    res = rdx_name((rdx_type *)arr, buf, n);                                   \
+    if (res != (rdx_type *)arr) {                                              \
+        memcpy(arr, res, sizeof(rdx_type) * n);                                \
+        STAT_MOVE(n);                                                          \
+    }                                                                          \
+    free(buf);                                                                 \
+}
+
+/*
+ * radix sort functions based on value.
+ *
+ * time  complexity: O(n * w / 11), w is bits of element
+ * space complexity: O(n)
+ *
+ * @param arr is an allocated array of integer or floating point type data.
+ * @param n   is number of elements in the array.
+ */
+
+DEF_RADIX_SORT(radix_sort_u32, uint32_t, rdx_sort_u32, rdx_u32_t)
+DEF_RADIX_SORT(radix_sort_i32, int32_t,  rdx_sort_i32, rdx_u32_t)
+DEF_RADIX_SORT(radix_sort_flt, float,    rdx_sort_flt, rdx_u32_t)
+DEF_RADIX_SORT(radix_sort_u64, uint64_t, rdx_sort_u64, rdx_u64_t)
+DEF_RADIX_SORT(radix_sort_i64, int64_t,  rdx_sort_i64, rdx_u64_t)
+DEF_RADIX_SORT(radix_sort_dbl, double,   rdx_sort_dbl, rdx_u64_t)
+
+/*
+ * key function for double floating point type data.
+ *
+ * @return an unsigned integer, whose order is the order of 'cmp_dbl()'.
+ */
+
+uint64_t key_dbl(const void *ptr) {
+    uint64_t x;
+    memcpy(&x, ptr, sizeof(x));
+    return FLIP_DBL(x);
+}
+
+/*
+ * key function for signed 64 bits integer type data.
+ *
+ * @return an unsigned integer, whose order is the order of signed integer.
+ */
+
+uint64_t key_i64(const void *ptr) {
+    uint64_t x;
+    memcpy(&x, ptr, sizeof(x));
+    return FLIP_I64(x);
+}
+
+/*
+ * key function for unsigned 64 bits integer type data.
+ *
+ * @return the integer itself.
+ */
+
+uint64_t key_u64(const void *ptr) {
+    return *(const uint64_t *)ptr;
+}
+
+/*
+ * radix sort function based on pointer.
+ *
+ * a key is extracted once for every element, then pairs of key and pointer
+ * are sorted. it is stable.
+ *
+ * time  complexity: O(n)
+ * space complexity: O(n)
+ *
+ * @param arr is an allocated array of pointers to opaque type data.
+ * @param n   is number of elements in the array.
+ * @param key is a pointer to a function getting an unsigned integer key,
+ *            such as 'key_dbl()'.
+ */
+
+void radix_sort_p(void **arr, int n, uint64_t(*key)(const void *)) {
+    KeyPtr *kp = NULL, *res = NULL;
+    if (n <= 1)
+        return;
+    kp = (KeyPtr *)malloc(sizeof(KeyPtr) * n * 2);
+    if (kp == NULL) {
+        fprintf(stderr, "ERROE allocating memory\n");
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        kp[i].key = key(arr[i]);
+        kp[i].ptr = arr[i];
+    }
+    res = rdx_sort_kp(kp, kp + n, n);
+    for (int i = 0; i < n; i++)
+        arr[i] = res[i].ptr;
+    free(kp);
+}
+
+/******************************************************************************/
+/* key prefix sort                                                            */
+/******************************************************************************/
+
+#define KEY_SORT_MIN 64         /* fewer elements are sorted by 'cmp()'    */
+
+/*
+ * sort function based on pointer with cached key prefixes.
+ *
+ * a fixed width key prefix is extracted once for every element, the pairs
+ * of prefix and pointer are held contiguously and sorted by prefix without
+ * dereferencing any pointer, then runs of equal prefixes are sorted by the
+ * full compare function. so cmp is called only on ties, which suits keys
+ * whose prefix is the whole key or decides almost every pair, e.g. doubles
+ * and 64 bits integers with 'key_dbl()' and 'key_i64()'. it loses to intro
+ * sort if prefixes are often equal, as of strings of a common prefix, which
+ * are sorted by 'str_sort_p()'.
+ *
+ * key must keep the order of cmp: key(a) < key(b) only if cmp(a, b) < 0.
+ * it is stable.
+ *
+ * time  complexity: O(n) + O(t * log t) for every run of t equal prefixes
+ * space complexity: O(n)
+ *
+ * @param arr is an allocated array of pointers to opaque type data.
+ * @param n   is number of elements in the array.
+ * @param key is a pointer to a function getting key prefix of an element,
+ *            such as 'key_dbl()' or 'key_i64()'.
+ * @param cmp is a pointer to a function comparing elements.
+ */
+
+void key_sort_p(void **arr, int n, uint64_t(*key)(const void *),
+                int(*cmp)(const void *, const void *)) {
+    KeyPtr *kp = NULL, *res = NULL;
+    if (n < KEY_SORT_MIN) {
+        tim_sort_p(arr, n, cmp);
+        return;
+    }
+    kp = (KeyPtr *)malloc(sizeof(KeyPtr) * n * 2);
+    if (kp == NULL) {
+        fprintf(stderr, "ERROE allocating memory\n");
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        kp[i].key = key(arr[i]);
+        kp[i].ptr = arr[i];
+    }
+    res = rdx_sort_kp(kp, kp + n, n);
+    for (int i = 0, j; i < n; i = j) {
+        arr[i] = res[i].ptr;
+        for (j = i + 1; j < n && res[j].key == res[i].key; j++)
+            arr[j] = res[j].ptr;
+        if (j - i > 1)
+            tim_sort_p(arr + i, j - i, cmp);
+    }
+    free(kp);
+}
+
+/******************************************************************************/
+/* string sort                                                                */
+/******************************************************************************/
+
+#define STR_CUTOFF  16          /* fewer strings are sorted by insertion   */
+#define STR_PAGE    4096        /* smallest page size of host              */
+#define STR_NINTHER 128         /* fewer strings use median of 3           */
+
+/*
+ * the first 8 bytes of a string as a big endian integer, bytes after the
+ * terminating '\0' are 0. no byte after '\0' is read.
+ *
+ * @return an unsigned integer, whose order is the order of 'strcmp()' on
+ *         the first 8 bytes.
+ */
+
+static inline uint64_t str_key8_c(const unsigned char *str) {
+    uint64_t x = 0;
+    for (int i = 0; i < 8; i++) {
+        x = x << 8 | str[i];
+        if (str[i] == '\0') {
+            x <<= 8 * (7 - i);
+            break;
+        }
+    }
+    return x;
+}
+
+/*
+ * 'str_key8_c()' loading 8 bytes at once.
+ *
+ * on little endian hosts 8 bytes are loaded at once if they are in one page,
+ * which may read bytes after '\0' but never an unmapped page, then bytes from
+ * the first '\0' are cleared. so it is not instrumented by AddressSanitizer,
+ * and is private to string sort instead of a key function to pass around.
+ */
+
+__attribute__((no_sanitize_address))
+static inline uint64_t str_key8(const unsigned char *str) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (((uintptr_t)str & (STR_PAGE - 1)) <= STR_PAGE - 8) {
+        uint64_t x, z;
+        memcpy(&x, str, sizeof(x));
+        /* the lowest flagged byte is the first '\0' */
+        z = (x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL;
+        if (z != 0)
+            x &= (1ULL << (__builtin_ctzll(z) & ~7)) - 1;
+        return __builtin_bswap64(x);
+    }
+#endif
+    return str_key8_c(str);
+}
+
+/*
+ * compare two strings from their d-th characters, whose first d characters
+ * are equal.
+ */
+
+static inline int str_cmp_from(const unsigned char *s1,
+                               const unsigned char *s2) {
+    while (*s1 != '\0' && *s1 == *s2) {
+        s1++;
+        s2++;
+    }
+    return (int)*s1 - (int)*s2;
+}
+
+/*
+ * insertion sort of n strings sharing a prefix of d characters.
+ */
+
+static void str_ins_p(unsigned char **arr, int n, int d) {
+    for (int i = 1, j; i < n; i++) {
+        unsigned char *temp = arr[i];
+        for (j = i; j > 0 && str_cmp_from(arr[j - 1] + d, temp + d) > 0; j--)
+            arr[j] = arr[j - 1];
+        arr[j] = temp;
+        STAT_MOVE(i - j);
+    }
+}
+
+/*
+ * compare two strings sharing a prefix of d characters, by their cached
+ * characters d ~ d + 15 (k0, k1) first.
+ */
+
+static inline int str_cmp_key(uint64_t a0, uint64_t a1, const unsigned char *a,
+                              uint64_t b0, uint64_t b1, const unsigned char *b,
+                              int d) {
+    if (a0 != b0)
+        return a0 < b0 ? -1 : 1;
+    if ((a0 & 0xFF) == 0)
+        return 0;
+    if (a1 != b1)
+        return a1 < b1 ? -1 : 1;
+    if ((a1 & 0xFF) == 0)
+        return 0;
+    return str_cmp_from(a + d + 16, b + d + 16);
+}
+
+/*
+ * insertion sort of n strings sharing a prefix of d characters, with their
+ * cached characters (see 'mkqs_p()'), which are filled if nb is less than 2,
+ * so strings are read only on ties of 16 characters.
+ */
+
+static void str_ins_key_p(unsigned char **arr, uint64_t *c0, uint64_t *c1,
+                          int n, int d, int nb) {
+    for (int i = 0; i < n && nb < 2; i++) {
+        if (nb == 0)
+            c0[i] = str_key8(arr[i] + d);
+        c1[i] = (c0[i] & 0xFF) ? str_key8(arr[i] + d + 8) : 0;
+    }
+    for (int i = 1, j; i < n; i++) {
+        unsigned char *temp = arr[i];
+        uint64_t       t0 = c0[i], t1 = c1[i];
+        for (j = i; j > 0 &&
+             str_cmp_key(c0[j - 1], c1[j - 1], arr[j - 1], t0, t1, temp, d) > 0;
+             j--) {
+            arr[j] = arr[j - 1];
+            c0[j]  = c0[j - 1];
+            c1[j]  = c1[j - 1];
+        }
+        arr[j] = temp;
+        c0[j]  = t0;
+        c1[j]  = t1;
+        STAT_MOVE(i - j);
+    }
+}
+
+/*
+ * @return index of median of cache[a], cache[b] and cache[c].
+ */
+
+static inline int med3_u64(const uint64_t *cache, int a, int b, int c) {
+    if (cache[a] < cache[b])
+        return cache[b] < cache[c] ? b : (cache[a] < cache[c] ? c : a);
+    return cache[a] < cache[c] ? a : (cache[b] < cache[c] ? c : b);
+}
+
+/*
+ * @return 2 * log2(n), the partitions a range of n strings takes before it
+ *         falls back to heap sort.
+ */
+
+static inline int str_depth(int n) {
+    int depth = 0;
+    for (; n > 1; n >>= 1)
+        depth += 2;
+    return depth;
+}
+
+/*
+
+multikey quicksort of n strings sharing a prefix of d characters, 16
+characters from the d-th are cached by 'str_key8()' as 2 integers in c0[i]
+and c1[i] for arr[i], nb is the number of valid integers
+
+partitioning compares c0 in an array instead of chasing pointers, equal
+part goes 8 characters deeper, taking c1 as its c0, so a string is read
+once per 16 characters of depth and a long common prefix is passed quickly
+
+ 0             lt                 gt              n
+ |  c0 < v     |      c0 = v      |    c0 > v     |
+   same d,       d + 8, c1 as c0    same d,
+   same nb       nb - 1             same nb
+   depth - 1     2 * log2(gt - lt)  depth - 1
+
+the largest part is sorted by the loop and the others, of no more than n / 2
+strings, by recursion, so the stack is at most log2(n) frames deep. a range
+partitioned depth times at the same d is sorted by heap sort, going deeper
+into the strings starts a new count
+
+*/
+
+static void mkqs_p(unsigned char **arr, uint64_t *c0, uint64_t *c1, int n,
+                   int d, int nb, int depth) {
+    while (n > STR_CUTOFF) {
+        int       lt = 0, gt = n - 1, p, s = n / 8, n_lt, n_eq, n_gt;
+        uint64_t  v, *t;
+        if (depth-- == 0) {
+            heap_sort_p((void **)arr, n, &cmp_str);
+            return;
+        }
+        if (nb == 0) {
+            for (int i = 0; i < n; i++) {
+                c0[i] = str_key8(arr[i] + d);
+                c1[i] = (c0[i] & 0xFF) ? str_key8(arr[i] + d + 8) : 0;
+            }
+            nb = 2;
+        }
+        if (n < STR_NINTHER)
+            p = med3_u64(c0, 0, n / 2, n - 1);
+        else
+            p = med3_u64(c0, med3_u64(c0, 0, s, 2 * s),
+                             med3_u64(c0, n / 2 - s, n / 2, n / 2 + s),
+                             med3_u64(c0, n - 1 - 2 * s, n - 1 - s, n - 1));
+        v = c0[p];
+        for (int i = 0; i <= gt; ) {
+            if (c0[i] < v) {
+                SWAP_PTR(arr[i], arr[lt]);
+                SWAP(c0[i], c0[lt]);
+                if (nb == 2)
+                    SWAP(c1[i], c1[lt]);
+                lt++;
+                i++;
+            } else if (c0[i] > v) {
+                SWAP_PTR(arr[i], arr[gt]);
+                SWAP(c0[i], c0[gt]);
+                if (nb == 2)
+                    SWAP(c1[i], c1[gt]);
+                gt--;
+            } else {
+                i++;
+            }
+        }
+        n_lt = lt;
+        n_eq = gt - lt + 1;
+        n_gt = n - gt - 1;
+        if ((v & 0xFF) == 0)
+            n_eq = 0;           /* equal strings ended before d + 8 */
+        if (n_eq >= n_lt && n_eq >= n_gt) {
+            mkqs_p(arr, c0, c1, n_lt, d, nb, depth);
+            mkqs_p(arr + gt + 1, c0 + gt + 1, c1 + gt + 1, n_gt, d, nb, depth);
+            arr  += lt;
+            t     = c0 + lt;
+            c0    = c1 + lt;
+            c1    = t;
+            n     = n_eq;
+            d    += 8;
+            depth = str_depth(n_eq);
+            nb--;
+            continue;
+        }
+        if (n_eq > 1)
+            mkqs_p(arr + lt, c1 + lt, c0 + lt, n_eq, d + 8, nb - 1,
+                   str_depth(n_eq));
+        if (n_lt < n_gt) {
+            mkqs_p(arr, c0, c1, n_lt, d, nb, depth);
+            arr += gt + 1;
+            c0  += gt + 1;
+            c1  += gt + 1;
+            n    = n_gt;
+        } else {
+            mkqs_p(arr + gt + 1, c0 + gt + 1, c1 + gt + 1, n_gt, d, nb, depth);
+            n    = n_lt;
+        }
+    }
+    str_ins_key_p(arr, c0, c1, n, d, nb);
+}
+
+/*
+ * string sort function based on pointer, every element is a C string, the
+ * order is the order of 'strcmp()'.
+ *
+ * multikey quicksort (Bentley and Sedgewick) partitions strings three ways
+ * by 8 characters as an integer, so a common prefix is scanned once per
+ * string instead of once per comparison. 16 characters from current depth
+ * are cached in integer arrays, so each string is dereferenced once per 16
+ * characters of depth. few strings are sorted by insertion, and a range
+ * partitioned too often at one depth by heap sort.
+ *
+ * time  complexity: O(n * log n + D / 8), D is total length of
+ *                   distinguishing prefixes
+ * space complexity: O(n), stack of O(log n)
+ *
+ * @param arr is an allocated array of pointers to C strings.
+ * @param n   is number of elements in the array.
+ */
+
+void str_sort_p(void **arr, int n) {
+    uint64_t *cache = NULL;
+    if (n <= STR_CUTOFF) {
+        str_ins_p((unsigned char **)arr, n, 0);
+        return;
+    }
+    cache = (uint64_t *)malloc(sizeof(uint64_t) * n * 2);
+    if (cache == NULL) {
+        fprintf(stderr, "ERROE allocating memory\n");
+        return;
+    }
+    mkqs_p((unsigned char **)arr, cache, cache + n, n, 0, 0, str_depth(n));
+    free(cache);
+}
+
+
+/******************************************************************************/
+/* argsort                                                                    */
+/******************************************************************************/
+
+/*
+ * an argsort writes a permutation 'idx' of 0 .. n - 1, so that
+ * base[idx[0]], base[idx[1]], ... are in order, and leaves data untouched.
+ * indices are 32 bits, 'n' is an 'int' so they never overflow, and half as
+ * many bytes as pointers are moved. 'argsort()' and 'argsort_stable()'
+ * sort indices by templates (see 'sort_tpl.cpp').
+ */
+
+/* a pair of key and index */
+
+typedef struct key_idx {
+    uint64_t key;
+    uint32_t idx;
+} KeyIdx;
+
+/* key of a 32 bits key packed above a 32 bits index */
+
+#define KEY_HI32(x) ((x) >> 32)
+
+DEF_RDX_SORT(rdx_sort_ki,   KeyIdx,   KEY_OF_KP, 6)
+DEF_RDX_SORT(rdx_sort_hi32, uint64_t, KEY_HI32,  3)
+
+/*
+ * argsort function by key, it is stable.
+ *
+ * a key is extracted once for every element, then pairs of key and index
+ * are sorted by radix sort.
+ *
+ * time  complexity: O(n)
+ * space complexity: O(n)
+ *
+ * @param base is an allocated array of opaque type data, it is not changed.
+ * @param n    is number of elements in the array.
+ * @param s    is size of target element bytes.
+ * @param key  is a pointer to a function getting an unsigned integer key,
+ *             such as 'key_dbl()'.
+ * @param idx  is an allocated array of n indices, to get the permutation.
+ */
+
+void argsort_key(const void *base, int n, size_t s,
+                 uint64_t(*key)(const void *), uint32_t *idx) {
+    KeyIdx *ki = NULL, *res = NULL;
+    if (n <= 0)
+        return;
+    ki = (KeyIdx *)malloc(sizeof(KeyIdx) * n * 2);
+    if (ki == NULL) {
+        fprintf(stderr, "ERROE allocating memory\n");
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        ki[i].key = key((const unsigned char *)base + i * s);
+        ki[i].idx = (uint32_t)i;
+    }
+    res = rdx_sort_ki(ki, ki + n, n);
+    for (int i = 0; i < n; i++)
+        idx[i] = res[i].idx;
+    free(ki);
+}
+
+/*
+ * define a stable argsort function 'name(const type *arr, int n,
+ * uint32_t *idx)' of 32 bits type, the flipped key and the index are packed
+ * in one 64 bits integer, and only its high 32 bits are sorted.
+ */
+
+#define DEF_ARGSORT_32(name, type, FLIP)                                       \
+void name(const type *arr, int n, uint32_t *idx) {                             \
+    uint64_t *ki = NULL, *res = NULL;                                          \
+    if (n <= 0)                                                                \
+        return;                                                                \
+    ki = (uint64_t *)malloc(sizeof(uint64_t) * n * 2);                         \
+    if (ki == NULL) {                                                          \
+        fprintf(stderr, "ERROE allocating memory\n");                          \
+        return;                                                                \
+    }                                                                          \
+    for (int i = 0; i < n; i++) {                                              \
+        uint32_t x;                                                            \
+        memcpy(&x, arr + i, sizeof(x));                                        \
+        ki[i] = (uint64_t)(uint32_t)FLIP(x) << 32 | (uint32_t)i;               \
+    }                                                                          \
+    res = rdx_sort_hi32(ki, ki + n, n);                                        \
+    for (int i = 0; i < n; i++)                                                \
+        idx[i] = (uint32_t)res[i];                                             \
+    free(ki);                                                                  \
+}
+
+/*
+ * define a stable argsort function 'name(const type *arr, int n,
+ * uint32_t *idx)' of 64 bits type, by pairs of flipped key and index.
+ */
+
+#define DEF_ARGSORT_64(name, type, FLIP)                                       \
+void name(const type *arr, int n, uint32_t *idx) {                             \
+    KeyIdx *ki = NULL, *res = NULL;                                            \
+    if (n <= 0)                                                                \
+        return;                                                                \
+    ki = (KeyIdx *)malloc(sizeof(KeyIdx) * n * 2);                             \
+    if (ki == NULL) {                                                          \
+        fprintf(stderr, "ERROE allocating memory\n");                          \
+        return;                                                                \
+    }                                                                          \
+    for (int i = 0; i < n; i++) {                                              \
+        uint64_t x;                                                            \
+        memcpy(&x, arr + i, sizeof(x));                                        \
+        ki[i].key = FLIP(x);                                                   \
+        ki[i].idx = (uint32_t)i;                                               \
+    }                                                                          \
+    res = rdx_sort_ki(ki, ki + n, n);                                          \
+    for (int i = 0; i < n; i++)                                                \
+        idx[i] = res[i].idx;                                                   \
+    free(ki);                                                                  \
+}
+
+/*
+ * argsort functions of integer or floating point type, they are stable.
+ *
+ * time  complexity: O(n * w / 11), w is bits of element
+ * space complexity: O(n)
+ *
+ * @param arr is an allocated array of integer or floating point type data,
+ *            it is not changed.
+ * @param n   is number of elements in the array.
+ * @param idx is an allocated array of n indices, to get the permutation.
+ */
+
+DEF_ARGSORT_32(argsort_u32, uint32_t, FLIP_U32)
+DEF_ARGSORT_32(argsort_i32, int32_t,  FLIP_I32)
+DEF_ARGSORT_32(argsort_flt, float,    FLIP_FLT)
+DEF_ARGSORT_64(argsort_u64, uint64_t, FLIP_U64)
+DEF_ARGSORT_64(argsort_i64, int64_t,  FLIP_I64)
+DEF_ARGSORT_64(argsort_dbl, double,   FLIP_DBL)
+
+/*
+ * gather elements by a permutation, dst[i] = src[idx[i]], so that other
+ * arrays of the same rows are ordered as the sorted one.
+ *
+ * @param src is an allocated array of opaque type data.
+ * @param dst is an allocated array of n elements, not overlapping src.
+ * @param n   is number of elements in the array.
+ * @param s   is size of target element bytes.
+ * @param idx is an array of n indices, such as got by 'argsort()'.
+ */
+
+void permute(const void *src, void *dst, int n, size_t s,
+             const uint32_t *idx) {
+    const unsigned char *from = (const unsigned char *)src;
+    unsigned char *to = (unsigned char *)dst;
+    if (s == 4)
+        for (int i = 0; i < n; i++)
+            memcpy(to + (size_t)i * 4, from + (size_t)idx[i] * 4, 4);
+    else if (s == 8)
+        for (int i = 0; i < n; i++)
+            memcpy(to + (size_t)i * 8, from + (size_t)idx[i] * 8, 8);
+    else
+        for (int i = 0; i < n; i++)
+            memcpy(to + (size_t)i * s, from + (size_t)idx[i] * s, s);
+}
+
+/******************************************************************************/
+/* segmented sort                                                             */
+/******************************************************************************/
+
+#define SEG_CUTOFF  16          /* fewer elements are sorted by insertion  */
+
+/*
+ * segmented sort function based on pointer, every segment is sorted on its
+ * own, small ones by insertion without setup of a sort call.
+ *
+ * time  complexity: O(sum of n_i * log n_i)
+ * space complexity: O(log n_max)
+ *
+ * @param arr    is an allocated array of pointers to opaque type data.
+ * @param off    is an array of nb_seg + 1 ascending indices of arr, segment
+ *               i is [off[i], off[i + 1]).
+ * @param nb_seg is number of segments.
+ * @param cmp    is a pointer to a function comparing elements.
+ */
+
+void seg_sort_p(void **arr, const int *off, int nb_seg,
+                int(*cmp)(const void *, const void *)) {
+    for (int i = 0; i < nb_seg; i++) {
+        int n = off[i + 1] - off[i];
+        if (n <= 1)
+            continue;
+        if (n <= SEG_CUTOFF)
+            insert_sort_p(arr + off[i], n, cmp);
+        else
+            intro_sort_p(arr, off[i], off[i + 1], cmp);
+    }
+}
+
+/******************************************************************************/
+/* sorted set                                                                 */
+/******************************************************************************/
+
+#define LSM_DELTA   256         /* elements of delta buffer and level 0    */
+
+/*
+ * number of elements of level i of sorted set.
+ */
+
+static inline int lsm_size(const SortSet *ss, int i) {
+    return ss->used >> i & 1 ? LSM_DELTA << i : 0;
+}
+
+/*
+ * get the first index of sorted arr[0 .. n) whose element is not less than
+ * key (le == 0) or greater than key (le != 0).
+ */
+
+static int lsm_bound(void **arr, int n, const void *key, int le,
+                     int(*cmp)(const void *, const void *)) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2, c = cmp(arr[mid], key);
+        if (c < 0 || (le && c == 0))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/*
+ * create an empty sorted set.
+ *
+ * @param cmp is a pointer to a function comparing elements.
+ *
+ * @return a pointer to sorted set on success, otherwise NULL.
+ */
+
+SortSet *sort_set_create(int(*cmp)(const void *, const void *)) {
+    SortSet *ss = (SortSet *)calloc(1, sizeof(SortSet));
+    if (ss != NULL &&
+        (ss->delta = (void **)malloc(sizeof(void *) * LSM_DELTA)) == NULL)
+        free(ss), ss = NULL;
+    if (ss == NULL) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        return NULL;
+    }
+    ss->cmp = cmp;
+    return ss;
+}
+
+/*
+ * drop all elements, memory of levels is kept for reuse.
+ */
+
+void sort_set_clear(SortSet *ss) {
+    ss->nb_delta = 0;
+    ss->used     = 0;
+    ss->n        = 0;
+}
+
+void sort_set_destroy(SortSet *ss) {
+    if (ss == NULL)
+        return;
+    for (int i = 0; i < LSM_LEVEL_MAX; i++)
+        free(ss->level[i]);
+    free(ss->tmp);
+    free(ss->delta);
+    free(ss);
+}
+
+int sort_set_size(const SortSet *ss) {
+    return ss->n;
+}
+
+/*
+ * move the full delta buffer into levels, like adding 1 to a binary counter:
+ * full levels 0 .. j - 1 are merged with delta by 'merge_p()' into empty
+ * level j, through tmp and level j in turn so that the last merge writes
+ * level j. an older level is the first input of a merge, so equal elements
+ * stay in insertion order.
+ *
+ * @return 0 on success, otherwise -1.
+ */
+
+static int lsm_flush(SortSet *ss) {
+    int    j = __builtin_ctz(~ss->used), nb = LSM_DELTA, cap;
+    void **src = ss->delta, **dst = NULL;
+    if (j >= LSM_LEVEL_MAX)
+        return -1;
+    cap = j > 1 ? LSM_DELTA << (j - 1) : 0;   /* most elements in tmp */
+    if (ss->level[j] == NULL &&
+        (ss->level[j] = (void **)malloc(sizeof(void *) * (LSM_DELTA << j)))
+        == NULL)
+        return -1;
+    if (j > 1 && ss->nb_tmp < cap) {
+        if ((dst = (void **)realloc(ss->tmp, sizeof(void *) * cap)) == NULL)
+            return -1;
+        ss->tmp    = dst;
+        ss->nb_tmp = cap;
+    }
+    if (j == 0)
+        memcpy(ss->level[0], ss->delta, sizeof(void *) * LSM_DELTA);
+    for (int i = 0; i < j; i++, nb *= 2) {
+        dst = (j - 1 - i) % 2 == 0 ? ss->level[j] : ss->tmp;
+        merge_p(ss->level[i], nb, src, nb, dst, ss->cmp);
+        src = dst;
+    }
+    ss->used     = (ss->used | (1U << j)) & ~((1U << j) - 1);
+    ss->nb_delta = 0;
+    return 0;
+}
+
+/*
+ * insert an element into sorted set, after elements equal to it.
+ *
+ * time  complexity: O(log n) amortized, by sequential merges
+ *
+ * @param ss  is a pointer to sorted set.
+ * @param new is a pointer to opaque element.
+ *
+ * @return 0 on success, otherwise -1.
+ */
+
+int sort_set_insert(SortSet *ss, void *new) {
+    int i;
+    if (ss->nb_delta == LSM_DELTA && lsm_flush(ss) < 0) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        return -1;
+    }
+    i = lsm_bound(ss->delta, ss->nb_delta, new, 1, ss->cmp);
+    memmove(ss->delta + i + 1, ss->delta + i,
+            sizeof(void *) * (ss->nb_delta - i));
+    ss->delta[i] = new;
+    ss->nb_delta++;
+    ss->n++;
+    return 0;
+}
+
+/*
+ * get rank of key, which is number of elements less than key.
+ *
+ * time  complexity: O(log n * log n)
+ */
+
+int sort_set_rank(const SortSet *ss, const void *key) {
+    int rank = lsm_bound(ss->delta, ss->nb_delta, key, 0, ss->cmp);
+    for (unsigned m = ss->used; m != 0; m &= m - 1) {
+        int i = __builtin_ctz(m);
+        rank += lsm_bound(ss->level[i], LSM_DELTA << i, key, 0, ss->cmp);
+    }
+    return rank;
+}
+
+/*
+ * position an iterator at the first element not less than key, or at the
+ * first element if key is NULL. an iterator is invalid after an insert.
+ *
+ * @param it  is a pointer to iterator.
+ * @param ss  is a pointer to sorted set.
+ * @param key is a pointer to opaque element, or NULL.
+ */
+
+void sort_iter_seek(SortIter *it, const SortSet *ss, const void *key) {
+    it->ss = ss;
+    for (int i = 0; i < LSM_LEVEL_MAX; i++)
+        it->pos[i] = key == NULL ? 0 :
+            lsm_bound(ss->level[i], lsm_size(ss, i), key, 0, ss->cmp);
+    it->pos[LSM_LEVEL_MAX] = key == NULL ? 0 :
+        lsm_bound(ss->delta, ss->nb_delta, key, 0, ss->cmp);
+}
+
+/*
+ * get the next element in order, equal elements in insertion order, that
+ * is from older levels first.
+ *
+ * time  complexity: O(log n)
+ *
+ * @return a pointer to element, or NULL at the end.
+ */
+
+void *sort_iter_next(SortIter *it) {
+    const SortSet *ss = it->ss;
+    void *best = NULL;
+    int   src  = -1;
+    for (int i = LSM_LEVEL_MAX - 1; i >= 0; i--) {
+        if (it->pos[i] < lsm_size(ss, i) &&
+            (best == NULL || ss->cmp(ss->level[i][it->pos[i]], best) < 0)) {
+            best = ss->level[i][it->pos[i]];
+            src  = i;
+        }
+    }
+    if (it->pos[LSM_LEVEL_MAX] < ss->nb_delta) {
+        void *e = ss->delta[it->pos[LSM_LEVEL_MAX]];
+        if (best == NULL || ss->cmp(e, best) < 0) {
+            best = e;
+            src  = LSM_LEVEL_MAX;
+        }
+    }
+    if (src >= 0)
+        it->pos[src]++;
+    return best;
+}
+
+/*
+ * get elements in [lo, hi) in order.
+ *
+ * @param ss  is a pointer to sorted set.
+ * @param lo  is a pointer to the lower bound, or NULL for no bound.
+ * @param hi  is a pointer to the upper bound (excluded), or NULL for no
+ *            bound.
+ * @param out is an allocated array of at least max pointers.
+ * @param max is the most elements got.
+ *
+ * @return number of elements in out.
+ */
+
+int sort_set_range(const SortSet *ss, const void *lo, const void *hi,
+                   void **out, int max) {
+    SortIter it;
+    void    *e = NULL;
+    int      k = 0;
+    sort_iter_seek(&it, ss, lo);
+    while (k < max && (e = sort_iter_next(&it)) != NULL &&
+           (hi == NULL || ss->cmp(e, hi) < 0))
+        out[k++] = e;
+    return k;
+}
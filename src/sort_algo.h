@@ -10,6 +10,9 @@
 #ifndef __SORTALGOH__
 #define __SORTALGOH__
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef  __cplusplus
 extern "C" {
 #endif /* __plusplus */
@@ -35,6 +38,15 @@ extern "C" {
 /******************************************************************************/
 
 
+/*
+ * hook counting swaps, sort code built with instrumentation includes
+ * 'perf_stat.h' before this file, otherwise it expands to nothing.
+ */
+
+#ifndef STAT_SWAP
+#define STAT_SWAP() ((void)0)
+#endif  /* STAT_SWAP */
+
 /*
  * swap two variable of same type.
  *
@@ -44,6 +56,7 @@ extern "C" {
 
 #define SWAP(p1, p2) ({                                 \
     if ((p1) != (p2)) {                                 \
+        STAT_SWAP();                                    \
         (p1) ^= (p2);                                   \
         (p2) ^= (p1);                                   \
         (p1) ^= (p2);                                   \
@@ -59,6 +72,7 @@ extern "C" {
 
 #define SWAP_PTR(ptr1, ptr2) ({                         \
     if (ptr1 != ptr2) {                                 \
+        STAT_SWAP();                                    \
         unsigned long p1_ = (unsigned long)(ptr1);      \
         unsigned long p2_ = (unsigned long)(ptr2);      \
         p1_ ^= p2_;                                     \
@@ -95,6 +109,7 @@ extern "C" {
  */
 
 #define SWAP_MEM(p1, p2, pt, s) ({                      \
+    STAT_SWAP();                                        \
     memmove(pt, p1, s);                                 \
     memmove(p1, p2, s);                                 \
     memmove(p2, pt, s);                                 \
@@ -139,6 +154,19 @@ extern "C" {
 #define heap_pop_p                                      \
     heap_del_p
 
+/*
+ * size of a gap array of shell sort, more than gaps of any 'int' n, see
+ * 'gen_gap_buf()'.
+ */
+
+#define GAP_MAX         64
+
+/*
+ * most levels of sorted set, level i holds 256 << i elements.
+ */
+
+#define LSM_LEVEL_MAX   23
+
 
 /******************************************************************************/
 /*                                                                            */
@@ -151,12 +179,56 @@ extern "C" {
 /* Bucket type                                                                */
 /******************************************************************************/
 
-struct entry;
-typedef struct entry Entry;
+/*
+ * a bucket is a contiguous range [begin, begin + size) of the sorted array.
+ */
+
+struct bucket {
+    int begin;          /* index of the first element of bucket */
+    int size;           /* number of elements of bucket         */
+};
 
-struct bucket;
 typedef struct bucket Bucket;
 
+/******************************************************************************/
+/* TopK type                                                                  */
+/******************************************************************************/
+
+struct top_k;
+typedef struct top_k TopK;
+
+/******************************************************************************/
+/* PrioQ type                                                                 */
+/******************************************************************************/
+
+struct prio_q;
+typedef struct prio_q PrioQ;
+
+/******************************************************************************/
+/* SortSet type                                                               */
+/******************************************************************************/
+
+struct sort_set;
+typedef struct sort_set SortSet;
+
+/*
+ * an iterator of sorted set, a position in every level and in delta buffer.
+ */
+
+struct sort_iter {
+    const SortSet *ss;
+    int pos[LSM_LEVEL_MAX + 1];
+};
+
+typedef struct sort_iter SortIter;
+
+/******************************************************************************/
+/* ThreadPool type (see thread_pool.h)                                        */
+/******************************************************************************/
+
+struct thread_pool;
+typedef struct thread_pool ThreadPool;
+
 
 /******************************************************************************/
 /*                                                                            */
@@ -175,6 +247,8 @@ extern int  cmp_dbl         (const void *, const void *);
 
 extern int  cmp_dbl_rev     (const void *, const void *);
 
+extern int  cmp_str         (const void *, const void *);
+
 /******************************************************************************/
 /* insert sort                                                                */
 /******************************************************************************/
@@ -217,6 +291,12 @@ extern void heap_build_p    (void **, int,
 
 extern void *heap_top_p     (void **);
 
+extern void heap_sift_down_d_p (void **, int, int, int, void *,
+                                      int(*)(const void *, const void *));
+
+extern void heap_sift_up_d_p  (void **, int, int, void *,
+                                      int(*)(const void *, const void *));
+
 extern void heap_insert_p   (void **, void *, int, int,
                                       int(*)(const void *, const void *));
 
@@ -229,9 +309,56 @@ extern void *heap_del_p     (void **, int,
 extern void heap_sort_p     (void **, int,
                                       int(*)(const void *, const void *));
 
+extern void heap_sort_d_p   (void **, int, int,
+                                      int(*)(const void *, const void *));
+
 extern void *heap_top_k_p   (void **, int, int,
                                       int(*)(const void *, const void *));
 
+extern void heap_sort       (void *,  int, size_t,
+                                      int(*)(const void *, const void *));
+
+/******************************************************************************/
+/* top k                                                                      */
+/******************************************************************************/
+
+extern TopK *top_k_create   (int, int(*)(const void *, const void *));
+
+extern void top_k_clear     (TopK *);
+
+extern void top_k_destroy   (TopK *);
+
+extern void *top_k_thr      (const TopK *);
+
+extern void top_k_push      (TopK *, void *);
+
+extern void top_k_push_n    (TopK *, void **, int);
+
+extern void top_k_merge     (TopK *, const TopK *);
+
+extern int  top_k_final     (const TopK *, void **);
+
+/******************************************************************************/
+/* priority queue                                                             */
+/******************************************************************************/
+
+extern PrioQ *pq_create     (int, int(*)(const void *, const void *));
+
+extern void pq_destroy      (PrioQ *);
+
+extern int  pq_size         (const PrioQ *);
+
+extern int  pq_push         (PrioQ *, void *);
+
+extern void *pq_top         (const PrioQ *);
+
+extern void *pq_pop         (PrioQ *);
+
+extern int  pq_decrease     (PrioQ *, int, void *);
+
+extern int  merge_k_p       (void ***, const int *, int, void **,
+                                      int(*)(const void *, const void *));
+
 /******************************************************************************/
 /* quick sort                                                                 */
 /******************************************************************************/
@@ -242,6 +369,29 @@ extern int  three_mid_val_p (void **, int, int,
 extern void quick_sort_p    (void **, int, int,
                                       int(*)(const void *, const void *));
 
+extern void quick_sort_bfprt_p (void **, int, int,
+                                      int(*)(const void *, const void *));
+
+extern void quick_sort_block_p (void **, int, int,
+                                      int(*)(const void *, const void *));
+
+extern void quick_sort      (void *,  int, size_t,
+                                      int(*)(const void *, const void *));
+
+/******************************************************************************/
+/* intro sort                                                                 */
+/******************************************************************************/
+
+extern void intro_sort_p    (void **, int, int,
+                                      int(*)(const void *, const void *));
+
+/******************************************************************************/
+/* three-way quick sort                                                       */
+/******************************************************************************/
+
+extern void quick_sort_3way_p (void **, int, int,
+                                      int(*)(const void *, const void *));
+
 /******************************************************************************/
 /* bucket sort                                                                */
 /******************************************************************************/
@@ -257,6 +407,108 @@ extern void bucket_sort_p   (void **, int, int(*)(int),
                                       int(*)(void *, int),
                                       int(*)(const void *, const void *));
 
+/******************************************************************************/
+/* sample sort                                                                */
+/******************************************************************************/
+
+extern void sample_sort_p   (void **, int,
+                                      int(*)(const void *, const void *));
+
+/******************************************************************************/
+/* radix sort                                                                 */
+/******************************************************************************/
+
+extern void radix_sort_u32  (uint32_t *, int);
+
+extern void radix_sort_i32  (int32_t *,  int);
+
+extern void radix_sort_flt  (float *,    int);
+
+extern void radix_sort_u64  (uint64_t *, int);
+
+extern void radix_sort_i64  (int64_t *,  int);
+
+extern void radix_sort_dbl  (double *,   int);
+
+extern uint64_t key_dbl     (const void *);
+
+extern uint64_t key_i64     (const void *);
+
+extern uint64_t key_u64     (const void *);
+
+extern void radix_sort_p    (void **, int, uint64_t(*)(const void *));
+
+/******************************************************************************/
+/* key prefix sort                                                            */
+/******************************************************************************/
+
+extern void key_sort_p      (void **, int, uint64_t(*)(const void *),
+                                      int(*)(const void *, const void *));
+
+/******************************************************************************/
+/* string sort                                                                */
+/******************************************************************************/
+
+extern void str_sort_p      (void **, int);
+
+/******************************************************************************/
+/* argsort                                                                    */
+/******************************************************************************/
+
+extern void argsort         (const void *, int, size_t,
+                             int(*)(const void *, const void *), uint32_t *);
+
+extern void argsort_stable  (const void *, int, size_t,
+                             int(*)(const void *, const void *), uint32_t *);
+
+extern void argsort_key     (const void *, int, size_t,
+                             uint64_t(*)(const void *), uint32_t *);
+
+extern void argsort_u32     (const uint32_t *, int, uint32_t *);
+
+extern void argsort_i32     (const int32_t *,  int, uint32_t *);
+
+extern void argsort_flt     (const float *,    int, uint32_t *);
+
+extern void argsort_u64     (const uint64_t *, int, uint32_t *);
+
+extern void argsort_i64     (const int64_t *,  int, uint32_t *);
+
+extern void argsort_dbl     (const double *,   int, uint32_t *);
+
+extern void permute         (const void *, void *, int, size_t,
+                             const uint32_t *);
+
+/******************************************************************************/
+/* segmented sort                                                             */
+/******************************************************************************/
+
+extern void seg_sort_p      (void **, const int *, int,
+                                      int(*)(const void *, const void *));
+
+/******************************************************************************/
+/* sorted set                                                                 */
+/******************************************************************************/
+
+extern SortSet *sort_set_create (int(*)(const void *, const void *));
+
+extern void sort_set_clear  (SortSet *);
+
+extern void sort_set_destroy(SortSet *);
+
+extern int  sort_set_size   (const SortSet *);
+
+extern int  sort_set_insert (SortSet *, void *);
+
+extern int  sort_set_rank   (const SortSet *, const void *);
+
+extern int  sort_set_range  (const SortSet *, const void *, const void *,
+                                      void **, int);
+
+extern void sort_iter_seek  (SortIter *, const SortSet *, const void *);
+
+extern void *sort_iter_next (SortIter *);
+
 /******************************************************************************/
 /* merge sort                                                                 */
 /******************************************************************************/
@@ -264,18 +516,36 @@ extern void bucket_sort_p   (void **, int, int(*)(int),
 extern void m_sort_p        (void **, void **, int, int,
                                       int(*)(const void *, const void *));
 
+extern void merge_p         (void **, int, void **, int, void **,
+                                      int(*)(const void *, const void *));
+
 extern void merge_sort_p    (void **, int,
                                       int(*)(const void *, const void *));
 
+/******************************************************************************/
+/* tim sort                                                                   */
+/******************************************************************************/
+
+extern void tim_sort_p      (void **, int,
+                                      int(*)(const void *, const void *));
+
+extern void merge_sort      (void *,  int, size_t,
+                                      int(*)(const void *, const void *));
+
 /******************************************************************************/
 /* shell sort                                                                 */
 /******************************************************************************/
 
 extern int  gen_gap_p       (int **gap, int n);
 
+extern int  gen_gap_buf     (int *gap, int n);
+
 extern void shell_sort_p    (void **, int,
                                       int(*)(const void *, const void *));
 
+extern void shell_sort      (void *,  int, size_t,
+                                      int(*)(const void *, const void *));
+
 /******************************************************************************/
 /* BFPRT                                                                      */
 /******************************************************************************/
@@ -289,6 +559,144 @@ extern int  partition_p     (void **, int, int, int,
 extern int  BFPRT_k_idx_p   (void **, int, int, int,
                                       int(*)(const void *, const void *));
 
+extern int  BFPRT_k_idx_block_p (void **, int, int, int,
+                                      int(*)(const void *, const void *));
+
+/******************************************************************************/
+/* Floyd-Rivest selection                                                     */
+/******************************************************************************/
+
+extern int  nth_element_p   (void **, int, int, int,
+                                      int(*)(const void *, const void *));
+
+extern void partial_sort_p  (void **, int, int, int,
+                                      int(*)(const void *, const void *));
+
+extern int  partial_sort_copy_p (void **, int, void **, int,
+                                      int(*)(const void *, const void *));
+
+/******************************************************************************/
+/* parallel quick sort                                                        */
+/******************************************************************************/
+
+extern void quick_sort_pool_p (ThreadPool *, void **, int, int,
+                                      int(*)(const void *, const void *));
+
+extern void quick_sort_par_p  (void **, int, int,
+                                      int(*)(const void *, const void *), int);
+
+/******************************************************************************/
+/* parallel merge sort                                                        */
+/******************************************************************************/
+
+extern void merge_sort_pool_p (ThreadPool *, void **, int,
+                                      int(*)(const void *, const void *));
+
+extern void merge_sort_par_p  (void **, int,
+                                      int(*)(const void *, const void *), int);
+
+/******************************************************************************/
+/* parallel bucket sort                                                       */
+/******************************************************************************/
+
+extern void bucket_sort_pool_p (ThreadPool *, void **, int, int(*)(int),
+                                      int(*)(void *, int),
+                                      int(*)(const void *, const void *));
+
+extern void bucket_sort_par_p  (void **, int, int(*)(int),
+                                      int(*)(void *, int),
+                                      int(*)(const void *, const void *), int);
+
+/******************************************************************************/
+/* parallel top k and selection                                               */
+/******************************************************************************/
+
+extern int  top_k_pool_p      (ThreadPool *, void **, int, int, void **,
+                                      int(*)(const void *, const void *));
+
+extern int  top_k_par_p       (void **, int, int, void **,
+                                      int(*)(const void *, const void *), int);
+
+extern int  select_k_pool_p   (ThreadPool *, void **, int, int, int,
+                                      int(*)(const void *, const void *));
+
+extern int  select_k_par_p    (void **, int, int, int,
+                                      int(*)(const void *, const void *), int);
+
+/******************************************************************************/
+/* parallel segmented sort                                                    */
+/******************************************************************************/
+
+extern void seg_sort_pool_p   (ThreadPool *, void **, const int *, int,
+                                      int(*)(const void *, const void *));
+
+extern void seg_sort_par_p    (void **, const int *, int,
+                                      int(*)(const void *, const void *), int);
+
+extern void seg_sort_par_f64  (double *,  const int *, int, int);
+
+extern void seg_sort_par_f32  (float *,   const int *, int, int);
+
+extern void seg_sort_par_i64  (int64_t *, const int *, int, int);
+
+extern void seg_sort_par_i32  (int32_t *, const int *, int, int);
+
+/******************************************************************************/
+/* typed sort (see sort_algo.hpp)                                             */
+/******************************************************************************/
+
+extern void insert_sort_dbl   (double *,  int);
+
+extern void select_sort_dbl   (double *,  int);
+
+extern void bubble_sort_dbl   (double *,  int);
+
+extern void heap_sort_dbl     (double *,  int);
+
+extern void quick_sort_dbl    (double *,  int, int);
+
+extern void quick_sort_block_dbl (double *, int, int);
+
+extern void merge_sort_dbl    (double *,  int);
+
+extern void shell_sort_dbl    (double *,  int);
+
+extern void insert_sort_dbl_p (double **, int);
+
+extern void select_sort_dbl_p (double **, int);
+
+extern void bubble_sort_dbl_p (double **, int);
+
+extern void heap_sort_dbl_p   (double **, int);
+
+extern void quick_sort_dbl_p  (double **, int, int);
+
+extern void merge_sort_dbl_p  (double **, int);
+
+extern void shell_sort_dbl_p  (double **, int);
+
+/******************************************************************************/
+/* SIMD sort (see simd_sort.c)                                                */
+/******************************************************************************/
+
+extern int  simd_level        (int);
+
+extern void sort_f64          (double *,   int);
+
+extern void sort_f32          (float *,    int);
+
+extern void sort_i64          (int64_t *,  int);
+
+extern void sort_i32          (int32_t *,  int);
+
+extern void seg_sort_f64      (double *,   const int *, int);
+
+extern void seg_sort_f32      (float *,    const int *, int);
+
+extern void seg_sort_i64      (int64_t *,  const int *, int);
+
+extern void seg_sort_i32      (int32_t *,  const int *, int);
+
 #ifdef __cplusplus
 }
 #endif /* __plusplus */
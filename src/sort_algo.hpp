@@ -0,0 +1,1046 @@
+/**
+ * @file sort_algo.hpp
+ * head file contains of template implementation of sort algorithm.
+ *
+ * every template is parameterized over element type and compare functor,
+ * so that compare is inlined in place of calling 'int(*)(const void *,
+ * const void *)' for every comparison.
+ *
+ * a compare functor returns 1 (v1 > v2), -1 (v1 < v2), 0 (v1 = v2) as the
+ * compare function of C interface does.
+ *
+ * @author  duruyao
+ * @version 1.0  19-12-19
+ * @update  [id] [yy-mm-dd] [author] [description]
+ */
+
+#ifndef __SORTALGOHPP__
+#define __SORTALGOHPP__
+
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+/*
+ * hooks counting swaps and moves, sort code built with instrumentation
+ * includes 'perf_stat.h' before this file, otherwise they expand to nothing.
+ */
+
+#ifndef STAT_SWAP
+#define STAT_SWAP()     ((void)0)
+#endif  /* STAT_SWAP */
+
+#ifndef STAT_MOVE
+#define STAT_MOVE(k)    ((void)0)
+#endif  /* STAT_MOVE */
+
+namespace sort_algo {
+
+
+/******************************************************************************/
+/*                                                                            */
+/* compare functor                                                            */
+/*                                                                            */
+/******************************************************************************/
+
+
+/*
+ * compare functor for data supporting '==' and '>'.
+ */
+
+template <typename T>
+struct cmp_val {
+    int operator()(const T &v1, const T &v2) const {
+        return v1 == v2 ? 0 : (v1 > v2 ? 1 : -1);
+    }
+};
+
+/*
+ * compare functor for pointers, it compares the data pointed by pointers.
+ */
+
+template <typename Cmp>
+struct cmp_deref {
+    Cmp cmp;
+    template <typename P>
+    int operator()(const P &p1, const P &p2) const {
+        return cmp(*p1, *p2);
+    }
+};
+
+/*
+ * compare functor wrapping a compare function of C interface for array of
+ * pointers, it passes pointers themselves to the function.
+ */
+
+struct cmp_func_p {
+    int(*cmp)(const void *, const void *);
+    int operator()(const void *p1, const void *p2) const {
+        return cmp(p1, p2);
+    }
+};
+
+/*
+ * compare functor for indices into an array of opaque type data, it passes
+ * the elements indexed to a compare function of C interface, so the array
+ * of an argsort goes with the functor instead of globals.
+ */
+
+struct cmp_idx {
+    const unsigned char *base;
+    size_t size;
+    int(*cmp)(const void *, const void *);
+    int operator()(uint32_t i1, uint32_t i2) const {
+        return cmp(base + i1 * size, base + i2 * size);
+    }
+};
+
+
+/******************************************************************************/
+/*                                                                            */
+/* function template defination                                               */
+/*                                                                            */
+/******************************************************************************/
+
+
+/*
+ * swap two elements, as 'SWAP_PTR()' of C interface does.
+ */
+
+template <typename T>
+inline void swap_val(T &v1, T &v2) {
+    if (&v1 != &v2) {
+        STAT_SWAP();
+        std::swap(v1, v2);
+    }
+}
+
+/******************************************************************************/
+/* insert sort                                                                */
+/******************************************************************************/
+
+/*
+ * insert sort function template.
+ *
+ * best    case: O(n)
+ * worst   case: O(n ^ 2)
+ * average case: O(n ^ 2)
+ *
+ * @param arr is an allocated array of T type data.
+ * @param n   is number of elements in the array.
+ * @param cmp is a compare functor.
+ */
+
+template <typename T, typename Cmp>
+inline void insert_sort(T *arr, int n, Cmp cmp) {
+    for (int i = 1, j; i < n; i++) {
+        T value = arr[i];
+        for (j = i - 1; j >= 0 && cmp(arr[j], value) > 0; j--)
+            arr[j + 1] = arr[j];
+        arr[j + 1] = value;
+        STAT_MOVE(i - j);
+    }
+}
+
+/******************************************************************************/
+/* select sort                                                                */
+/******************************************************************************/
+
+/*
+ * select sort function template.
+ *
+ * best    case: O(n ^ 2)
+ * worst   case: O(n ^ 2)
+ * average case: O(n ^ 2)
+ *
+ * @param arr is an allocated array of T type data.
+ * @param n   is number of elements in the array.
+ * @param cmp is a compare functor.
+ */
+
+template <typename T, typename Cmp>
+inline void select_sort(T *arr, int n, Cmp cmp) {
+    for (int i = n - 1; i >= 1; i--) {
+        int max_pos = 0;
+        for (int j = 1; j <= i; j++) {
+            if (cmp(arr[j], arr[max_pos]) > 0)
+                max_pos = j;
+        }
+        swap_val(arr[i], arr[max_pos]);
+    }
+}
+
+/******************************************************************************/
+/* bubble sort                                                                */
+/******************************************************************************/
+
+/*
+ * bubble sort function template.
+ *
+ * best    case:   O(n)
+ * worst   case:   O(n ^ 2)
+ * average case:   O(n ^ 2)
+ *
+ * @param arr is an allocated array of T type data.
+ * @param n   is number of elements in the array.
+ * @param cmp is a compare functor.
+ */
+
+template <typename T, typename Cmp>
+inline void bubble_sort(T *arr, int n, Cmp cmp) {
+    bool flag = true;
+    for (int i = 0; flag && i < n - 1; i++) {
+        flag = false;
+        for (int j = 0; j < n - i - 1; j++) {
+            if (cmp(arr[j], arr[j + 1]) > 0) {
+                swap_val(arr[j], arr[j + 1]);
+                flag = true;
+            }
+        }
+    }
+}
+
+/******************************************************************************/
+/* heap sort                                                                  */
+/******************************************************************************/
+
+/*
+ * the following function templates are cores of d-ary heap, a big top heap
+ * if compare functor is 'cmp'. children of node i are D * i + 1 .. D * i + D
+ * and an element is moved into a hole instead of swapped on every level.
+ */
+
+/*
+ * get index of the largest child, whose first child c < n.
+ */
+
+template <int D, typename T, typename Cmp>
+inline int dh_max_child(T *arr, int c, int n, Cmp cmp) {
+    int last = n - c < D ? n : c + D;
+    for (int j = c + 1; j < last; j++)
+        if (cmp(arr[j], arr[c]) > 0)
+            c = j;
+    return c;
+}
+
+/*
+ * move a hole at node i down until x fits in it.
+ */
+
+template <int D, typename T, typename Cmp>
+inline void dh_sift_down(T *arr, int i, int n, T x, Cmp cmp) {
+    int nb = 1;
+    for (int c; (c = D * i + 1) < n; i = c, nb++) {
+        c = dh_max_child<D>(arr, c, n, cmp);
+        if (cmp(arr[c], x) <= 0)
+            break;
+        arr[i] = arr[c];
+    }
+    arr[i] = x;
+    STAT_MOVE(nb);
+}
+
+/*
+ * move a hole at node i up until x fits in it.
+ */
+
+template <int D, typename T, typename Cmp>
+inline void dh_sift_up(T *arr, int i, T x, Cmp cmp) {
+    int nb = 1;
+    for (int p; i > 0 && cmp(x, arr[p = (i - 1) / D]) > 0; i = p, nb++)
+        arr[i] = arr[p];
+    arr[i] = x;
+    STAT_MOVE(nb);
+}
+
+/*
+ * Floyd's bottom-up sift: a hole at the top is moved down to a leaf along
+ * the largest children without comparing x, then x is moved up from there.
+ * x, the last leaf of a heap, mostly belongs near the bottom, so it saves
+ * the comparison with x on every level.
+ */
+
+template <int D, typename T, typename Cmp>
+inline void dh_sift_floyd(T *arr, int n, T x, Cmp cmp) {
+    int i = 0, nb = 0;
+    for (int c; (c = D * i + 1) < n; i = c, nb++) {
+        c = dh_max_child<D>(arr, c, n, cmp);
+        arr[i] = arr[c];
+    }
+    STAT_MOVE(nb);
+    dh_sift_up<D>(arr, i, x, cmp);
+}
+
+/*
+ * build a heap of arity D.
+ *
+ * @param arr is an allocated array of T type data.
+ * @param n   is number of elements in heap.
+ * @param cmp is a compare functor.
+ */
+
+template <int D, typename T, typename Cmp>
+inline void heap_build_d(T *arr, int n, Cmp cmp) {
+    for (int i = (n - 2) / D; n > 1 && i >= 0; i--)
+        dh_sift_down<D>(arr, i, n, arr[i], cmp);
+}
+
+/*
+ * heap sort function template on a heap of arity D, the top is removed by
+ * Floyd's bottom-up sift.
+ *
+ * best    case: O(n * log n)
+ * worst   case: O(n * log n)
+ * average case: O(n * log n)
+ *
+ * @param arr is an allocated array of T type data.
+ * @param n   is number of elements in the array.
+ * @param cmp is a compare functor.
+ */
+
+template <int D, typename T, typename Cmp>
+inline void heap_sort_d(T *arr, int n, Cmp cmp) {
+    heap_build_d<D>(arr, n, cmp);
+    for (int i = n - 1; i > 0; i--) {
+        T x = arr[i];
+        arr[i] = arr[0];
+        STAT_MOVE(1);
+        dh_sift_floyd<D>(arr, i, x, cmp);
+    }
+}
+
+/*
+ * keep attribute (big top or small top) of binary heap.
+ *
+ * @param arr   is an allocated array of T type data.
+ * @param begin is the first index.
+ * @param end   is the last index.
+ * @param cmp   is a compare functor.
+ */
+
+template <typename T, typename Cmp>
+inline void heapify(T *arr, int begin, int end, Cmp cmp) {
+    if (begin < end)
+        dh_sift_down<2>(arr, begin, end, arr[begin], cmp);
+}
+
+/*
+ * build a binary heap (big top heap or small top heap) by using
+ * one-dimension array.
+ *
+ * @param arr is an allocated array of T type data.
+ * @param k   is the max number of elements in heap.
+ * @param cmp is a compare functor.
+ */
+
+template <typename T, typename Cmp>
+inline void heap_build(T *arr, int k, Cmp cmp) {
+    heap_build_d<2>(arr, k, cmp);
+}
+
+/*
+ * heap sort function template on binary heap.
+ *
+ * @param arr is an allocated array of T type data.
+ * @param n   is number of elements in the array.
+ * @param cmp is a compare functor.
+ */
+
+template <typename T, typename Cmp>
+inline void heap_sort(T *arr, int n, Cmp cmp) {
+    heap_sort_d<2>(arr, n, cmp);
+}
+
+/******************************************************************************/
+/* BFPRT                                                                      */
+/******************************************************************************/
+
+template <typename T, typename Cmp>
+int BFPRT_k_idx(T *arr, int begin, int end, int k, Cmp cmp,
+                bool block = false);
+
+/*
+ * select pivot that is middle of middle.
+ *
+ * @param arr   is an allocated array of T type data.
+ * @param begin is left index of array.
+ * @param end   is right index of array.
+ * @param cmp   is a compare functor.
+ * @param block is true to partition by 'block_partition()'.
+ *
+ * @return index of pivot.
+ */
+
+template <typename T, typename Cmp>
+int BFPRT_p_idx(T *arr, int begin, int end, Cmp cmp, bool block = false) {
+    if (end - begin < 5) {
+        insert_sort(arr + begin, end - begin, cmp);
+        return begin + ((end - begin + 1) >> 1) - 1;
+    }
+    int left_idx = begin;
+    for (int i = begin, med_idx; i + 4 < end; i += 5) {
+        insert_sort(arr + i, 5, cmp);
+        med_idx = i + ((5 + 1) >> 1) - 1;
+        swap_val(arr[left_idx], arr[med_idx]);
+        left_idx++;
+    }
+    return BFPRT_k_idx(arr, begin, left_idx,
+                       (left_idx - begin + 1) >> 1, cmp, block);
+}
+
+/*
+ * partition elements depending on pivot value.
+ *
+ * @param arr       is an allocated array of T type data.
+ * @param begin     is left index of array.
+ * @param end       is right index of array.
+ * @param pivot_idx is index of pivot value.
+ * @param cmp       is a compare functor.
+ *
+ * @return index of pivot value after partitioning.
+ */
+
+template <typename T, typename Cmp>
+inline int partition(T *arr, int begin, int end, int pivot_idx, Cmp cmp) {
+    int left_idx = begin;
+    swap_val(arr[pivot_idx], arr[end - 1]);
+    for (int i = begin; i < end - 1; i++) {
+        if (cmp(arr[i], arr[end - 1]) < 0) {
+            swap_val(arr[i], arr[left_idx]);
+            left_idx++;
+        }
+    }
+    swap_val(arr[left_idx], arr[end - 1]);
+    return left_idx;
+}
+
+const int ptn_block_size = 64;  /* elements of a block, at most 255        */
+
+/*
+ * scan a block of n elements from arr[first] forward and store offsets of
+ * elements not less than pivot, or from arr[last - 1] backward and store
+ * offsets (from last) of elements less than pivot.
+ *
+ * the result of comparison is added to count instead of being branched on,
+ * so the loop has no branch depending on data.
+ *
+ * @return number of offsets stored.
+ */
+
+template <typename T, typename Cmp>
+inline int blk_scan_l(T *arr, int first, int n, const T &pivot,
+                      unsigned char *off, Cmp cmp) {
+    int k = 0;
+    for (int i = 0; i < n; i++) {
+        off[k] = (unsigned char)i;
+        k += cmp(arr[first + i], pivot) >= 0;
+    }
+    return k;
+}
+
+template <typename T, typename Cmp>
+inline int blk_scan_r(T *arr, int last, int n, const T &pivot,
+                      unsigned char *off, Cmp cmp) {
+    int k = 0;
+    for (int i = 1; i <= n; i++) {
+        off[k] = (unsigned char)i;
+        k += cmp(arr[last - i], pivot) < 0;
+    }
+    return k;
+}
+
+/*
+ * partition elements depending on pivot value, as 'partition()' does,
+ * using BlockQuicksort (Edelkamp and Weiss).
+ *
+ * a block of ptn_block_size elements at each end is scanned without
+ * branches into a buffer of offsets of misplaced elements, then the
+ * misplaced pairs are swapped in a batch, so comparisons never cause
+ * branch misses. the last blocks, shorter than ptn_block_size, are handled
+ * in the same way. it pays when compare is inlined and cheap, a compare
+ * function called by pointer hides most of the saving.
+ *
+ * @param arr       is an allocated array of T type data.
+ * @param begin     is left index of array.
+ * @param end       is right index of array.
+ * @param pivot_idx is index of pivot value.
+ * @param cmp       is a compare functor.
+ *
+ * @return index of pivot value after partitioning.
+ */
+
+template <typename T, typename Cmp>
+int block_partition(T *arr, int begin, int end, int pivot_idx, Cmp cmp) {
+    const int B = ptn_block_size;
+    unsigned char off_l[ptn_block_size], off_r[ptn_block_size];
+    int first = begin + 1, last = end;
+    int nb_l = 0, nb_r = 0, st_l = 0, st_r = 0, sz_l, sz_r, num, rest;
+
+    swap_val(arr[begin], arr[pivot_idx]);
+    const T pivot = arr[begin];
+
+    /* [begin + 1, first) < pivot, [last, end) >= pivot */
+    while (last - first > 2 * B) {
+        if (nb_l == 0) {
+            st_l = 0;
+            nb_l = blk_scan_l(arr, first, B, pivot, off_l, cmp);
+        }
+        if (nb_r == 0) {
+            st_r = 0;
+            nb_r = blk_scan_r(arr, last, B, pivot, off_r, cmp);
+        }
+        num = nb_l < nb_r ? nb_l : nb_r;
+        for (int i = 0; i < num; i++)
+            swap_val(arr[first + off_l[st_l + i]], arr[last - off_r[st_r + i]]);
+        nb_l -= num;
+        nb_r -= num;
+        st_l += num;
+        st_r += num;
+        if (nb_l == 0)
+            first += B;
+        if (nb_r == 0)
+            last  -= B;
+    }
+
+    /* split the rest not in a scanned block into the last blocks */
+    rest = last - first - (nb_l || nb_r ? B : 0);
+    if (nb_r) {
+        sz_l = rest;
+        sz_r = B;
+    } else if (nb_l) {
+        sz_l = B;
+        sz_r = rest;
+    } else {
+        sz_l = rest / 2;
+        sz_r = rest - sz_l;
+    }
+    if (rest && nb_l == 0) {
+        st_l = 0;
+        nb_l = blk_scan_l(arr, first, sz_l, pivot, off_l, cmp);
+    }
+    if (rest && nb_r == 0) {
+        st_r = 0;
+        nb_r = blk_scan_r(arr, last, sz_r, pivot, off_r, cmp);
+    }
+    num = nb_l < nb_r ? nb_l : nb_r;
+    for (int i = 0; i < num; i++)
+        swap_val(arr[first + off_l[st_l + i]], arr[last - off_r[st_r + i]]);
+    nb_l -= num;
+    nb_r -= num;
+    st_l += num;
+    st_r += num;
+    if (nb_l == 0)
+        first += sz_l;
+    if (nb_r == 0)
+        last  -= sz_r;
+
+    /* one block is left with misplaced elements, move them to its end */
+    if (nb_l) {
+        while (nb_l--) {
+            last--;
+            swap_val(arr[first + off_l[st_l + nb_l]], arr[last]);
+        }
+        first = last;
+    }
+    if (nb_r) {
+        while (nb_r--) {
+            swap_val(arr[last - off_r[st_r + nb_r]], arr[first]);
+            first++;
+        }
+    }
+
+    swap_val(arr[begin], arr[first - 1]);
+    return first - 1;
+}
+
+/*
+ * select index of the k-th element using BFPRT algorithm.
+ *
+ * worst case: O(n)
+ *
+ * @param arr   is an allocated array of T type data.
+ * @param begin is left index of array.
+ * @param end   is right index of array.
+ * @param k     is target top number.
+ * @param cmp   is a compare functor.
+ * @param block is true to partition by 'block_partition()'.
+ *
+ * @return index of k-th element.
+ */
+
+template <typename T, typename Cmp>
+int BFPRT_k_idx(T *arr, int begin, int end, int k, Cmp cmp, bool block) {
+    while (end - begin >= 2) {
+        int pivot_idx = BFPRT_p_idx(arr, begin, end, cmp, block);
+        int ptn_idx = block ? block_partition(arr, begin, end, pivot_idx, cmp)
+                            : partition(arr, begin, end, pivot_idx, cmp);
+        int num = ptn_idx - begin + 1;
+        if (k == num)
+            return ptn_idx;
+        else if (k < num)
+            end = ptn_idx;
+        else {
+            begin = ptn_idx + 1;
+            k -= num;
+            /*
+             * elements equal to pivot are all on the right, gather them
+             * next to it, or a run of them would be cut by one per level.
+             */
+            int eq = begin;
+            for (int i = begin; i < end; i++)
+                if (cmp(arr[i], arr[ptn_idx]) <= 0)
+                    swap_val(arr[i], arr[eq++]);
+            if (k <= eq - begin)
+                return begin + k - 1;
+            k -= eq - begin;
+            begin = eq;
+        }
+    }
+    return begin;
+}
+
+/******************************************************************************/
+/* quick sort                                                                 */
+/******************************************************************************/
+
+/*
+ * quick sort internal function template, recursing into the smaller side
+ * and looping on the larger one, so stack depth is O(log n). a range still
+ * unsorted after depth levels is sorted by heap sort.
+ *
+ * @param arr   is an allocated array of T type data.
+ * @param begin is left index of array.
+ * @param end   is right index of array.
+ * @param depth is number of levels which can be partitioned still.
+ * @param cmp   is a compare functor.
+ */
+
+template <typename T, typename Cmp>
+void q_sort(T *arr, int begin, int end, int depth, Cmp cmp) {
+    while (end - begin > 1) {
+        if (depth-- == 0) {
+            heap_sort(arr + begin, end - begin, cmp);
+            return;
+        }
+        int pivot = BFPRT_p_idx(arr, begin, end, cmp);
+        int low   = begin;
+        int high  = end - 1;
+        swap_val(arr[begin], arr[pivot]);
+        pivot = begin;
+        while (low < high) {
+            while (low < high && cmp(arr[high], arr[pivot]) >= 0) high--;
+            while (low < high && cmp(arr[low], arr[pivot]) <= 0) low++;
+            swap_val(arr[low], arr[high]);
+        }
+        swap_val(arr[low], arr[pivot]);
+        if (low - begin < end - low - 1) {
+            q_sort(arr, begin, low, depth, cmp);
+            begin = low + 1;
+        } else {
+            q_sort(arr, low + 1, end, depth, cmp);
+            end = low;
+        }
+    }
+}
+
+/*
+ * quick sort function template, pivot is selected by BFPRT algorithm.
+ *
+ * BFPRT pivot splits a range of distinct elements evenly, but not a range
+ * of many equal ones, which are left on one side. so a range deeper than
+ * 2 * log2(n) levels is sorted by heap sort.
+ *
+ * best    case: < O(n * log n)
+ * worst   case:   O(n * log n)
+ * average case:   O(n * log n)
+ *
+ * @param arr   is an allocated array of T type data.
+ * @param begin is left index of array.
+ * @param end   is right index of array.
+ * @param cmp   is a compare functor.
+ */
+
+template <typename T, typename Cmp>
+void quick_sort(T *arr, int begin, int end, Cmp cmp) {
+    int depth = 0;
+    for (int n = end - begin; n > 1; n >>= 1)
+        depth += 2;
+    q_sort(arr, begin, end, depth, cmp);
+}
+
+/******************************************************************************/
+/* intro sort                                                                 */
+/******************************************************************************/
+
+const int intro_cutoff = 16;    /* fewer elements are sorted by insertion  */
+const int ninther_min  = 128;   /* fewer elements use median of 3          */
+
+/*
+ * @return index of median of arr[a], arr[b] and arr[c].
+ */
+
+template <typename T, typename Cmp>
+inline int med3_idx(T *arr, int a, int b, int c, Cmp cmp) {
+    if (cmp(arr[a], arr[b]) < 0)
+        return cmp(arr[b], arr[c]) < 0 ? b : (cmp(arr[a], arr[c]) < 0 ? c : a);
+    return cmp(arr[a], arr[c]) < 0 ? a : (cmp(arr[b], arr[c]) < 0 ? c : b);
+}
+
+/*
+ * select a pivot index, which is median of 3 medians of 3 (ninther) spread
+ * over range, or median of the first, middle and last for small range.
+ */
+
+template <typename T, typename Cmp>
+inline int ninther(T *arr, int begin, int end, Cmp cmp) {
+    int n = end - begin, mid = begin + n / 2, s = n / 8;
+    if (n < ninther_min)
+        return med3_idx(arr, begin, mid, end - 1, cmp);
+    return med3_idx(arr, med3_idx(arr, begin, begin + s, begin + 2 * s, cmp),
+                         med3_idx(arr, mid - s, mid, mid + s, cmp),
+                         med3_idx(arr, end - 1 - 2 * s, end - 1 - s, end - 1,
+                                  cmp),
+                         cmp);
+}
+
+/*
+ * partition range [begin, end) around the pivot moved to arr[begin].
+ *
+ * both scans stop at elements equal to pivot, so equal keys are split
+ * evenly instead of falling to one side.
+ *
+ * @return index of pivot after partitioning.
+ */
+
+template <typename T, typename Cmp>
+inline int intro_partition(T *arr, int begin, int end, Cmp cmp) {
+    const T pivot = arr[begin];
+    int i = begin, j = end;
+    for (;;) {
+        while (cmp(arr[++i], pivot) < 0)
+            if (i == end - 1)
+                break;
+        while (cmp(pivot, arr[--j]) < 0)
+            ;
+        if (i >= j)
+            break;
+        swap_val(arr[i], arr[j]);
+    }
+    swap_val(arr[begin], arr[j]);
+    return j;
+}
+
+/*
+ * intro sort internal function template, recursing into the smaller side
+ * and looping on the larger one. a range still unsorted after depth levels
+ * is sorted by heap sort.
+ *
+ * 'block_partition()' leaves elements equal to pivot on the right, so if
+ * nothing is less than pivot they are gathered next to it and skipped, or
+ * a run of equal keys would be cut by one per level.
+ */
+
+template <typename T, typename Cmp>
+void intro_sort_r(T *arr, int begin, int end, int depth, Cmp cmp,
+                  bool block = false) {
+    while (end - begin > intro_cutoff) {
+        if (depth-- == 0) {
+            heap_sort(arr + begin, end - begin, cmp);
+            return;
+        }
+        int p = ninther(arr, begin, end, cmp);
+        if (block) {
+            p = block_partition(arr, begin, end, p, cmp);
+            if (p == begin) {
+                int eq = p + 1;
+                for (int i = p + 1; i < end; i++)
+                    if (cmp(arr[i], arr[p]) <= 0)
+                        swap_val(arr[i], arr[eq++]);
+                begin = eq;
+                continue;
+            }
+        } else {
+            swap_val(arr[begin], arr[p]);
+            p = intro_partition(arr, begin, end, cmp);
+        }
+        if (p - begin < end - p - 1) {
+            intro_sort_r(arr, begin, p, depth, cmp, block);
+            begin = p + 1;
+        } else {
+            intro_sort_r(arr, p + 1, end, depth, cmp, block);
+            end = p;
+        }
+    }
+    insert_sort(arr + begin, end - begin, cmp);
+}
+
+/*
+ * intro sort function template, which is quick sort in introsort mode.
+ *
+ * pivot is a ninther instead of BFPRT median, recursion goes only into the
+ * smaller side so stack depth is O(log n), ranges of no more than
+ * intro_cutoff elements are sorted by insertion, and a range deeper than
+ * 2 * log2(n) levels is sorted by heap sort.
+ *
+ * best    case: O(n * log n)
+ * worst   case: O(n * log n)
+ * average case: O(n * log n)
+ *
+ * @param arr   is an allocated array of T type data.
+ * @param begin is left index of array.
+ * @param end   is right index of array.
+ * @param cmp   is a compare functor.
+ */
+
+template <typename T, typename Cmp>
+void intro_sort(T *arr, int begin, int end, Cmp cmp) {
+    int depth = 0;
+    for (int n = end - begin; n > 1; n >>= 1)
+        depth += 2;
+    intro_sort_r(arr, begin, end, depth, cmp);
+}
+
+/*
+ * intro sort function template partitioning by 'block_partition()', so
+ * comparisons of an inlined compare functor cause no branch misses.
+ *
+ * @param arr   is an allocated array of T type data.
+ * @param begin is left index of array.
+ * @param end   is right index of array.
+ * @param cmp   is a compare functor.
+ */
+
+template <typename T, typename Cmp>
+void intro_sort_block(T *arr, int begin, int end, Cmp cmp) {
+    int depth = 0;
+    for (int n = end - begin; n > 1; n >>= 1)
+        depth += 2;
+    intro_sort_r(arr, begin, end, depth, cmp, true);
+}
+
+/******************************************************************************/
+/* three-way quick sort                                                       */
+/******************************************************************************/
+
+/*
+ * swap n elements from index i with n elements from index j.
+ */
+
+template <typename T>
+inline void vec_swap(T *arr, int i, int j, int n) {
+    for (; n > 0; n--, i++, j++)
+        swap_val(arr[i], arr[j]);
+}
+
+/*
+
+Bentley-McIlroy partitioning of range [begin, end), pivot is moved to
+arr[begin], equal elements are parked at both ends while scanning
+
+ begin     a         b         c         d         end
+  |         |         |         |         |         |
+  |  = pv   |  < pv   |    ?    |  > pv   |  = pv   |
+
+then swapped to the middle
+
+ begin                                              end
+  |    < pv      |          = pv          |   > pv   |
+
+*/
+
+template <typename T, typename Cmp>
+void q_sort_3way(T *arr, int begin, int end, int depth, Cmp cmp) {
+    while (end - begin > intro_cutoff) {
+        int a, b, c, d, r, nb_lt, nb_gt;
+        if (depth-- == 0) {
+            heap_sort(arr + begin, end - begin, cmp);
+            return;
+        }
+        r = ninther(arr, begin, end, cmp);
+        swap_val(arr[begin], arr[r]);
+        const T pivot = arr[begin];
+        a = b = begin + 1;
+        c = d = end - 1;
+        for (;;) {
+            while (b <= c && (r = cmp(arr[b], pivot)) <= 0) {
+                if (r == 0) {
+                    swap_val(arr[a], arr[b]);
+                    a++;
+                }
+                b++;
+            }
+            while (b <= c && (r = cmp(arr[c], pivot)) >= 0) {
+                if (r == 0) {
+                    swap_val(arr[c], arr[d]);
+                    d--;
+                }
+                c--;
+            }
+            if (b > c)
+                break;
+            swap_val(arr[b], arr[c]);
+            b++;
+            c--;
+        }
+        nb_lt = b - a;
+        nb_gt = d - c;
+        r = a - begin < nb_lt ? a - begin : nb_lt;
+        vec_swap(arr, begin, b - r, r);
+        r = end - 1 - d < nb_gt ? end - 1 - d : nb_gt;
+        vec_swap(arr, b, end - r, r);
+
+        /* equal elements are in place, recurse into the smaller side */
+        if (nb_lt < nb_gt) {
+            q_sort_3way(arr, begin, begin + nb_lt, depth, cmp);
+            begin = end - nb_gt;
+        } else {
+            q_sort_3way(arr, end - nb_gt, end, depth, cmp);
+            end = begin + nb_lt;
+        }
+    }
+    insert_sort(arr + begin, end - begin, cmp);
+}
+
+/*
+ * three-way quick sort function template.
+ *
+ * all elements equal to pivot are grouped in the middle by Bentley-McIlroy
+ * partitioning and never touched again, so input of d distinct keys takes
+ * O(n * log d). pivot, recursion and depth limit are the same as of
+ * 'intro_sort()'.
+ *
+ * best    case: O(n), e.g. few distinct keys
+ * worst   case: O(n * log n)
+ * average case: O(n * log n)
+ *
+ * @param arr   is an allocated array of T type data.
+ * @param begin is left index of array.
+ * @param end   is right index of array.
+ * @param cmp   is a compare functor.
+ */
+
+template <typename T, typename Cmp>
+void quick_sort_3way(T *arr, int begin, int end, Cmp cmp) {
+    int depth = 0;
+    for (int n = end - begin; n > 1; n >>= 1)
+        depth += 2;
+    q_sort_3way(arr, begin, end, depth, cmp);
+}
+
+/******************************************************************************/
+/* merge sort                                                                 */
+/******************************************************************************/
+
+/*
+ * merge sort internal recursive function template.
+ *
+ * @param copy   is an allocated array, who is source array.
+ * @param result is an allocated array, who is destination array.
+ * @param begin  is the first index of array.
+ * @param end    is the last  index of array.
+ * @param cmp    is a compare functor.
+ */
+
+template <typename T, typename Cmp>
+void m_sort(T *copy, T *result, int begin, int end, Cmp cmp) {
+    if (end - begin <= 1)
+        return;
+    int med = (begin + end) / 2;
+    m_sort(result, copy, begin, med, cmp);
+    m_sort(result, copy, med, end, cmp);
+    for (int idx = begin, i = begin, j = med; idx < end;) {
+        if (j >= end || (i < med && cmp(copy[i], copy[j]) <= 0))
+            result[idx++] = copy[i++];
+        else
+            result[idx++] = copy[j++];
+    }
+    STAT_MOVE(end - begin);
+}
+
+/*
+ * merge sort function template.
+ *
+ * time  complexity: O(n * log n)
+ * space complexity: O(n)
+ *
+ * @param arr is an allocated array of T type data.
+ * @param n   is number of elements in the array.
+ * @param cmp is a compare functor.
+ *
+ * @return 0 on success, otherwise -1.
+ */
+
+template <typename T, typename Cmp>
+inline int merge_sort(T *arr, int n, Cmp cmp) {
+    if (n <= 1)
+        return 0;
+    T *copy = new (std::nothrow) T[n];
+    if (copy == NULL)
+        return -1;
+    std::copy(arr, arr + n, copy);
+    m_sort(copy, arr, 0, n, cmp);
+    delete [] copy;
+    return 0;
+}
+
+/******************************************************************************/
+/* shell sort                                                                 */
+/******************************************************************************/
+
+/*
+ * generate gaps of Sedgewick's sequence 1, 5, 19, 41, 109, ... which are not
+ * more than n / 2, in ascending order, into a caller provided array.
+ *
+ * @param gap is an allocated array of 64 integers.
+ * @param n   is number of elements of input set.
+ *
+ * @return size of gap array.
+ */
+
+inline int gen_gap(int *gap, int n) {
+    int k = 0;
+    long long gap_val = 1;
+    for (int j = 0, i; gap_val <= n / 2 && k < 64;) {
+        gap[k++] = (int)gap_val;
+        i = ++j / 2;
+        if (j % 2 == 0)
+            gap_val = 9 * (1LL << (2 * i)) - 9 * (1LL << i) + 1;
+        else
+            gap_val = (1LL << (i + 2)) * ((1LL << (i + 2)) - 3) + 1;
+    }
+    return k;
+}
+
+/*
+ * shell sort function template.
+ *
+ * best    case:   O(n)
+ * worst   case:   ?
+ * average case:   ?
+ *
+ * @param arr is an allocated array of T type data.
+ * @param n   is number of elements in the array.
+ * @param cmp is a compare functor.
+ */
+
+template <typename T, typename Cmp>
+inline void shell_sort(T *arr, int n, Cmp cmp) {
+    int gap[64];
+    int k = gen_gap(gap, n);
+    for (int t = k - 1; t >= 0; t--) {
+        int inc = gap[t];
+        for (int i = inc, j; i < n; i++) {
+            T temp = arr[i];
+            for (j = i - inc; j >= 0 && cmp(arr[j], temp) > 0; j -= inc)
+                arr[j + inc] = arr[j];
+            arr[j + inc] = temp;
+            STAT_MOVE((i - j) / inc);
+        }
+    }
+}
+
+} /* namespace sort_algo */
+
+#endif /* !__SORTALGOHPP__ */
@@ -0,0 +1,602 @@
+/**
+ * @file sort_cli.c
+ * command line tool sorting lines of text by a numeric key, like
+ * 'sort -g -s'.
+ *
+ * input is memory mapped if it is a regular file, otherwise it is read in
+ * large blocks. lines are counted and keys are parsed by chunks in
+ * parallel, keys are sorted by stable radix argsort, then sorted lines are
+ * gathered into large buffers in parallel and written in order. lines are
+ * written as they are read, so no number is formatted again and records
+ * keep all their fields.
+ *
+ * usage: ./sort_cli [-t TYPE] [-k FIELD] [-d DELIM] [-r] [-j THREADS]
+ *                   [-o FILE] [-v] [FILE]
+ *
+ *   -t TYPE    type of key: dbl or i64, default dbl
+ *   -k FIELD   key is the FIELD-th field of a line, from 1, default 1
+ *   -d DELIM   fields are separated by character DELIM, default blanks
+ *   -r         reverse order, lines of equal keys keep input order
+ *   -j THREADS number of threads, default all
+ *   -o FILE    write to FILE instead of stdout, it may be the input file
+ *   -v         report time of every step to stderr
+ *
+ * keys of type dbl are ordered as by 'LC_ALL=C sort -g -s': lines whose key
+ * field is not a number go first, then 'nan', then numbers from '-inf' to
+ * 'inf'. keys are compared as doubles instead of long doubles, and all NaNs
+ * are equal. a key of type i64 is the integer at the start of its field, or
+ * 0 if there is none. the last line is ended by '\n' if it is not.
+ *
+ * @author  duruyao
+ * @version 1.0  19-12-19
+ * @update  [id] [yy-mm-dd] [author] [description]
+ */
+
+#include <time.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "sort_algo.h"
+#include "thread_pool.h"
+
+
+/******************************************************************************/
+/*                                                                            */
+/* struct defination                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+
+#define READ_BLOCK  (1 << 24)   /* bytes of one read() of a stream         */
+#define OUT_LINES   (1 << 16)   /* lines gathered by one output task       */
+#define NUM_MAX     64          /* longer numbers are copied to heap       */
+
+#define K_DBL       0
+#define K_I64       1
+
+/*
+ * options and data of one run.
+ */
+
+typedef struct cli {
+    const char *buf;            /* input text                              */
+    size_t      size;           /* bytes of input                          */
+    size_t     *line;           /* offsets of n lines, and size at line[n] */
+    uint64_t   *key;            /* order preserving keys of lines          */
+    uint32_t   *idx;            /* permutation of sorted lines             */
+    int         n;              /* number of lines                         */
+    int         type;           /* K_DBL or K_I64                          */
+    int         field;          /* key field, from 1                       */
+    int         delim;          /* field separator, or -1 for blanks       */
+    uint64_t    flip;           /* ~0 to reverse order, otherwise 0        */
+} Cli;
+
+/*
+ * a chunk [begin, end) of input of parsing, or a range of sorted lines of
+ * output.
+ */
+
+typedef struct cli_task {
+    Cli    *cli;
+    size_t  begin;
+    size_t  end;
+    int     first;              /* index of the first line of chunk        */
+    int     nb;                 /* number of lines of chunk                */
+    char   *out;                /* output buffer, reused between rounds    */
+    size_t  nb_out;             /* bytes in out                            */
+    size_t  cap;                /* capacity of out                         */
+} CliTask;
+
+
+/******************************************************************************/
+/*                                                                            */
+/* function defination                                                        */
+/*                                                                            */
+/******************************************************************************/
+
+
+static double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * run 'fn()' on n tasks by thread pool, or by caller if pool is NULL.
+ */
+
+static void run_tasks(ThreadPool *pool, void(*fn)(void *), CliTask *tasks,
+                      int n) {
+    TaskGrp grp;
+    if (pool == NULL) {
+        for (int i = 0; i < n; i++)
+            fn(&tasks[i]);
+        return;
+    }
+    grp_init(&grp);
+    for (int i = 0; i < n; i++)
+        pool_submit(pool, &grp, fn, &tasks[i]);
+    pool_wait(pool, &grp);
+    grp_destroy(&grp);
+}
+
+/******************************************************************************/
+/* input                                                                      */
+/******************************************************************************/
+
+/*
+ * read a stream to its end in blocks of READ_BLOCK bytes.
+ *
+ * @return 0 on success, otherwise -1.
+ */
+
+static int read_all(int fd, char **buf, size_t *size) {
+    size_t cap = READ_BLOCK, nb = 0;
+    char  *p   = (char *)malloc(cap), *t = NULL;
+    for (ssize_t r; p != NULL; nb += r) {
+        if (cap - nb < READ_BLOCK) {
+            if ((t = (char *)realloc(p, cap * 2)) == NULL)
+                break;
+            p = t, cap *= 2;
+        }
+        if ((r = read(fd, p + nb, cap - nb)) == 0) {
+            *buf  = p;
+            *size = nb;
+            return 0;
+        }
+        if (r < 0 && errno != EINTR)
+            break;
+        if (r < 0)
+            r = 0;
+    }
+    free(p);
+    return -1;
+}
+
+/*
+ * load input, a regular file is mapped unless it is also the output file,
+ * which is truncated before its lines are written.
+ *
+ * @return 1 if input is mapped, 0 if it is read, or -1 on error.
+ */
+
+static int load(const char *path, const char *out_path, char **buf,
+                size_t *size) {
+    struct stat in_st, out_st;
+    int fd = path == NULL ? STDIN_FILENO : open(path, O_RDONLY), ret = 0;
+    if (fd < 0 || fstat(fd, &in_st) < 0) {
+        fprintf(stderr, "ERROR opening %s: %s\n", path ? path : "stdin",
+                strerror(errno));
+        if (fd > STDIN_FILENO)
+            close(fd);
+        return -1;
+    }
+    if (S_ISREG(in_st.st_mode) && in_st.st_size > 0 &&
+        (out_path == NULL || stat(out_path, &out_st) < 0 ||
+         out_st.st_dev != in_st.st_dev || out_st.st_ino != in_st.st_ino)) {
+        *size = (size_t)in_st.st_size;
+        *buf  = (char *)mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (*buf != MAP_FAILED) {
+            /* advice values are not flags, so they are given one by one */
+            madvise(*buf, *size, MADV_SEQUENTIAL);
+            madvise(*buf, *size, MADV_WILLNEED);
+            ret = 1;
+        }
+    }
+    if (ret == 0 && read_all(fd, buf, size) < 0) {
+        fprintf(stderr, "ERROR reading %s\n", path ? path : "stdin");
+        ret = -1;
+    }
+    if (fd != STDIN_FILENO)
+        close(fd);
+    return ret;
+}
+
+/******************************************************************************/
+/* parse                                                                      */
+/******************************************************************************/
+
+/* exact powers of 10 of double */
+
+static const double pow10_exact[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline int is_blank(int c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/*
+ * get the start of the k-th field of line [p, end), fields are separated by
+ * delim, or by runs of blanks if delim is -1.
+ */
+
+static const char *find_field(const char *p, const char *end, int k,
+                              int delim) {
+    if (delim < 0) {
+        while (p < end && is_blank(*p))
+            p++;
+        for (; k > 1 && p < end; k--) {
+            while (p < end && !is_blank(*p))
+                p++;
+            while (p < end && is_blank(*p))
+                p++;
+        }
+        return p;
+    }
+    for (; k > 1 && p < end; k--) {
+        const char *q = (const char *)memchr(p, delim, end - p);
+        p = q == NULL ? end : q + 1;
+    }
+    while (p < end && is_blank(*p))
+        p++;
+    return p;
+}
+
+/*
+ * parse a decimal integer at the start of [p, end), saturated to range of
+ * int64_t.
+ */
+
+static int64_t parse_i64(const char *p, const char *end) {
+    uint64_t v = 0, lim;
+    int      neg = 0;
+    if (p < end && (*p == '-' || *p == '+'))
+        neg = *p++ == '-';
+    lim = neg ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    for (unsigned d; p < end && (d = (unsigned)(*p - '0')) < 10; p++)
+        v = v > (lim - d) / 10 ? lim : v * 10 + d;
+    return neg ? (int64_t)(0 - v) : (int64_t)v;
+}
+
+/*
+ * parse a double at the start of [p, end) into x.
+ *
+ * Clinger's fast path: if the decimal significand w has no more than 19
+ * digits and is less than 2 ^ 53, and the decimal exponent e is in
+ * [-22, 22], w and 10 ^ |e| are exact doubles and one multiplication or
+ * division rounds correctly. other numbers, hexadecimal ones, 'inf' and
+ * 'nan' are parsed by strtod() from a copy, since input is not terminated
+ * by '\0'.
+ *
+ * @return 0 on success, or -1 if there is no number.
+ */
+
+static int parse_dbl(const char *p, const char *end, double *x) {
+    const char *s = p;
+    char        tmp[NUM_MAX], *cp = tmp, *ep;
+    uint64_t    w = 0;
+    int         neg = 0, nd = 0, e = 0, ex = 0, exn = 0, hex;
+    if (p < end && (*p == '-' || *p == '+'))
+        neg = *p++ == '-';
+    hex = end - p > 1 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X');
+    for (; p < end && (unsigned)(*p - '0') < 10; p++, nd++)
+        w = w * 10 + (*p - '0');
+    if (p < end && *p == '.')
+        for (p++; p < end && (unsigned)(*p - '0') < 10; p++, nd++, e--)
+            w = w * 10 + (*p - '0');
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *q = p + 1;
+        if (q < end && (*q == '-' || *q == '+'))
+            exn = *q++ == '-';
+        if (q < end && (unsigned)(*q - '0') < 10) {
+            for (; q < end && (unsigned)(*q - '0') < 10; q++)
+                ex = ex < 10000 ? ex * 10 + (*q - '0') : ex;
+            e += exn ? -ex : ex;
+            p  = q;
+        }
+    }
+    if (!hex && nd > 0 && nd <= 19 && w < (1ULL << 53) &&
+        e >= -22 && e <= 22) {
+        double v = (double)w;
+        v = e < 0 ? v / pow10_exact[-e] : v * pow10_exact[e];
+        *x = neg ? -v : v;
+        return 0;
+    }
+    /* slow path, and 'inf', 'nan' or no number */
+    for (p = s; p < end && !is_blank(*p); p++)
+        ;
+    if (p - s >= NUM_MAX && (cp = (char *)malloc(p - s + 1)) == NULL)
+        cp = tmp, p = s + NUM_MAX - 1;
+    memcpy(cp, s, p - s);
+    cp[p - s] = '\0';
+    *x = strtod(cp, &ep);
+    ep = ep == cp ? NULL : ep;
+    if (cp != tmp)
+        free(cp);
+    return ep == NULL ? -1 : 0;
+}
+
+/*
+ * task counting lines of a chunk.
+ */
+
+static void count_lines(void *arg) {
+    CliTask    *t   = (CliTask *)arg;
+    const char *p   = t->cli->buf + t->begin, *end = t->cli->buf + t->end;
+    int         nb  = 0;
+    while (p < end && (p = (const char *)memchr(p, '\n', end - p)) != NULL) {
+        nb++;
+        p++;
+    }
+    if (t->end > t->begin && end[-1] != '\n')
+        nb++;
+    t->nb = nb;
+}
+
+/*
+ * task recording offsets of lines of a chunk and parsing their keys.
+ */
+
+static void parse_lines(void *arg) {
+    CliTask    *t   = (CliTask *)arg;
+    Cli        *c   = t->cli;
+    const char *p   = c->buf + t->begin, *end = c->buf + t->end, *nl, *f;
+    for (int i = t->first; p < end; i++, p = nl + 1) {
+        uint64_t k;
+        nl = (const char *)memchr(p, '\n', end - p);
+        if (nl == NULL)
+            nl = end;
+        c->line[i] = p - c->buf;
+        f = find_field(p, nl, c->field, c->delim);
+        if (c->type == K_DBL) {
+            double  x;
+            /* no number, then NaN, go before '-inf' */
+            if (parse_dbl(f, nl, &x) < 0)
+                k = 0;
+            else if (x != x)
+                k = 1;
+            else {
+                x += 0.0;                           /* -0 equals 0 */
+                k  = key_dbl(&x);
+            }
+        } else {
+            int64_t x = parse_i64(f, nl);
+            k = key_i64(&x);
+        }
+        c->key[i] = k ^ c->flip;
+    }
+}
+
+/*
+ * split input into chunks at line ends, count lines of chunks, then parse
+ * them into 'line' and 'key' at offsets got by prefix sum.
+ *
+ * @return 0 on success, otherwise -1.
+ */
+
+static int parse(Cli *c, ThreadPool *pool, CliTask *tasks, int nb_t) {
+    long long n = 0;
+    for (int i = 0; i < nb_t; i++) {
+        size_t pos = c->size / nb_t * i;
+        const char *nl;
+        if (i > 0 && pos > tasks[i - 1].begin) {
+            nl  = (const char *)memchr(c->buf + pos, '\n', c->size - pos);
+            pos = nl == NULL ? c->size : (size_t)(nl - c->buf) + 1;
+        }
+        tasks[i].cli   = c;
+        tasks[i].begin = i == 0 ? 0 : pos;
+        if (i > 0 && tasks[i].begin < tasks[i - 1].begin)
+            tasks[i].begin = tasks[i - 1].begin;
+    }
+    for (int i = 0; i < nb_t; i++)
+        tasks[i].end = i + 1 < nb_t ? tasks[i + 1].begin : c->size;
+    run_tasks(pool, count_lines, tasks, nb_t);
+    for (int i = 0; i < nb_t; i++) {
+        tasks[i].first = (int)(n < INT_MAX ? n : INT_MAX);
+        n += tasks[i].nb;
+    }
+    if (n >= INT_MAX) {
+        fprintf(stderr, "ERROR too many lines\n");
+        return -1;
+    }
+    c->n    = (int)n;
+    c->line = (size_t *)malloc(sizeof(size_t) * (n + 1));
+    c->key  = (uint64_t *)malloc(sizeof(uint64_t) * (n + 1));
+    c->idx  = (uint32_t *)malloc(sizeof(uint32_t) * (n + 1));
+    if (c->line == NULL || c->key == NULL || c->idx == NULL) {
+        fprintf(stderr, "ERROR allocating memory\n");
+        return -1;
+    }
+    c->line[n] = c->size;
+    run_tasks(pool, parse_lines, tasks, nb_t);
+    return 0;
+}
+
+/******************************************************************************/
+/* output                                                                     */
+/******************************************************************************/
+
+/*
+ * task gathering sorted lines [begin, end) into its buffer, a line without
+ * '\n' is ended by one.
+ */
+
+static void gather_lines(void *arg) {
+    CliTask *t = (CliTask *)arg;
+    Cli     *c = t->cli;
+    size_t   nb = 0;
+    char    *q  = NULL;
+    for (size_t i = t->begin; i < t->end; i++)
+        nb += c->line[c->idx[i] + 1] - c->line[c->idx[i]] + 1;
+    if (nb > t->cap) {
+        free(t->out);
+        t->cap = nb;
+        if ((t->out = (char *)malloc(nb)) == NULL) {
+            t->cap = 0;
+            t->nb_out = (size_t)-1;
+            return;
+        }
+    }
+    q = t->out;
+    for (size_t i = t->begin; i < t->end; i++) {
+        size_t from = c->line[c->idx[i]], len = c->line[c->idx[i] + 1] - from;
+        memcpy(q, c->buf + from, len);
+        q += len;
+        if (len == 0 || q[-1] != '\n')
+            *q++ = '\n';
+    }
+    t->nb_out = q - t->out;
+}
+
+static int write_all(int fd, const char *p, size_t nb) {
+    while (nb > 0) {
+        ssize_t w = write(fd, p, nb);
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w < 0)
+            return -1;
+        p  += w;
+        nb -= w;
+    }
+    return 0;
+}
+
+/*
+ * write sorted lines in rounds, in every round nb_t tasks gather OUT_LINES
+ * lines each in parallel, then buffers are written in order.
+ *
+ * @return 0 on success, otherwise -1.
+ */
+
+static int output(Cli *c, ThreadPool *pool, CliTask *tasks, int nb_t,
+                  int fd) {
+    for (size_t i = 0; i < (size_t)c->n;) {
+        int nb = 0;
+        for (; nb < nb_t && i < (size_t)c->n; nb++, i += OUT_LINES) {
+            tasks[nb].cli   = c;
+            tasks[nb].begin = i;
+            tasks[nb].end   = i + OUT_LINES < (size_t)c->n ?
+                              i + OUT_LINES : (size_t)c->n;
+        }
+        run_tasks(pool, gather_lines, tasks, nb);
+        for (int k = 0; k < nb; k++) {
+            if (tasks[k].nb_out == (size_t)-1) {
+                fprintf(stderr, "ERROR allocating memory\n");
+                return -1;
+            }
+            if (write_all(fd, tasks[k].out, tasks[k].nb_out) < 0) {
+                fprintf(stderr, "ERROR writing: %s\n", strerror(errno));
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/******************************************************************************/
+/* command line                                                               */
+/******************************************************************************/
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [-t TYPE] [-k FIELD] [-d DELIM] [-r] [-j THREADS]\n"
+            "          [-o FILE] [-v] [FILE]\n"
+            "  -t  dbl or i64 (default dbl)\n"
+            "  -k  key field, from 1 (default 1)\n"
+            "  -d  field separator character (default blanks)\n"
+            "  -r  reverse order, stable\n"
+            "  -j  threads (default all)\n"
+            "  -o  output file (default stdout)\n"
+            "  -v  report time of every step\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    const char *tname = "dbl", *in_path = NULL, *out_path = NULL;
+    int         nb_thrd = nb_hw_thrd(), verbose = 0, mapped, fd, opt;
+    int         nb_t, ret = 1;
+    double      t0, t1, t2, t3, t4;
+    char       *buf = NULL;
+    ThreadPool *pool  = NULL;
+    CliTask    *tasks = NULL;
+    Cli         c;
+
+    memset(&c, 0, sizeof(c));
+    c.field = 1;
+    c.delim = -1;
+    while ((opt = getopt(argc, argv, "t:k:d:rj:o:vh")) != -1) {
+        switch (opt) {
+        case 't': tname    = optarg;                              break;
+        case 'k': c.field  = atoi(optarg);                        break;
+        case 'd': c.delim  = (unsigned char)optarg[0];            break;
+        case 'r': c.flip   = ~0ULL;                               break;
+        case 'j': nb_thrd  = atoi(optarg);                        break;
+        case 'o': out_path = optarg;                              break;
+        case 'v': verbose  = 1;                                   break;
+        default : usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+    c.type = strcmp(tname, "dbl") == 0 ? K_DBL :
+             strcmp(tname, "i64") == 0 ? K_I64 : -1;
+    if (c.type < 0 || c.field < 1 || optind + 1 < argc) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (optind < argc && strcmp(argv[optind], "-") != 0)
+        in_path = argv[optind];
+    if (nb_thrd < 1)
+        nb_thrd = nb_hw_thrd();
+
+    t0 = wall_time();
+    if ((mapped = load(in_path, out_path, &buf, &c.size)) < 0)
+        return 1;
+    c.buf = buf;
+    t1 = wall_time();
+
+    /* 4 chunks per thread balance lines of different lengths */
+    nb_t  = nb_thrd == 1 ? 1 : 4 * nb_thrd;
+    tasks = (CliTask *)calloc(nb_t, sizeof(CliTask));
+    if (nb_thrd > 1)
+        pool = pool_create(nb_thrd - 1);
+    if (tasks == NULL) {
+        fprintf(stderr, "ERROR allocating memory\n");
+        goto end;
+    }
+    if (parse(&c, pool, tasks, nb_t) < 0)
+        goto end;
+    t2 = wall_time();
+
+    argsort_u64(c.key, c.n, c.idx);
+    t3 = wall_time();
+
+    fd = out_path == NULL ? STDOUT_FILENO :
+         open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "ERROR opening %s: %s\n", out_path, strerror(errno));
+        goto end;
+    }
+    ret = output(&c, pool, tasks, nb_t, fd) < 0 ? 1 : 0;
+    if (fd != STDOUT_FILENO && close(fd) < 0)
+        ret = 1;
+    t4 = wall_time();
+
+    if (verbose)
+        fprintf(stderr, "lines : %d, bytes : %zu, threads : %d\n"
+                "read  : %.6f s\nparse : %.6f s\nsort  : %.6f s\n"
+                "write : %.6f s\ntotal : %.6f s\n", c.n, c.size, nb_thrd,
+                t1 - t0, t2 - t1, t3 - t2, t4 - t3, t4 - t0);
+end:
+    for (int i = 0; tasks != NULL && i < nb_t; i++)
+        free(tasks[i].out);
+    free(tasks);
+    if (pool != NULL)
+        pool_destroy(pool);
+    free(c.idx);
+    free(c.key);
+    free(c.line);
+    if (mapped)
+        munmap(buf, c.size);
+    else
+        free(buf);
+    return ret;
+}
@@ -0,0 +1,418 @@
+/**
+ * @file sort_tpl.cpp
+ * source file contains of C interface of typed sort algorithm, and of
+ * insert, select, bubble, heap, quick, block quick, intro, three-way quick,
+ * merge and shell sort based on pointer, heap functions, BFPRT and argsort,
+ * every function is a thin wrapper over a template in 'sort_algo.hpp'.
+ *
+ * functions based on pointer wrap the compare function of caller by
+ * 'cmp_func_p', so they behave as the C implementation did, while the
+ * algorithm exists only once.
+ *
+ * @author  duruyao
+ * @version 1.0  19-12-19
+ * @update  [id] [yy-mm-dd] [author] [description]
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+#include <utility>
+#include <algorithm>
+
+#define STAT_HOOK_ALLOC
+#include "perf_stat.h"
+#include "sort_algo.h"
+#include "sort_algo.hpp"
+
+using namespace sort_algo;
+
+typedef cmp_val<double>   Cmp_dbl;
+typedef cmp_deref<Cmp_dbl> Cmp_dbl_p;
+typedef cmp_func_p        Cmp_p;
+
+
+/******************************************************************************/
+/*                                                                            */
+/* function defination                                                        */
+/*                                                                            */
+/******************************************************************************/
+
+
+/*
+ * merge sort by 'm_sort()', scratch is allocated by malloc(3) instead of
+ * 'new', so that allocation hooks count it.
+ */
+
+template <typename T, typename Cmp>
+static void merge_sort_c(T *arr, int n, Cmp cmp) {
+    T *copy = NULL;
+    if (n <= 1)
+        return;
+    if ((copy = (T *)malloc(sizeof(T) * n)) == NULL) {
+        fprintf(stderr, "ERROE allocating memory\n");
+        return;
+    }
+    memcpy(copy, arr, sizeof(T) * n);
+    m_sort(copy, arr, 0, n, cmp);
+    free(copy);
+}
+
+/******************************************************************************/
+/* typed sort based on value                                                  */
+/******************************************************************************/
+
+void insert_sort_dbl(double *arr, int n) {
+    insert_sort(arr, n, Cmp_dbl());
+}
+
+void select_sort_dbl(double *arr, int n) {
+    select_sort(arr, n, Cmp_dbl());
+}
+
+void bubble_sort_dbl(double *arr, int n) {
+    bubble_sort(arr, n, Cmp_dbl());
+}
+
+void heap_sort_dbl(double *arr, int n) {
+    heap_sort(arr, n, Cmp_dbl());
+}
+
+void quick_sort_dbl(double *arr, int begin, int end) {
+    intro_sort(arr, begin, end, Cmp_dbl());
+}
+
+void quick_sort_block_dbl(double *arr, int begin, int end) {
+    intro_sort_block(arr, begin, end, Cmp_dbl());
+}
+
+void merge_sort_dbl(double *arr, int n) {
+    merge_sort_c(arr, n, Cmp_dbl());
+}
+
+void shell_sort_dbl(double *arr, int n) {
+    shell_sort(arr, n, Cmp_dbl());
+}
+
+/******************************************************************************/
+/* typed sort based on pointer                                                */
+/******************************************************************************/
+
+void insert_sort_dbl_p(double **arr, int n) {
+    insert_sort(arr, n, Cmp_dbl_p());
+}
+
+void select_sort_dbl_p(double **arr, int n) {
+    select_sort(arr, n, Cmp_dbl_p());
+}
+
+void bubble_sort_dbl_p(double **arr, int n) {
+    bubble_sort(arr, n, Cmp_dbl_p());
+}
+
+void heap_sort_dbl_p(double **arr, int n) {
+    heap_sort(arr, n, Cmp_dbl_p());
+}
+
+void quick_sort_dbl_p(double **arr, int begin, int end) {
+    intro_sort(arr, begin, end, Cmp_dbl_p());
+}
+
+void merge_sort_dbl_p(double **arr, int n) {
+    merge_sort_c(arr, n, Cmp_dbl_p());
+}
+
+void shell_sort_dbl_p(double **arr, int n) {
+    shell_sort(arr, n, Cmp_dbl_p());
+}
+
+/******************************************************************************/
+/* sort based on pointer                                                      */
+/******************************************************************************/
+
+void insert_sort_p(void **arr, int n,
+                   int(*cmp)(const void *, const void *)) {
+    insert_sort(arr, n, Cmp_p{cmp});
+}
+
+void select_sort_p(void **arr, int n,
+                   int(*cmp)(const void *, const void *)) {
+    select_sort(arr, n, Cmp_p{cmp});
+}
+
+void bubble_sort_p(void **arr, int n,
+                   int(*cmp)(const void *, const void *)) {
+    bubble_sort(arr, n, Cmp_p{cmp});
+}
+
+void heapify_p(void **arr, int begin, int end,
+               int(*cmp)(const void *, const void *)) {
+    heapify(arr, begin, end, Cmp_p{cmp});
+}
+
+void heap_build_p(void **arr, int k,
+                  int(*cmp)(const void *, const void *)) {
+    heap_build(arr, k, Cmp_p{cmp});
+}
+
+/*
+ * move a hole at node i of a heap of n elements and arity d (2, 4 or 8)
+ * down, or up, until x fits in it.
+ */
+
+void heap_sift_down_d_p(void **arr, int i, int n, int d, void *x,
+                        int(*cmp)(const void *, const void *)) {
+    switch (d) {
+    case 4:  dh_sift_down<4>(arr, i, n, x, Cmp_p{cmp}); break;
+    case 8:  dh_sift_down<8>(arr, i, n, x, Cmp_p{cmp}); break;
+    default: dh_sift_down<2>(arr, i, n, x, Cmp_p{cmp}); break;
+    }
+}
+
+void heap_sift_up_d_p(void **arr, int i, int d, void *x,
+                      int(*cmp)(const void *, const void *)) {
+    switch (d) {
+    case 4:  dh_sift_up<4>(arr, i, x, Cmp_p{cmp}); break;
+    case 8:  dh_sift_up<8>(arr, i, x, Cmp_p{cmp}); break;
+    default: dh_sift_up<2>(arr, i, x, Cmp_p{cmp}); break;
+    }
+}
+
+/*
+ * insert a new element into a heap.
+ *
+ * @param arr is an allocated array of pointers to opaque type data, the arr
+ *            store elements of heap, the array has stored elements of an
+ *            ordered heap.
+ * @param x   is a pointer to opaque element who will be inserted in the heap.
+ * @param n   is the current number of elements in heap.
+ * @param k   is the max number of elements in heap.
+ * @param cmp is a pointer to a function comparing elements.
+ */
+
+void heap_insert_p(void **arr, void *x, int n, int k,
+                   int(*cmp)(const void *, const void *)) {
+    if (n + 1 > k)
+        return;
+    dh_sift_up<2>(arr, n, x, Cmp_p{cmp});
+}
+
+/*
+ * replace the top of heap and keep the nature of heap.
+ *
+ * @param arr is an allocated array of pointers to opaque type data, the arr
+ *            store elements of heap, the array has stored elements of an
+ *            ordered heap.
+ * @param x   is a pointer to opaque element who will be new top of heap.
+ * @param n   is the number of elements in old heap.
+ * @param cmp is a pointer to a function comparing elements.
+ */
+
+void heap_repl_p(void **arr, void *x, int n,
+                 int(*cmp)(const void *, const void *)) {
+    dh_sift_down<2>(arr, 0, n, x, Cmp_p{cmp});
+}
+
+/*
+ * delete top of heap and keep the nature of heap.
+ *
+ * @param arr is an allocated array of pointers to opaque type data, the arr
+ *            store elements of heap, the array has stored elements of an
+ *            ordered heap.
+ * @param n   is the number of elements in old heap.
+ * @param cmp is a pointer to a function comparing elements.
+ *
+ * @return a pointer to the top element of heap.
+ */
+
+void *heap_del_p(void **arr, int n,
+                 int(*cmp)(const void *, const void *)) {
+    void *ret = arr[0], *last = arr[n - 1];
+    arr[n - 1] = NULL;
+    if (n > 1)
+        dh_sift_down<2>(arr, 0, n - 1, last, Cmp_p{cmp});
+    return ret;
+}
+
+void heap_sort_p(void **arr, int n,
+                 int(*cmp)(const void *, const void *)) {
+    heap_sort_d<2>(arr, n, Cmp_p{cmp});
+}
+
+/*
+ * heap sort function based on pointer, by a heap of arity d.
+ *
+ * heap sort only pops, whose bottom-up sift costs about log2(n) comparisons
+ * on a binary heap, but (d - 1) * logd(n) on a d-ary one, e.g. 1.5 * log2(n)
+ * if d is 4. the shallower heap saves cache misses on large arrays, which
+ * about pays for the extra comparisons of cheap compare functions, so
+ * 'heap_sort_p()' is binary.
+ *
+ * @param arr is an allocated array of pointers to opaque type data.
+ * @param n   is number of elements in the array.
+ * @param d   is arity of heap, 2, 4 or 8, other values are taken as 2.
+ * @param cmp is a pointer to a function comparing elements.
+ */
+
+void heap_sort_d_p(void **arr, int n, int d,
+                   int(*cmp)(const void *, const void *)) {
+    switch (d) {
+    case 4:  heap_sort_d<4>(arr, n, Cmp_p{cmp}); break;
+    case 8:  heap_sort_d<8>(arr, n, Cmp_p{cmp}); break;
+    default: heap_sort_d<2>(arr, n, Cmp_p{cmp}); break;
+    }
+}
+
+/*
+ * quick sort is intro sort, whose ninther pivot is much cheaper than BFPRT
+ * median, 'quick_sort_bfprt_p()' is quick sort by BFPRT pivot.
+ */
+
+void quick_sort_p(void **arr, int begin, int end,
+                  int(*cmp)(const void *, const void *)) {
+    intro_sort(arr, begin, end, Cmp_p{cmp});
+}
+
+void quick_sort_bfprt_p(void **arr, int begin, int end,
+                        int(*cmp)(const void *, const void *)) {
+    quick_sort(arr, begin, end, Cmp_p{cmp});
+}
+
+/*
+ * quick sort is intro sort partitioning by BlockQuicksort, it is chosen by
+ * calling it, so no other sort in flight changes.
+ */
+
+void quick_sort_block_p(void **arr, int begin, int end,
+                        int(*cmp)(const void *, const void *)) {
+    intro_sort_block(arr, begin, end, Cmp_p{cmp});
+}
+
+void intro_sort_p(void **arr, int begin, int end,
+                  int(*cmp)(const void *, const void *)) {
+    intro_sort(arr, begin, end, Cmp_p{cmp});
+}
+
+void quick_sort_3way_p(void **arr, int begin, int end,
+                       int(*cmp)(const void *, const void *)) {
+    quick_sort_3way(arr, begin, end, Cmp_p{cmp});
+}
+
+void m_sort_p(void **copy, void **result, int begin, int end,
+              int(*cmp)(const void *, const void *)) {
+    m_sort(copy, result, begin, end, Cmp_p{cmp});
+}
+
+void merge_sort_p(void **arr, int n,
+                  int(*cmp)(const void *, const void *)) {
+    merge_sort_c(arr, n, Cmp_p{cmp});
+}
+
+void shell_sort_p(void **arr, int n,
+                  int(*cmp)(const void *, const void *)) {
+    shell_sort(arr, n, Cmp_p{cmp});
+}
+
+/*
+ * generate a gap array for shell sort.
+ *
+ * @param gap is a pointer to an address of gap array, which will be allocated
+ *            memory in function and should be released by caller.
+ * @param n   is number of elements of input set.
+ *
+ * @return size of gap array on success, otherwise -1.
+ */
+
+int gen_gap_p(int **gap, int n) {
+    int seq[GAP_MAX], k = gen_gap(seq, n);
+    int *p = NULL;
+    if (k == 0)
+        return 0;
+    if ((p = (int *)realloc(*gap, sizeof(int) * k)) == NULL)
+        return -1;
+    *gap = p;
+    memcpy(*gap, seq, sizeof(int) * k);
+    return k;
+}
+
+/*
+ * generate gaps for shell sort into gap, an array of GAP_MAX integers.
+ *
+ * @return size of gap array.
+ */
+
+int gen_gap_buf(int *gap, int n) {
+    return gen_gap(gap, n);
+}
+
+int BFPRT_p_idx_p(void **arr, int begin, int end,
+                  int(*cmp)(const void *, const void *)) {
+    return BFPRT_p_idx(arr, begin, end, Cmp_p{cmp});
+}
+
+int partition_p(void **arr, int begin, int end, int pivot_idx,
+                int(*cmp)(const void *, const void *)) {
+    return partition(arr, begin, end, pivot_idx, Cmp_p{cmp});
+}
+
+int BFPRT_k_idx_p(void **arr, int begin, int end, int k,
+                  int(*cmp)(const void *, const void *)) {
+    return BFPRT_k_idx(arr, begin, end, k, Cmp_p{cmp});
+}
+
+int BFPRT_k_idx_block_p(void **arr, int begin, int end, int k,
+                        int(*cmp)(const void *, const void *)) {
+    return BFPRT_k_idx(arr, begin, end, k, Cmp_p{cmp}, true);
+}
+
+/*
+ * fill indices 0 .. n - 1 to be sorted. elements are compared by a 'cmp_idx'
+ * functor of the array, so an argsort called by 'cmp()' of another one shares
+ * no state with it.
+ */
+
+static void arg_fill(uint32_t *idx, int n) {
+    for (int i = 0; i < n; i++)
+        idx[i] = (uint32_t)i;
+}
+
+/*
+ * argsort function, it is not stable.
+ *
+ * time  complexity: O(n * log n)
+ * space complexity: O(log n)
+ *
+ * @param base is an allocated array of opaque type data, it is not changed.
+ * @param n    is number of elements in the array.
+ * @param s    is size of target element bytes.
+ * @param cmp  is a pointer to a function comparing elements.
+ * @param idx  is an allocated array of n indices, to get the permutation.
+ */
+
+void argsort(const void *base, int n, size_t s,
+             int(*cmp)(const void *, const void *), uint32_t *idx) {
+    arg_fill(idx, n);
+    intro_sort(idx, 0, n, cmp_idx{(const unsigned char *)base, s, cmp});
+}
+
+/*
+ * argsort function, it is stable, indices of equal elements are ascending.
+ *
+ * time  complexity: O(n * log n)
+ * space complexity: O(n)
+ *
+ * @param base is an allocated array of opaque type data, it is not changed.
+ * @param n    is number of elements in the array.
+ * @param s    is size of target element bytes.
+ * @param cmp  is a pointer to a function comparing elements.
+ * @param idx  is an allocated array of n indices, to get the permutation.
+ */
+
+void argsort_stable(const void *base, int n, size_t s,
+                    int(*cmp)(const void *, const void *), uint32_t *idx) {
+    arg_fill(idx, n);
+    merge_sort_c(idx, n, cmp_idx{(const unsigned char *)base, s, cmp});
+}
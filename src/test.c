@@ -8,13 +8,18 @@
  */
 
 #include <time.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <unistd.h>
 #include <inttypes.h>
 
 #include "sort_algo.h"
+#include "perf_stat.h"
+#include "thread_pool.h"
+#include "ext_sort.h"
 
 #define ELEM_NUM    (256 * 256)
 #define SAMPLE_NUM  (ELEM_NUM <= 128 ? ELEM_NUM : 128)
@@ -31,16 +36,86 @@
                     "time of sort: [ %lf S ]\n"         \
                     "have checked: %s\n"
 
+#define SCALE_NUM   (1 << 22)
+#define SCALE_STR   "threads     : %-3d time of sort: [ %lf S ] "      \
+                    "speedup: [ x%.2f ] %s\n"
+#define ROW_STR     "%-12s: time of sort: [ %lf S ] speedup: [ x%.2f ] %s\n"
+
+#define EXT_NUM     (1 << 22)
+#define EXT_MEM     (1 << 22)
+#define EXT_FAN_IN  8
+
+#define TOP_K       1000
+#define TOP_BATCH   4096
+
+#define STR_NUM     (1 << 20)
+#define STR_LEN     64
+
+#define MERGE_K     16
+
+#define SEG_NUM     (1 << 18)
+#define SEG_MIN     4
+#define SEG_MAX     256
+
+#define SIMD_NUM    ((1 << 16) + 13)
+#define SIMD_SEG    40
+
+#define CLI_NUM     (1 << 16)
+#define CLI_CMD     512
+
+#define GAIN_STR    "speedup     : [ x%.2f ] vs. void ** version\n"
+
 void rand_arr(double *, double **, double, double, unsigned);
 
-void print_info(double **, char *, double, int, int);
+void print_info(double **, char *, double, double, int, int);
 
 int check_ok(double **);
 
+const char *check_str(int);
+
+void print_row(const char *, double, double, int);
+
+double wall_time(void);
+
+void scale_test(char *, void(*)(void **, int, int));
+
+void ext_test(void);
+
+void cli_test(void);
+
+void top_k_test(void);
+
+void sel_scale_test(void);
+
+void nth_test(void);
+
+void str_test(void);
+
+void arg_test(void);
+
+void seg_test(void);
+
+void simd_test(void);
+
+void set_test(void);
+
+void heap_test(void);
+
+void quick_par(void **, int, int);
+
+void bucket_par(void **, int, int);
+
+void merge_par(void **, int, int);
+
+/* number of checks not passed, the exit status is nonzero if any */
+
+static int nb_fail = 0;
+
 int main(int argc, char **argv) {
     clock_t begin;
     clock_t end;
     double  cost_time;
+    double  base_time;
     
     double  min = 256.0;
     double  max = 65536.0;
@@ -53,7 +128,7 @@ int main(int argc, char **argv) {
     insert_sort_p((void **)ptr, ELEM_NUM, &cmp_dbl);
     end = clock();
     cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
-    print_info(ptr, "insert", cost_time, check_ok(ptr), NO_SHOW);
+    print_info(ptr, "insert", cost_time, 0, check_ok(ptr), NO_SHOW);
     
     
     rand_arr(val, ptr, min, max, SEED);
@@ -61,7 +136,7 @@ int main(int argc, char **argv) {
     select_sort_p((void **)ptr, ELEM_NUM, &cmp_dbl);
     end = clock();
     cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
-    print_info(ptr, "select", cost_time, check_ok(ptr), NO_SHOW);
+    print_info(ptr, "select", cost_time, 0, check_ok(ptr), NO_SHOW);
     
     
     rand_arr(val, ptr, min, max, SEED);
@@ -69,7 +144,7 @@ int main(int argc, char **argv) {
     bubble_sort_p((void **)ptr, ELEM_NUM, &cmp_dbl);
     end = clock();
     cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
-    print_info(ptr, "bubble", cost_time, check_ok(ptr), NO_SHOW);
+    print_info(ptr, "bubble", cost_time, 0, check_ok(ptr), NO_SHOW);
     
     
     rand_arr(val, ptr, min, max, SEED);
@@ -77,7 +152,24 @@ int main(int argc, char **argv) {
     heap_sort_p((void **)ptr, ELEM_NUM, &cmp_dbl);
     end = clock();
     cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
-    print_info(ptr, "heap", cost_time, check_ok(ptr), NO_SHOW);
+    print_info(ptr, "heap", cost_time, 0, check_ok(ptr), NO_SHOW);
+    base_time = cost_time;
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    heap_sort_dbl_p(ptr, ELEM_NUM);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "heap tpl", cost_time, base_time, check_ok(ptr), NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    heap_sort(val, ELEM_NUM, sizeof(double), &cmp_dbl);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "heap val", cost_time, base_time, check_ok(ptr), NO_SHOW);
     
     
     rand_arr(val, ptr, min, max, SEED);
@@ -85,7 +177,95 @@ int main(int argc, char **argv) {
     quick_sort_p((void **)ptr, 0, ELEM_NUM, &cmp_dbl);
     end = clock();
     cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
-    print_info(ptr, "quick", cost_time, check_ok(ptr), NO_SHOW);
+    print_info(ptr, "quick", cost_time, 0, check_ok(ptr), NO_SHOW);
+    base_time = cost_time;
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    quick_sort_bfprt_p((void **)ptr, 0, ELEM_NUM, &cmp_dbl);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "quick bfprt", cost_time, base_time, check_ok(ptr),
+               NO_SHOW);
+
+
+    rand_arr(val, ptr, min, min, SEED);
+    begin = clock();
+    quick_sort_p((void **)ptr, 0, ELEM_NUM, &cmp_dbl);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "quick equal keys", cost_time, 0, check_ok(ptr), NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    quick_sort_dbl_p(ptr, 0, ELEM_NUM);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "quick tpl", cost_time, base_time, check_ok(ptr), NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    quick_sort(val, ELEM_NUM, sizeof(double), &cmp_dbl);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "quick val", cost_time, base_time, check_ok(ptr), NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    sort_f64(val, ELEM_NUM);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "quick simd", cost_time, base_time, check_ok(ptr), NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    intro_sort_p((void **)ptr, 0, ELEM_NUM, &cmp_dbl);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "intro", cost_time, base_time, check_ok(ptr), NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    quick_sort_3way_p((void **)ptr, 0, ELEM_NUM, &cmp_dbl);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "quick 3-way", cost_time, base_time, check_ok(ptr),
+               NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    quick_sort_block_p((void **)ptr, 0, ELEM_NUM, &cmp_dbl);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "quick block", cost_time, base_time, check_ok(ptr),
+               NO_SHOW);
+
+
+    rand_arr(val, ptr, min, min + 4.0, SEED);
+    for (int i = 0; i < ELEM_NUM; i++)
+        val[i] = (double)(int)val[i];
+    begin = clock();
+    quick_sort_block_p((void **)ptr, 0, ELEM_NUM, &cmp_dbl);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "quick block few keys", cost_time, 0, check_ok(ptr),
+               NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    quick_sort_block_dbl(val, 0, ELEM_NUM);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "quick block tpl", cost_time, base_time, check_ok(ptr),
+               NO_SHOW);
     
     
     rand_arr(val, ptr, min, max, SEED);
@@ -93,7 +273,39 @@ int main(int argc, char **argv) {
     bucket_sort_p((void **)ptr, ELEM_NUM, &nb_bkts_p, &hash_idx_p, &cmp_dbl);
     end = clock();
     cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
-    print_info(ptr, "bucket", cost_time, check_ok(ptr), NO_SHOW);
+    print_info(ptr, "bucket", cost_time, 0, check_ok(ptr), NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    sample_sort_p((void **)ptr, ELEM_NUM, &cmp_dbl);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "sample", cost_time, 0, check_ok(ptr), NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    radix_sort_p((void **)ptr, ELEM_NUM, &key_dbl);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "radix", cost_time, 0, check_ok(ptr), NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    key_sort_p((void **)ptr, ELEM_NUM, &key_dbl, &cmp_dbl);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "key prefix", cost_time, 0, check_ok(ptr), NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    radix_sort_dbl(val, ELEM_NUM);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "radix val", cost_time, 0, check_ok(ptr), NO_SHOW);
 
 
     rand_arr(val, ptr, min, max, SEED);
@@ -101,7 +313,32 @@ int main(int argc, char **argv) {
     merge_sort_p((void **)ptr, ELEM_NUM, &cmp_dbl);
     end = clock();
     cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
-    print_info(ptr, "merge", cost_time, check_ok(ptr), NO_SHOW);
+    print_info(ptr, "merge", cost_time, 0, check_ok(ptr), NO_SHOW);
+    base_time = cost_time;
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    merge_sort_dbl_p(ptr, ELEM_NUM);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "merge tpl", cost_time, base_time, check_ok(ptr), NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    merge_sort(val, ELEM_NUM, sizeof(double), &cmp_dbl);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "merge val", cost_time, base_time, check_ok(ptr), NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    tim_sort_p((void **)ptr, ELEM_NUM, &cmp_dbl);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "tim", cost_time, 0, check_ok(ptr), NO_SHOW);
     
     
     rand_arr(val, ptr, min, max, SEED);
@@ -109,10 +346,43 @@ int main(int argc, char **argv) {
     shell_sort_p((void **)ptr, ELEM_NUM, &cmp_dbl);
     end = clock();
     cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
-    print_info(ptr, "shell", cost_time, check_ok(ptr), NO_SHOW);
+    print_info(ptr, "shell", cost_time, 0, check_ok(ptr), NO_SHOW);
+    base_time = cost_time;
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    shell_sort_dbl_p(ptr, ELEM_NUM);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "shell tpl", cost_time, base_time, check_ok(ptr), NO_SHOW);
+
+
+    rand_arr(val, ptr, min, max, SEED);
+    begin = clock();
+    shell_sort(val, ELEM_NUM, sizeof(double), &cmp_dbl);
+    end = clock();
+    cost_time = (double)(end - begin) / CLOCKS_PER_SEC;
+    print_info(ptr, "shell val", cost_time, base_time, check_ok(ptr), NO_SHOW);
     
     
-    return 0;
+    top_k_test();
+    scale_test("parallel quick", &quick_par);
+    scale_test("parallel bucket", &bucket_par);
+    scale_test("parallel merge", &merge_par);
+    nth_test();
+    str_test();
+    arg_test();
+    seg_test();
+    simd_test();
+    set_test();
+    heap_test();
+    sel_scale_test();
+    ext_test();
+    cli_test();
+
+
+    return nb_fail == 0 ? 0 : 1;
 }
 
 void rand_arr(double *val, double **ptr, 
@@ -128,17 +398,38 @@ void rand_arr(double *val, double **ptr,
 }
 
 int check_ok(double **ptr) {
-    for (int i = 0; i < ELEM_NUM - GAP_NUM; i += GAP_NUM)
-        if (*(ptr[i]) > *(ptr[i + GAP_NUM])) return 0;
+    for (int i = 0; i < ELEM_NUM - 1; i++)
+        if (*(ptr[i]) > *(ptr[i + 1])) return 0;
     return 1;
 }
 
-void print_info(double **ptr, char *algo_name,
-                double cost_time, int pass, int show) {
+/*
+ * @return "pass" or "no pass" to print, a check not passed is counted.
+ */
+
+const char *check_str(int pass) {
+    if (!pass)
+        nb_fail++;
+    return pass ? "pass" : "no pass";
+}
+
+/*
+ * print a row of a test comparing sort functions against the first one.
+ */
+
+void print_row(const char *name, double cost_time, double base_time,
+               int pass) {
+    printf(ROW_STR, name, cost_time, base_time / cost_time, check_str(pass));
+}
+
+void print_info(double **ptr, char *algo_name, double cost_time,
+                double base_time, int pass, int show) {
     printf(FORMAT_STR, algo_name,
            (uint64_t)ELEM_NUM, (float)ELEM_NUM / 1024, 
            (float)ELEM_NUM / (1024 * 1024), cost_time, 
-           pass == 1 ? "pass" : "no pass");
+           check_str(pass == 1));
+    if (base_time > 0 && cost_time > 0)
+        printf(GAIN_STR, base_time / cost_time);
     if (show == 1) {
         for (int i = 0, j = 0; i < ELEM_NUM; j++) {
             printf("%10.3lf ", *(ptr[i]));
@@ -150,3 +441,843 @@ void print_info(double **ptr, char *algo_name,
     printf("------------------------------------------------\n");
 }
 
+double wall_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * run a parallel sort from 1 thread up to all hardware threads, and check
+ * the result against 'quick_sort_p()'.
+ */
+
+void scale_test(char *algo_name, void(*sort)(void **, int, int)) {
+    int     nb_hw = nb_hw_thrd();
+    double  base_time = 0, cost_time, begin;
+    double *val = (double *)malloc(sizeof(double) * SCALE_NUM);
+    double **ptr = (double **)malloc(sizeof(double *) * SCALE_NUM);
+    double **ref = (double **)malloc(sizeof(double *) * SCALE_NUM);
+    if (val == NULL || ptr == NULL || ref == NULL) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        nb_fail++;
+        goto end;
+    }
+    srand(SEED);
+    for (int i = 0; i < SCALE_NUM; i++) {
+        val[i] = RAND_DBL(256.0, 65536.0);
+        ref[i] = &val[i];
+    }
+    quick_sort_p((void **)ref, 0, SCALE_NUM, &cmp_dbl);
+    printf("algorithm   : %s sort\n"
+           "size of set : %d = %.3f M\n", algo_name,
+           SCALE_NUM, (float)SCALE_NUM / (1024 * 1024));
+    for (int t = 1, pass; ; t = t * 2 < nb_hw ? t * 2 : nb_hw) {
+        for (int i = 0; i < SCALE_NUM; i++)
+            ptr[i] = &val[i];
+        begin = wall_time();
+        sort((void **)ptr, SCALE_NUM, t);
+        cost_time = wall_time() - begin;
+        if (t == 1)
+            base_time = cost_time;
+        pass = 1;
+        for (int i = 0; pass && i < SCALE_NUM; i++)
+            pass = *(ptr[i]) == *(ref[i]);
+        printf(SCALE_STR, t, cost_time, base_time / cost_time,
+               check_str(pass));
+        if (t == nb_hw)
+            break;
+    }
+    printf("------------------------------------------------\n");
+end:
+    free(ref);
+    free(ptr);
+    free(val);
+}
+
+/*
+ * @return a key field in a format chosen by r: decimal, exponent, hexadecimal
+ *         integer or floating point, infinity, NaN, or no number at all.
+ */
+
+static void cli_key(char *buf, size_t len, int r) {
+    switch (r % 12) {
+    case 0:  snprintf(buf, len, "%d", rand() % 2001 - 1000);             break;
+    case 1:  snprintf(buf, len, "%.3f", RAND_DBL(-100.0, 100.0));       break;
+    case 2:  snprintf(buf, len, "%.2e", RAND_DBL(-1e6, 1e6));           break;
+    case 3:  snprintf(buf, len, "0x%x", rand() % 4096);                 break;
+    case 4:  snprintf(buf, len, "-0X%X", rand() % 4096);                break;
+    case 5:  snprintf(buf, len, "%a", RAND_DBL(-512.0, 512.0));         break;
+    case 6:  snprintf(buf, len, "%s", rand() % 2 ? "inf" : "-Infinity"); break;
+    case 7:  snprintf(buf, len, "%s", rand() % 2 ? "nan" : "NAN");      break;
+    case 8:  snprintf(buf, len, "%s", rand() % 2 ? "abc" : "");         break;
+    case 9:  snprintf(buf, len, "%d", rand() % 8);                      break;
+    default: snprintf(buf, len, "%.1f", (double)(rand() % 64) / 4);     break;
+    }
+}
+
+/*
+ * sort lines of keys in many formats by 'sort_cli' and by
+ * 'LC_ALL=C sort -g -s', blank and comma separated, forward and reverse,
+ * by the 1st and the 2nd field, outputs must be the same byte by byte. the
+ * last field of a line is its line number, so any unstable order is seen.
+ * GNU sort does not keep input order of equal NaNs in reverse, so lines of
+ * NaN are left out of reverse cases.
+ */
+
+void cli_test(void) {
+    const char *arg[][2] = {
+        {"",               ""},
+        {"-r",             "-r"},
+        {"-k 2",           "-k2,2"},
+        {"-k 2 -r -j 1",   "-k2,2 -r"},
+        {"-d , -k 2",      "-t , -k2,2"},
+        {"-d , -r -t dbl", "-t , -r"},
+    };
+    char  in[]  = "/tmp/cli_in_XXXXXX";
+    char  csv[] = "/tmp/cli_csv_XXXXXX";
+    char  out[] = "/tmp/cli_out_XXXXXX";
+    char  ref[] = "/tmp/cli_ref_XXXXXX";
+    char  cmd[CLI_CMD], k1[64], k2[64];
+    int   fd[4], nb = (int)(sizeof(arg) / sizeof(arg[0])), pass;
+    FILE *fp_in = NULL, *fp_csv = NULL;
+    fd[0] = mkstemp(in);
+    fd[1] = mkstemp(csv);
+    fd[2] = mkstemp(out);
+    fd[3] = mkstemp(ref);
+    for (int i = 2; i < 4; i++)
+        if (fd[i] >= 0)
+            close(fd[i]);
+    if (fd[0] >= 0)
+        fp_in = fdopen(fd[0], "w");
+    if (fd[1] >= 0)
+        fp_csv = fdopen(fd[1], "w");
+    if (fp_in == NULL || fp_csv == NULL || fd[2] < 0 || fd[3] < 0) {
+        fprintf(stderr, "ERROR creating test file.\n");
+        nb_fail++;
+        if (fp_in == NULL && fd[0] >= 0)
+            close(fd[0]);
+        if (fp_csv == NULL && fd[1] >= 0)
+            close(fd[1]);
+        goto end;
+    }
+    srand(SEED);
+    for (int i = 0; i < CLI_NUM; i++) {
+        cli_key(k1, sizeof(k1), rand());
+        cli_key(k2, sizeof(k2), rand());
+        if (k1[0] == '\0')
+            k1[0] = '-', k1[1] = '\0';
+        if (k2[0] == '\0')
+            k2[0] = '-', k2[1] = '\0';
+        fprintf(fp_in, "%s%s %s #%d\n", i % 5 ? "" : "  ", k1, k2, i);
+        fprintf(fp_csv, "%s,%s,#%d\n", k1, k2, i);
+    }
+    fclose(fp_in), fp_in = NULL;
+    fclose(fp_csv), fp_csv = NULL;
+
+    printf("algorithm   : sort command vs. LC_ALL=C sort -g -s\n"
+           "size of set : %d lines\n", CLI_NUM);
+    for (int i = 0; i < nb; i++) {
+        const char *file = strstr(arg[i][0], "-d ,") ? csv : in;
+        int         rev  = strstr(arg[i][0], "-r") != NULL;
+        snprintf(cmd, sizeof(cmd), "./sort_cli %s -o %s %s", arg[i][0], out,
+                 file);
+        pass = system(cmd) == 0;
+        snprintf(cmd, sizeof(cmd), "LC_ALL=C sort -g -s %s %s %s > %s",
+                 arg[i][1], file, rev ? "| grep -iv nan" : "", ref);
+        pass = pass && system(cmd) == 0;
+        snprintf(cmd, sizeof(cmd), "%s %s | cmp -s - %s",
+                 rev ? "grep -iv nan" : "cat", out, ref);
+        pass = pass && system(cmd) == 0;
+        printf("%-28s: %s\n", arg[i][0][0] ? arg[i][0] : "(no option)",
+               check_str(pass));
+    }
+    printf("------------------------------------------------\n");
+end:
+    if (fp_in != NULL)
+        fclose(fp_in);
+    if (fp_csv != NULL)
+        fclose(fp_csv);
+    unlink(in);
+    unlink(csv);
+    unlink(out);
+    unlink(ref);
+}
+
+/*
+ * sort a file of doubles 8 times larger than memory budget by 'ext_sort()',
+ * and check the result.
+ */
+
+void ext_test(void) {
+    char    path[] = "/tmp/ext_test_XXXXXX";
+    double *val    = (double *)malloc(sizeof(double) * EXT_NUM);
+    double  begin, cost_time;
+    ExtCfg  cfg    = {EXT_MEM, NULL, EXT_FAN_IN};
+    FILE   *fp     = NULL;
+    int     fd, pass = 0;
+    if (val == NULL || (fd = mkstemp(path)) < 0) {
+        fprintf(stderr, "ERROR creating test file.\n");
+        free(val);
+        return;
+    }
+    fp = fdopen(fd, "w+b");
+    srand(SEED);
+    for (int i = 0; i < EXT_NUM; i++)
+        val[i] = RAND_DBL(256.0, 65536.0);
+    fwrite(val, sizeof(double), EXT_NUM, fp);
+    fflush(fp);
+    begin = wall_time();
+    if (ext_sort(path, path, sizeof(double), &cmp_dbl, &cfg) == 0) {
+        cost_time = wall_time() - begin;
+        rewind(fp);
+        pass = fread(val, sizeof(double), EXT_NUM, fp) == EXT_NUM;
+        for (int i = 1; pass && i < EXT_NUM; i++)
+            pass = val[i - 1] <= val[i];
+    } else
+        cost_time = wall_time() - begin;
+    printf("algorithm   : external merge sort\n"
+           "size of set : %d = %.3f M, memory: %.3f M, fan-in: %d\n"
+           "time of sort: [ %lf S ]\n"
+           "have checked: %s\n", EXT_NUM, (float)EXT_NUM / (1024 * 1024),
+           (float)EXT_MEM / (1024 * 1024), EXT_FAN_IN, cost_time,
+           check_str(pass));
+    printf("------------------------------------------------\n");
+    fclose(fp);
+    unlink(path);
+    free(val);
+}
+
+/*
+ * select the TOP_K largest of SCALE_NUM elements pushed in batches into two
+ * accumulators, merge them, and check the result against 'quick_sort_p()'.
+ */
+
+void top_k_test(void) {
+    double  *val = (double *)malloc(sizeof(double) * SCALE_NUM);
+    double **ptr = (double **)malloc(sizeof(double *) * SCALE_NUM);
+    double **out = (double **)malloc(sizeof(double *) * TOP_K);
+    TopK    *tk1 = top_k_create(TOP_K, &cmp_dbl_rev);
+    TopK    *tk2 = top_k_create(TOP_K, &cmp_dbl_rev);
+    double   begin, cost_time;
+    int      nb = 0, pass;
+    if (val == NULL || ptr == NULL || out == NULL || tk1 == NULL ||
+        tk2 == NULL) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        nb_fail++;
+        goto end;
+    }
+    srand(SEED);
+    for (int i = 0; i < SCALE_NUM; i++) {
+        val[i] = RAND_DBL(256.0, 65536.0);
+        ptr[i] = &val[i];
+    }
+    begin = wall_time();
+    for (int i = 0; i < SCALE_NUM; i += TOP_BATCH)
+        top_k_push_n(i % (2 * TOP_BATCH) ? tk2 : tk1, (void **)ptr + i,
+                     SCALE_NUM - i < TOP_BATCH ? SCALE_NUM - i : TOP_BATCH);
+    top_k_merge(tk1, tk2);
+    nb = top_k_final(tk1, (void **)out);
+    cost_time = wall_time() - begin;
+    quick_sort_p((void **)ptr, 0, SCALE_NUM, &cmp_dbl_rev);
+    pass = nb == TOP_K;
+    for (int i = 0; pass && i < TOP_K; i++)
+        pass = *(out[i]) == *(ptr[i]);
+    printf("algorithm   : top k (k = %d)\n"
+           "size of set : %d = %.3f M\n"
+           "time of sort: [ %lf S ]\n"
+           "have checked: %s\n", TOP_K, SCALE_NUM,
+           (float)SCALE_NUM / (1024 * 1024), cost_time,
+           check_str(pass));
+    printf("------------------------------------------------\n");
+end:
+    top_k_destroy(tk2);
+    top_k_destroy(tk1);
+    free(out);
+    free(ptr);
+    free(val);
+}
+
+/*
+ * run parallel top k and parallel selection from 1 thread up to all hardware
+ * threads, and check the result against 'quick_sort_p()'.
+ */
+
+void sel_scale_test(void) {
+    int      nb_hw = nb_hw_thrd(), k = SCALE_NUM / 3;
+    double   base_time = 0, cost_time, begin;
+    double  *val = (double *)malloc(sizeof(double) * SCALE_NUM);
+    double **ptr = (double **)malloc(sizeof(double *) * SCALE_NUM);
+    double **ref = (double **)malloc(sizeof(double *) * SCALE_NUM);
+    double **out = (double **)malloc(sizeof(double *) * TOP_K);
+    if (val == NULL || ptr == NULL || ref == NULL || out == NULL) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        nb_fail++;
+        goto end;
+    }
+    srand(SEED);
+    for (int i = 0; i < SCALE_NUM; i++) {
+        val[i] = RAND_DBL(256.0, 65536.0);
+        ref[i] = &val[i];
+    }
+    quick_sort_p((void **)ref, 0, SCALE_NUM, &cmp_dbl);
+
+    printf("algorithm   : parallel top k (k = %d)\n"
+           "size of set : %d = %.3f M\n", TOP_K,
+           SCALE_NUM, (float)SCALE_NUM / (1024 * 1024));
+    for (int t = 1, pass; ; t = t * 2 < nb_hw ? t * 2 : nb_hw) {
+        for (int i = 0; i < SCALE_NUM; i++)
+            ptr[i] = &val[i];
+        begin = wall_time();
+        pass = top_k_par_p((void **)ptr, SCALE_NUM, TOP_K, (void **)out,
+                           &cmp_dbl, t) == TOP_K;
+        cost_time = wall_time() - begin;
+        if (t == 1)
+            base_time = cost_time;
+        for (int i = 0; pass && i < TOP_K; i++)
+            pass = *(out[i]) == *(ref[i]);
+        printf(SCALE_STR, t, cost_time, base_time / cost_time,
+               check_str(pass));
+        if (t == nb_hw)
+            break;
+    }
+    printf("------------------------------------------------\n");
+
+    printf("algorithm   : parallel select (k = %d)\n"
+           "size of set : %d = %.3f M\n", k,
+           SCALE_NUM, (float)SCALE_NUM / (1024 * 1024));
+    for (int t = 1, pass, idx; ; t = t * 2 < nb_hw ? t * 2 : nb_hw) {
+        for (int i = 0; i < SCALE_NUM; i++)
+            ptr[i] = &val[i];
+        begin = wall_time();
+        idx = select_k_par_p((void **)ptr, 0, SCALE_NUM, k, &cmp_dbl, t);
+        cost_time = wall_time() - begin;
+        if (t == 1)
+            base_time = cost_time;
+        pass = idx == k - 1 && *(ptr[idx]) == *(ref[k - 1]);
+        printf(SCALE_STR, t, cost_time, base_time / cost_time,
+               check_str(pass));
+        if (t == nb_hw)
+            break;
+    }
+    printf("------------------------------------------------\n");
+end:
+    free(out);
+    free(ref);
+    free(ptr);
+    free(val);
+}
+
+/*
+ * select k-th element by 'nth_element_p()' against 'BFPRT_k_idx_p()', then
+ * check 'partial_sort_p()' and 'partial_sort_copy_p()' of the TOP_K
+ * smallest elements.
+ */
+
+void nth_test(void) {
+    int      k = SCALE_NUM / 3, idx, pass;
+    double   base_time, cost_time, begin;
+    double  *val = (double *)malloc(sizeof(double) * SCALE_NUM);
+    double **ptr = (double **)malloc(sizeof(double *) * SCALE_NUM);
+    double **ref = (double **)malloc(sizeof(double *) * SCALE_NUM);
+    double **out = (double **)malloc(sizeof(double *) * TOP_K);
+    if (val == NULL || ptr == NULL || ref == NULL || out == NULL) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        nb_fail++;
+        goto end;
+    }
+    srand(SEED);
+    for (int i = 0; i < SCALE_NUM; i++) {
+        val[i] = RAND_DBL(256.0, 65536.0);
+        ref[i] = &val[i];
+        ptr[i] = &val[i];
+    }
+    quick_sort_p((void **)ref, 0, SCALE_NUM, &cmp_dbl);
+
+    printf("algorithm   : Floyd-Rivest select (k = %d)\n"
+           "size of set : %d = %.3f M\n", k,
+           SCALE_NUM, (float)SCALE_NUM / (1024 * 1024));
+    begin = wall_time();
+    BFPRT_k_idx_p((void **)ptr, 0, SCALE_NUM, k, &cmp_dbl);
+    base_time = wall_time() - begin;
+    for (int i = 0; i < SCALE_NUM; i++)
+        ptr[i] = &val[i];
+    begin = wall_time();
+    idx = nth_element_p((void **)ptr, 0, SCALE_NUM, k, &cmp_dbl);
+    cost_time = wall_time() - begin;
+    pass = idx == k - 1 && *(ptr[idx]) == *(ref[k - 1]);
+    printf("time of sort: [ %lf S ] speedup: [ x%.2f ] vs. BFPRT %s\n",
+           cost_time, base_time / cost_time, check_str(pass));
+
+    for (int i = 0; i < SCALE_NUM; i++)
+        ptr[i] = &val[i];
+    begin = wall_time();
+    idx = BFPRT_k_idx_block_p((void **)ptr, 0, SCALE_NUM, k, &cmp_dbl);
+    cost_time = wall_time() - begin;
+    pass = idx == k - 1 && *(ptr[idx]) == *(ref[k - 1]);
+    for (int i = 0; pass && i < SCALE_NUM; i++)
+        pass = i < idx ? *(ptr[i]) <= *(ptr[idx]) : *(ptr[i]) >= *(ptr[idx]);
+    printf("BFPRT block : time of sort: [ %lf S ] speedup: [ x%.2f ] %s\n",
+           cost_time, base_time / cost_time, check_str(pass));
+
+    pass = partial_sort_copy_p((void **)ptr, SCALE_NUM, (void **)out, TOP_K,
+                               &cmp_dbl) == TOP_K;
+    for (int i = 0; pass && i < TOP_K; i++)
+        pass = *(out[i]) == *(ref[i]);
+    partial_sort_p((void **)ptr, 0, SCALE_NUM, TOP_K, &cmp_dbl);
+    for (int i = 0; pass && i < TOP_K; i++)
+        pass = *(ptr[i]) == *(ref[i]);
+    printf("partial sort: k = %d %s\n", TOP_K, check_str(pass));
+    printf("------------------------------------------------\n");
+end:
+    free(out);
+    free(ref);
+    free(ptr);
+    free(val);
+}
+
+/*
+ * sort URL-like strings sharing long prefixes by 'str_sort_p()' against
+ * 'intro_sort_p()' with 'cmp_str()'.
+ */
+
+void str_test(void) {
+    double  base_time = 0, cost_time, begin;
+    char   *buf = (char *)malloc((size_t)STR_NUM * STR_LEN);
+    char  **str = (char **)malloc(sizeof(char *) * STR_NUM);
+    char  **ref = (char **)malloc(sizeof(char *) * STR_NUM);
+    char  **ptr = (char **)malloc(sizeof(char *) * STR_NUM);
+    if (buf == NULL || str == NULL || ref == NULL || ptr == NULL) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        nb_fail++;
+        goto end;
+    }
+    srand(SEED);
+    for (int i = 0; i < STR_NUM; i++) {
+        str[i] = buf + (size_t)i * STR_LEN;
+        snprintf(str[i], STR_LEN, "https://www.example.com/catalog/%04d/"
+                 "item?id=%d", rand() % 5000, rand());
+    }
+    for (int i = STR_NUM - 1, j; i > 0; i--) {
+        j = rand() % (i + 1);
+        SWAP_PTR(str[i], str[j]);
+    }
+
+    printf("algorithm   : string sort\n"
+           "size of set : %d = %.3f M\n",
+           STR_NUM, (float)STR_NUM / (1024 * 1024));
+    for (int m = 0, pass; m < 2; m++) {
+        memcpy(m == 0 ? ref : ptr, str, sizeof(char *) * STR_NUM);
+        begin = wall_time();
+        if (m == 0)
+            intro_sort_p((void **)ref, 0, STR_NUM, &cmp_str);
+        else
+            str_sort_p((void **)ptr, STR_NUM);
+        cost_time = wall_time() - begin;
+        if (m == 0)
+            base_time = cost_time;
+        pass = 1;
+        for (int i = 0; m > 0 && pass && i < STR_NUM; i++)
+            pass = strcmp(ptr[i], ref[i]) == 0;
+        print_row(m == 0 ? "intro" : "multikey", cost_time, base_time, pass);
+    }
+    printf("------------------------------------------------\n");
+end:
+    free(ptr);
+    free(ref);
+    free(str);
+    free(buf);
+}
+
+/*
+ * argsort doubles of many duplicates by comparison and by radix, check the
+ * order, check stable ones keep indices of equal keys ascending, and gather
+ * a column of row numbers by the permutation.
+ */
+
+void arg_test(void) {
+    double    base_time = 0, cost_time, begin;
+    double   *val = (double *)malloc(sizeof(double) * SCALE_NUM);
+    uint32_t *idx = (uint32_t *)malloc(sizeof(uint32_t) * SCALE_NUM);
+    int32_t  *row = (int32_t *)malloc(sizeof(int32_t) * SCALE_NUM);
+    int32_t  *col = (int32_t *)malloc(sizeof(int32_t) * SCALE_NUM);
+    if (val == NULL || idx == NULL || row == NULL || col == NULL) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        nb_fail++;
+        goto end;
+    }
+    srand(SEED);
+    for (int i = 0; i < SCALE_NUM; i++) {
+        val[i] = (double)(int)RAND_DBL(-65536.0, 65536.0);
+        row[i] = i;
+    }
+
+    printf("algorithm   : argsort\n"
+           "size of set : %d = %.3f M\n",
+           SCALE_NUM, (float)SCALE_NUM / (1024 * 1024));
+    for (int m = 0, pass; m < 4; m++) {
+        begin = wall_time();
+        if (m == 0)
+            argsort(val, SCALE_NUM, sizeof(double), &cmp_dbl, idx);
+        else if (m == 1)
+            argsort_stable(val, SCALE_NUM, sizeof(double), &cmp_dbl, idx);
+        else if (m == 2)
+            argsort_key(val, SCALE_NUM, sizeof(double), &key_dbl, idx);
+        else
+            argsort_dbl(val, SCALE_NUM, idx);
+        cost_time = wall_time() - begin;
+        if (m == 0)
+            base_time = cost_time;
+        permute(row, col, SCALE_NUM, sizeof(int32_t), idx);
+        pass = 1;
+        for (int i = 0; pass && i < SCALE_NUM; i++)
+            pass = col[i] == (int32_t)idx[i] &&
+                   (i == 0 || val[idx[i - 1]] < val[idx[i]] ||
+                    (val[idx[i - 1]] == val[idx[i]] &&
+                     (m == 0 || idx[i - 1] < idx[i])));
+        print_row(m == 0 ? "unstable" : (m == 1 ? "stable" :
+                                         (m == 2 ? "key" : "radix dbl")),
+                  cost_time, base_time, pass);
+    }
+    printf("------------------------------------------------\n");
+end:
+    free(col);
+    free(row);
+    free(idx);
+    free(val);
+}
+
+/*
+ * sort many small segments of one buffer, mostly of no more than 16
+ * elements, by a loop of 'quick_sort()' calls and by segmented sort.
+ */
+
+void seg_test(void) {
+    double  base_time = 0, cost_time, begin;
+    int    *off = (int *)malloc(sizeof(int) * (SEG_NUM + 1)), n;
+    double *src = NULL, *val = NULL, *ref = NULL;
+    if (off == NULL) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        nb_fail++;
+        return;
+    }
+    srand(SEED);
+    off[0] = 0;
+    for (int i = 0; i < SEG_NUM; i++)
+        off[i + 1] = off[i] + SEG_MIN + (rand() % 8 == 0 ?
+                     rand() % (SEG_MAX - SEG_MIN) : rand() % 13);
+    n   = off[SEG_NUM];
+    src = (double *)malloc(sizeof(double) * n);
+    val = (double *)malloc(sizeof(double) * n);
+    ref = (double *)malloc(sizeof(double) * n);
+    if (src == NULL || val == NULL || ref == NULL) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        nb_fail++;
+        goto end;
+    }
+    for (int i = 0; i < n; i++)
+        src[i] = RAND_DBL(256.0, 65536.0);
+
+    printf("algorithm   : segmented sort (%d segments)\n"
+           "size of set : %d = %.3f M\n",
+           SEG_NUM, n, (float)n / (1024 * 1024));
+    for (int m = 0, pass; m < 3; m++) {
+        memcpy(m == 0 ? ref : val, src, sizeof(double) * n);
+        begin = wall_time();
+        if (m == 0)
+            for (int i = 0; i < SEG_NUM; i++)
+                quick_sort(ref + off[i], off[i + 1] - off[i],
+                           sizeof(double), &cmp_dbl);
+        else if (m == 1)
+            seg_sort_f64(val, off, SEG_NUM);
+        else
+            seg_sort_par_f64(val, off, SEG_NUM, 0);
+        cost_time = wall_time() - begin;
+        if (m == 0)
+            base_time = cost_time;
+        pass = m == 0 || memcmp(val, ref, sizeof(double) * n) == 0;
+        print_row(m == 0 ? "quick loop" : (m == 1 ? "segmented" : "parallel"),
+                  cost_time, base_time, pass);
+    }
+    printf("------------------------------------------------\n");
+end:
+    free(ref);
+    free(val);
+    free(src);
+    free(off);
+}
+
+/*
+ * compare functions of SIMD sort types, NaNs are the largest.
+ */
+
+static int cmp_f64_nan(const void *ptr1, const void *ptr2) {
+    double a = *(const double *)ptr1, b = *(const double *)ptr2;
+    if (a != a || b != b)
+        return (a != a) - (b != b);
+    return a == b ? 0 : (a > b ? 1 : -1);
+}
+
+static int cmp_f32_nan(const void *ptr1, const void *ptr2) {
+    float a = *(const float *)ptr1, b = *(const float *)ptr2;
+    if (a != a || b != b)
+        return (a != a) - (b != b);
+    return a == b ? 0 : (a > b ? 1 : -1);
+}
+
+static int cmp_i64(const void *ptr1, const void *ptr2) {
+    int64_t a = *(const int64_t *)ptr1, b = *(const int64_t *)ptr2;
+    return a == b ? 0 : (a > b ? 1 : -1);
+}
+
+static int cmp_i32(const void *ptr1, const void *ptr2) {
+    int32_t a = *(const int32_t *)ptr1, b = *(const int32_t *)ptr2;
+    return a == b ? 0 : (a > b ? 1 : -1);
+}
+
+/* types of SIMD sort, f64, f32, i64 and i32 */
+
+static const char  *simd_name[4] = {"f64", "f32", "i64", "i32"};
+static const size_t simd_size[4] = {sizeof(double), sizeof(float),
+                                    sizeof(int64_t), sizeof(int32_t)};
+static int(*const simd_cmp[4])(const void *, const void *) = {
+    &cmp_f64_nan, &cmp_f32_nan, &cmp_i64, &cmp_i32
+};
+
+/*
+ * fill n elements of a type, of 8 distinct keys if dup, otherwise of the
+ * whole range, every 61st floating point element is NaN.
+ */
+
+static void simd_fill(void *arr, int n, int type, int dup) {
+    for (int i = 0; i < n; i++) {
+        int64_t k = dup ? rand() % 8 - 4 :
+                    (int64_t)((uint64_t)rand() << 33 ^ (uint64_t)rand() << 7 ^
+                              (uint64_t)rand());
+        double  x = dup ? (double)k : RAND_DBL(-65536.0, 65536.0);
+        if (type < 2 && i % 61 == 7)
+            x = NAN;
+        switch (type) {
+        case 0: ((double *)arr)[i]  = x;          break;
+        case 1: ((float *)arr)[i]   = (float)x;   break;
+        case 2: ((int64_t *)arr)[i] = k;          break;
+        case 3: ((int32_t *)arr)[i] = (int32_t)k; break;
+        }
+    }
+}
+
+static void simd_sort_t(void *arr, int n, int type) {
+    switch (type) {
+    case 0: sort_f64((double *)arr, n);  break;
+    case 1: sort_f32((float *)arr, n);   break;
+    case 2: sort_i64((int64_t *)arr, n); break;
+    case 3: sort_i32((int32_t *)arr, n); break;
+    }
+}
+
+static void simd_seg_t(void *arr, const int *off, int nb_seg, int type) {
+    switch (type) {
+    case 0: seg_sort_f64((double *)arr, off, nb_seg);  break;
+    case 1: seg_sort_f32((float *)arr, off, nb_seg);   break;
+    case 2: seg_sort_i64((int64_t *)arr, off, nb_seg); break;
+    case 3: seg_sort_i32((int32_t *)arr, off, nb_seg); break;
+    }
+}
+
+/*
+ * sort SIMD_NUM elements of a type by SIMD sort, then segments of 0 to
+ * SIMD_SEG elements by segmented sort, against 'qsort()'.
+ *
+ * @return 1 if both are sorted as by 'qsort()', otherwise 0.
+ */
+
+static int simd_check(int type, int dup, void *val, void *ref, int *off) {
+    size_t s = simd_size[type];
+    int    nb_seg = 0, pass;
+    simd_fill(val, SIMD_NUM, type, dup);
+    memcpy(ref, val, s * SIMD_NUM);
+    simd_sort_t(val, SIMD_NUM, type);
+    qsort(ref, SIMD_NUM, s, simd_cmp[type]);
+    pass = memcmp(val, ref, s * SIMD_NUM) == 0;
+
+    off[0] = 0;
+    while (off[nb_seg] + SIMD_SEG <= SIMD_NUM) {
+        off[nb_seg + 1] = off[nb_seg] + rand() % (SIMD_SEG + 1);
+        nb_seg++;
+    }
+    simd_fill(val, off[nb_seg], type, dup);
+    memcpy(ref, val, s * off[nb_seg]);
+    simd_seg_t(val, off, nb_seg, type);
+    for (int i = 0; i < nb_seg; i++)
+        qsort((char *)ref + s * off[i], off[i + 1] - off[i], s,
+              simd_cmp[type]);
+    return pass && memcmp(val, ref, s * off[nb_seg]) == 0;
+}
+
+/*
+ * run SIMD sort and segmented sort of every type at every instruction set
+ * up to the one of host, 0 (scalar), 1 (AVX2) and 2 (AVX-512), on inputs of
+ * distinct keys and NaNs, and of many duplicates. the level in use is
+ * restored at the end.
+ */
+
+void simd_test(void) {
+    int   lv0 = simd_level(-1), lv;
+    void *val = malloc(sizeof(double) * SIMD_NUM);
+    void *ref = malloc(sizeof(double) * SIMD_NUM);
+    int  *off = (int *)malloc(sizeof(int) * (SIMD_NUM + 1));
+    if (val == NULL || ref == NULL || off == NULL) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        nb_fail++;
+        goto end;
+    }
+    srand(SEED);
+
+    printf("algorithm   : SIMD sort and segmented sort vs. qsort\n"
+           "size of set : %d\n", SIMD_NUM);
+    for (int level = 0; level <= 2; level++) {
+        if ((lv = simd_level(level)) != level) {
+            printf("level %d       : not supported by host\n", level);
+            continue;
+        }
+        for (int t = 0; t < 4; t++)
+            printf("level %d %s   : distinct %s, duplicates %s\n", lv,
+                   simd_name[t],
+                   check_str(simd_check(t, 0, val, ref, off)),
+                   check_str(simd_check(t, 1, val, ref, off)));
+    }
+    simd_level(lv0);
+    printf("------------------------------------------------\n");
+end:
+    free(off);
+    free(ref);
+    free(val);
+}
+
+/*
+ * insert elements into a sorted set one by one, then check ordered
+ * iteration, ranks and a range against a stable sorted copy, since equal
+ * elements are iterated in insertion order.
+ */
+
+void set_test(void) {
+    double    cost_time, begin;
+    int       pass = 1, lo = SCALE_NUM / 4, hi = SCALE_NUM / 2, k;
+    double   *val = (double *)malloc(sizeof(double) * SCALE_NUM);
+    double  **ref = (double **)malloc(sizeof(double *) * SCALE_NUM);
+    double  **out = (double **)malloc(sizeof(double *) * SCALE_NUM);
+    SortSet  *ss  = sort_set_create(&cmp_dbl);
+    SortIter  it;
+    if (val == NULL || ref == NULL || out == NULL || ss == NULL) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        nb_fail++;
+        goto end;
+    }
+    srand(SEED);
+    for (int i = 0; i < SCALE_NUM; i++) {
+        val[i] = RAND_DBL(256.0, 65536.0);
+        ref[i] = &val[i];
+    }
+    merge_sort_p((void **)ref, SCALE_NUM, &cmp_dbl);
+    while (lo > 0 && *(ref[lo - 1]) == *(ref[lo]))
+        lo--;
+    while (hi > 0 && *(ref[hi - 1]) == *(ref[hi]))
+        hi--;
+
+    printf("algorithm   : sorted set\n"
+           "size of set : %d = %.3f M\n",
+           SCALE_NUM, (float)SCALE_NUM / (1024 * 1024));
+    begin = wall_time();
+    for (int i = 0; i < SCALE_NUM; i++)
+        sort_set_insert(ss, &val[i]);
+    cost_time = wall_time() - begin;
+    sort_iter_seek(&it, ss, NULL);
+    for (int i = 0; pass && i < SCALE_NUM; i++)
+        pass = sort_iter_next(&it) == ref[i];
+    pass = pass && sort_iter_next(&it) == NULL;
+    for (int i = 0, j; pass && i < SCALE_NUM; i += SCALE_NUM / 64) {
+        for (j = i; j > 0 && *(ref[j - 1]) == *(ref[i]); j--)
+            ;
+        pass = sort_set_rank(ss, ref[i]) == j;
+    }
+    k = sort_set_range(ss, ref[lo], ref[hi], (void **)out, SCALE_NUM);
+    pass = pass && k == hi - lo &&
+           memcmp(out, ref + lo, sizeof(double *) * k) == 0;
+    printf("time of sort: [ %lf S ] %.1f ns per insert %s\n", cost_time,
+           cost_time * 1e9 / SCALE_NUM, check_str(pass));
+    printf("------------------------------------------------\n");
+end:
+    sort_set_destroy(ss);
+    free(out);
+    free(ref);
+    free(val);
+}
+
+/*
+ * heap sort by heaps of arity 2, 4 and 8 with counted comparisons, then
+ * merge MERGE_K sorted runs by 'merge_k_p()'.
+ */
+
+void heap_test(void) {
+    SortStat  st;
+    int       pass, len[MERGE_K];
+    double   *val  = (double *)malloc(sizeof(double) * SCALE_NUM);
+    double  **ptr  = (double **)malloc(sizeof(double *) * SCALE_NUM);
+    double  **out  = (double **)malloc(sizeof(double *) * SCALE_NUM);
+    void    **runs[MERGE_K];
+    int(*cnt)(const void *, const void *) = stat_cmp(&cmp_dbl);
+    if (val == NULL || ptr == NULL || out == NULL || cnt == NULL) {
+        fprintf(stderr, "ERROR allocating memory.\n");
+        nb_fail++;
+        goto end;
+    }
+    srand(SEED);
+    for (int i = 0; i < SCALE_NUM; i++)
+        val[i] = RAND_DBL(256.0, 65536.0);
+
+    printf("algorithm   : d-ary heap sort\n"
+           "size of set : %d = %.3f M\n",
+           SCALE_NUM, (float)SCALE_NUM / (1024 * 1024));
+    for (int d = 2; d <= 8; d *= 2) {
+        for (int i = 0; i < SCALE_NUM; i++)
+            ptr[i] = &val[i];
+        STAT_RUN(&st, heap_sort_d_p((void **)ptr, SCALE_NUM, d, cnt));
+        pass = 1;
+        for (int i = 1; pass && i < SCALE_NUM; i++)
+            pass = *(ptr[i - 1]) <= *(ptr[i]);
+        printf("arity %d     : time of sort: [ %lf S ] %.2f cmp/elem %s\n",
+               d, st.time, (double)st.nb_cmp / SCALE_NUM,
+               check_str(pass));
+    }
+
+    /* runs are slices of the sorted array dealt round-robin */
+    for (int r = 0; r < MERGE_K; r++) {
+        len[r]  = SCALE_NUM / MERGE_K;
+        runs[r] = (void **)out + (size_t)r * len[r];
+        for (int i = 0; i < len[r]; i++)
+            runs[r][i] = ptr[i * MERGE_K + r];
+    }
+    pass = merge_k_p(runs, len, MERGE_K, (void **)ptr, &cmp_dbl) ==
+           MERGE_K * len[0];
+    for (int i = 1; pass && i < MERGE_K * len[0]; i++)
+        pass = *(ptr[i - 1]) <= *(ptr[i]);
+    printf("merge k     : k = %d %s\n", MERGE_K, check_str(pass));
+    printf("------------------------------------------------\n");
+end:
+    stat_cmp_release(cnt);
+    free(out);
+    free(ptr);
+    free(val);
+}
+
+void quick_par(void **arr, int n, int nb_thrd) {
+    quick_sort_par_p(arr, 0, n, &cmp_dbl, nb_thrd);
+}
+
+void bucket_par(void **arr, int n, int nb_thrd) {
+    bucket_sort_par_p(arr, n, &nb_bkts_p, &hash_idx_p, &cmp_dbl, nb_thrd);
+}
+
+void merge_par(void **arr, int n, int nb_thrd) {
+    merge_sort_par_p(arr, n, &cmp_dbl, nb_thrd);
+}
@@ -0,0 +1,386 @@
+/**
+ * @file thread_pool.c
+ * source file contains of difination of work-stealing thread pool.
+ *
+ * every worker owns a double-ended queue of tasks, it pushes and pops tasks
+ * at the bottom of its own queue and steals tasks from the top of queues
+ * of other workers when its own queue is empty. tasks submitted by a thread
+ * which is not a worker of the pool are pushed into a shared queue.
+ *
+ * @author  duruyao
+ * @version 1.0  19-12-19
+ * @update  [id] [yy-mm-dd] [author] [description]
+ */
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "thread_pool.h"
+
+
+/******************************************************************************/
+/*                                                                            */
+/* struct defination                                                          */
+/*                                                                            */
+/******************************************************************************/
+
+
+#define DQ_INIT_CAP 64
+#define WAIT_NSEC   200000L     /* 0.2 ms */
+
+typedef struct task {
+    void    (*fn)(void *);
+    void     *arg;
+    TaskGrp  *grp;
+} Task;
+
+/*
+ * ring buffer of tasks protected by a mutex, the owner uses the bottom and
+ * thieves use the top.
+ */
+
+typedef struct deque {
+    pthread_mutex_t lock;
+    Task *buf;
+    int   cap;
+    int   head;                 /* index of the top                        */
+    int   size;
+} Deque;
+
+typedef struct worker {
+    ThreadPool *pool;
+    int         idx;
+    pthread_t   tid;
+} Worker;
+
+struct thread_pool {
+    int      nb_thrd;           /* number of worker threads                */
+    Worker  *workers;
+    Deque   *queues;            /* nb_thrd + 1, the last one is shared     */
+    long     nb_queued;         /* number of tasks in all queues           */
+    int      stop;
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;       /* signaled when a task is submitted       */
+};
+
+static __thread ThreadPool *cur_pool = NULL;
+static __thread int         cur_idx  = -1;
+
+
+/******************************************************************************/
+/*                                                                            */
+/* function defination                                                        */
+/*                                                                            */
+/******************************************************************************/
+
+
+/******************************************************************************/
+/* deque                                                                      */
+/******************************************************************************/
+
+/*
+ * push a task at the bottom of deque.
+ *
+ * @return 0 on success, otherwise -1.
+ */
+
+static int dq_push(Deque *dq, Task *t) {
+    pthread_mutex_lock(&dq->lock);
+    if (dq->size == dq->cap) {
+        int   cap = dq->cap ? 2 * dq->cap : DQ_INIT_CAP;
+        Task *buf = (Task *)malloc(sizeof(Task) * cap);
+        if (buf == NULL) {
+            pthread_mutex_unlock(&dq->lock);
+            return -1;
+        }
+        for (int i = 0; i < dq->size; i++)
+            buf[i] = dq->buf[(dq->head + i) % dq->cap];
+        free(dq->buf);
+        dq->buf  = buf;
+        dq->cap  = cap;
+        dq->head = 0;
+    }
+    dq->buf[(dq->head + dq->size) % dq->cap] = *t;
+    __atomic_store_n(&dq->size, dq->size + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&dq->lock);
+    return 0;
+}
+
+/*
+ * pop a task from the bottom (bottom != 0) or the top (bottom == 0).
+ *
+ * @return 1 if a task is got, otherwise 0.
+ */
+
+static int dq_take(Deque *dq, Task *t, int bottom) {
+    if (__atomic_load_n(&dq->size, __ATOMIC_ACQUIRE) == 0)
+        return 0;
+    pthread_mutex_lock(&dq->lock);
+    if (dq->size == 0) {
+        pthread_mutex_unlock(&dq->lock);
+        return 0;
+    }
+    if (bottom)
+        *t = dq->buf[(dq->head + dq->size - 1) % dq->cap];
+    else {
+        *t = dq->buf[dq->head];
+        dq->head = (dq->head + 1) % dq->cap;
+    }
+    __atomic_store_n(&dq->size, dq->size - 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&dq->lock);
+    return 1;
+}
+
+/******************************************************************************/
+/* thread pool                                                                */
+/******************************************************************************/
+
+/*
+ * get the number of hardware threads.
+ *
+ * @return number of online processors, at least 1.
+ */
+
+int nb_hw_thrd(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n < 1 ? 1 : (int)n;
+}
+
+/*
+ * find a task, a worker pops its own queue first, then every thread steals
+ * from the others.
+ *
+ * @return 1 if a task is got, otherwise 0.
+ */
+
+static int find_task(ThreadPool *pool, int idx, Task *t) {
+    int nb_q = pool->nb_thrd + 1;
+    if (idx >= 0 && dq_take(&pool->queues[idx], t, 1))
+        goto found;
+    for (int i = 1; i <= nb_q; i++) {
+        int victim = ((idx < 0 ? pool->nb_thrd : idx) + i) % nb_q;
+        if (victim != idx && dq_take(&pool->queues[victim], t, 0))
+            goto found;
+    }
+    return 0;
+found:
+    __atomic_sub_fetch(&pool->nb_queued, 1, __ATOMIC_ACQ_REL);
+    return 1;
+}
+
+/*
+ * run a task and notify its group when the group is finished.
+ */
+
+static void run_task(Task *t) {
+    TaskGrp *grp = t->grp;
+    t->fn(t->arg);
+    pthread_mutex_lock(&grp->lock);
+    if (__atomic_sub_fetch(&grp->pending, 1, __ATOMIC_ACQ_REL) == 0)
+        pthread_cond_broadcast(&grp->done);
+    pthread_mutex_unlock(&grp->lock);
+}
+
+/*
+ * main loop of a worker thread.
+ */
+
+static void *worker_run(void *arg) {
+    Worker     *w    = (Worker *)arg;
+    ThreadPool *pool = w->pool;
+    Task t;
+    cur_pool = pool;
+    cur_idx  = w->idx;
+    for (int stop = 0; !stop;) {
+        if (find_task(pool, w->idx, &t)) {
+            run_task(&t);
+            continue;
+        }
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->stop &&
+               __atomic_load_n(&pool->nb_queued, __ATOMIC_ACQUIRE) == 0)
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        stop = pool->stop &&
+               __atomic_load_n(&pool->nb_queued, __ATOMIC_ACQUIRE) == 0;
+        pthread_mutex_unlock(&pool->lock);
+    }
+    return NULL;
+}
+
+/*
+ * stop the first nb_run workers after queued tasks are finished and release
+ * the pool.
+ */
+
+static void pool_stop(ThreadPool *pool, int nb_run) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < nb_run; i++)
+        pthread_join(pool->workers[i].tid, NULL);
+    for (int i = 0; i <= pool->nb_thrd; i++) {
+        pthread_mutex_destroy(&pool->queues[i].lock);
+        free(pool->queues[i].buf);
+    }
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->queues);
+    free(pool->workers);
+    free(pool);
+}
+
+/*
+ * create a thread pool.
+ *
+ * a thread calling 'pool_wait()' runs tasks too, so a pool of nb_thrd - 1
+ * workers keeps nb_thrd threads busy.
+ *
+ * @param nb_thrd is number of worker threads, it may be 0, if it is less
+ *                than 0, 'nb_hw_thrd() - 1' workers are created.
+ *
+ * @return a pointer to thread pool on success, otherwise NULL.
+ */
+
+ThreadPool *pool_create(int nb_thrd) {
+    ThreadPool *pool = NULL;
+    if (nb_thrd < 0)
+        nb_thrd = nb_hw_thrd() - 1;
+    pool = (ThreadPool *)calloc(1, sizeof(ThreadPool));
+    if (pool == NULL)
+        goto err;
+    pool->workers = (Worker *)calloc(nb_thrd + 1, sizeof(Worker));
+    pool->queues  = (Deque *)calloc(nb_thrd + 1, sizeof(Deque));
+    if (pool->workers == NULL || pool->queues == NULL)
+        goto err;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    for (int i = 0; i <= nb_thrd; i++)
+        pthread_mutex_init(&pool->queues[i].lock, NULL);
+    pool->nb_thrd = nb_thrd;
+    for (int i = 0; i < nb_thrd; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].idx  = i;
+        if (pthread_create(&pool->workers[i].tid, NULL,
+                           worker_run, &pool->workers[i]) != 0) {
+            fprintf(stderr, "ERROR creating thread.\n");
+            pool_stop(pool, i);
+            return NULL;
+        }
+    }
+    return pool;
+err:
+    fprintf(stderr, "ERROR allocating memory.\n");
+    if (pool != NULL) {
+        free(pool->workers);
+        free(pool->queues);
+    }
+    free(pool);
+    return NULL;
+}
+
+/*
+ * stop all workers after queued tasks are finished and release the pool.
+ *
+ * @param pool is a pointer to thread pool.
+ */
+
+void pool_destroy(ThreadPool *pool) {
+    if (pool != NULL)
+        pool_stop(pool, pool->nb_thrd);
+}
+
+/*
+ * get the number of worker threads of pool.
+ */
+
+int pool_size(ThreadPool *pool) {
+    return pool->nb_thrd;
+}
+
+/*
+ * initialize an empty task group.
+ */
+
+void grp_init(TaskGrp *grp) {
+    grp->pending = 0;
+    pthread_mutex_init(&grp->lock, NULL);
+    pthread_cond_init(&grp->done, NULL);
+}
+
+/*
+ * release a task group, which has no pending task.
+ */
+
+void grp_destroy(TaskGrp *grp) {
+    pthread_cond_destroy(&grp->done);
+    pthread_mutex_destroy(&grp->lock);
+}
+
+/*
+ * submit a task to pool.
+ *
+ * a worker pushes the task into its own queue, other threads push it into
+ * the shared queue. if the task can not be queued, it is run immediately.
+ *
+ * @param pool is a pointer to thread pool.
+ * @param grp  is the group of the task.
+ * @param fn   is a pointer to the function of the task.
+ * @param arg  is the argument of fn.
+ *
+ * @return 0 if the task is queued, 1 if it has been run.
+ */
+
+int pool_submit(ThreadPool *pool, TaskGrp *grp,
+                void(*fn)(void *), void *arg) {
+    Task t = {fn, arg, grp};
+    int idx = cur_pool == pool ? cur_idx : pool->nb_thrd;
+    __atomic_add_fetch(&grp->pending, 1, __ATOMIC_ACQ_REL);
+    if (dq_push(&pool->queues[idx], &t) < 0) {
+        run_task(&t);
+        return 1;
+    }
+    __atomic_add_fetch(&pool->nb_queued, 1, __ATOMIC_ACQ_REL);
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+/*
+ * wait until all tasks of a group are finished, the calling thread runs
+ * queued tasks of the pool while waiting.
+ *
+ * @param pool is a pointer to thread pool.
+ * @param grp  is the group to wait for.
+ */
+
+void pool_wait(ThreadPool *pool, TaskGrp *grp) {
+    int idx = cur_pool == pool ? cur_idx : -1;
+    struct timespec ts;
+    Task t;
+    while (__atomic_load_n(&grp->pending, __ATOMIC_ACQUIRE) > 0) {
+        if (find_task(pool, idx, &t)) {
+            run_task(&t);
+            continue;
+        }
+        /* wake up periodically to help with tasks spawned meanwhile */
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += WAIT_NSEC;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        pthread_mutex_lock(&grp->lock);
+        if (__atomic_load_n(&grp->pending, __ATOMIC_ACQUIRE) > 0)
+            pthread_cond_timedwait(&grp->done, &grp->lock, &ts);
+        pthread_mutex_unlock(&grp->lock);
+    }
+    /* the last task may be still holding the lock of group */
+    pthread_mutex_lock(&grp->lock);
+    pthread_mutex_unlock(&grp->lock);
+}
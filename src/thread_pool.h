@@ -0,0 +1,78 @@
+/**
+ * @file thread_pool.h
+ * head file contains of declaration of work-stealing thread pool.
+ *
+ * @author  duruyao
+ * @version 1.0  19-12-19
+ * @update  [id] [yy-mm-dd] [author] [description]
+ */
+
+#ifndef __THREADPOOLH__
+#define __THREADPOOLH__
+
+#include <pthread.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif /* __plusplus */
+
+
+/******************************************************************************/
+/*                                                                            */
+/* struct declaration                                                         */
+/*                                                                            */
+/******************************************************************************/
+
+
+/******************************************************************************/
+/* ThreadPool type                                                            */
+/******************************************************************************/
+
+struct thread_pool;
+typedef struct thread_pool ThreadPool;
+
+/******************************************************************************/
+/* TaskGrp type                                                               */
+/******************************************************************************/
+
+/*
+ * a group of tasks, which can be waited for by 'pool_wait()'.
+ */
+
+struct task_grp {
+    long            pending;    /* number of unfinished tasks              */
+    pthread_mutex_t lock;
+    pthread_cond_t  done;       /* signaled when 'pending' becomes 0       */
+};
+
+typedef struct task_grp TaskGrp;
+
+
+/******************************************************************************/
+/*                                                                            */
+/* function declaration                                                       */
+/*                                                                            */
+/******************************************************************************/
+
+
+extern int  nb_hw_thrd      (void);
+
+extern ThreadPool *pool_create (int);
+
+extern void pool_destroy    (ThreadPool *);
+
+extern int  pool_size       (ThreadPool *);
+
+extern void grp_init        (TaskGrp *);
+
+extern void grp_destroy     (TaskGrp *);
+
+extern int  pool_submit     (ThreadPool *, TaskGrp *, void(*)(void *), void *);
+
+extern void pool_wait       (ThreadPool *, TaskGrp *);
+
+#ifdef __cplusplus
+}
+#endif /* __plusplus */
+
+#endif /* !__THREADPOOLH__ */